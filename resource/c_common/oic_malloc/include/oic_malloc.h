@@ -48,6 +48,26 @@ extern "C"
 // Typedefs
 //-----------------------------------------------------------------------------
 
+/**
+ * Opaque handle of a region (arena) allocator.  Memory handed out by an
+ * arena is released all at once by OICArenaReset or OICArenaDestroy and must
+ * NOT be passed to OICFree or OICRealloc.
+ */
+typedef struct OICArena OICArena;
+
+/**
+ * Allocation statistics of one slab size class (see OICGetSlabStats).
+ */
+typedef struct
+{
+    size_t objectSize;  /**< Largest request served by this class, in bytes. */
+    size_t allocCount;  /**< Allocations served since start-up. */
+    size_t freeCount;   /**< Frees returned to the class since start-up. */
+    size_t inUse;       /**< Objects currently allocated. */
+    size_t peakInUse;   /**< High-water mark of inUse. */
+    size_t chunkCount;  /**< Slab chunks carved for this class. */
+} OICSlabStats;
+
 //-----------------------------------------------------------------------------
 // Function prototypes
 //-----------------------------------------------------------------------------
@@ -111,6 +131,83 @@ void *OICCalloc(size_t num, size_t size);
  */
 void OICFree(void *ptr);
 
+/**
+ * Creates an arena whose first block is allocated together with the arena
+ * handle itself.  Allocations that do not fit in the current block spill
+ * into additional blocks of at least blockSize bytes.
+ *
+ * NOTE: This function is intended to be used internally by the TB Stack.
+ *       It is not intended to be used by applications.
+ *
+ * @param blockSize - Size of the first block in bytes, where blockSize > 0
+ *
+ * @return
+ *     on success, a pointer to the new arena
+ *     on failure, a null pointer is returned
+ */
+OICArena *OICArenaCreate(size_t blockSize);
+
+/**
+ * Allocates size bytes from an arena.  The returned block is suitably
+ * aligned for any type and lives until the arena is reset or destroyed.
+ *
+ * @param arena - Arena created by OICArenaCreate
+ * @param size - Size of the memory block in bytes, where size > 0
+ *
+ * @return
+ *     on success, a pointer to the allocated memory block
+ *     on failure, a null pointer is returned
+ */
+void *OICArenaAlloc(OICArena *arena, size_t size);
+
+/**
+ * Allocates a zero-initialized array of num elements of size bytes each
+ * from an arena.
+ *
+ * @param arena - Arena created by OICArenaCreate
+ * @param num - The number of elements
+ * @param size - Size of the element type in bytes, where size > 0
+ *
+ * @return
+ *     on success, a pointer to the allocated memory block
+ *     on failure, a null pointer is returned
+ */
+void *OICArenaCalloc(OICArena *arena, size_t num, size_t size);
+
+/**
+ * Releases every allocation made from an arena in one step.  The first
+ * block is kept so the arena can be reused without touching the heap.
+ *
+ * @param arena - Arena created by OICArenaCreate.  If arena is a null
+ *                pointer, the function does nothing.
+ */
+void OICArenaReset(OICArena *arena);
+
+/**
+ * Releases an arena together with every allocation made from it.
+ *
+ * @param arena - Arena created by OICArenaCreate.  If arena is a null
+ *                pointer, the function does nothing.
+ */
+void OICArenaDestroy(OICArena *arena);
+
+/**
+ * Reports per size class statistics of the slab allocator behind OICMalloc,
+ * OICCalloc and OICFree.  The slab backend is only present when the stack is
+ * built with WITH_MALLOC_SLAB; requests larger than the biggest class, and
+ * any memory not obtained from a slab, are served by the system allocator.
+ * Slab chunks stay with the process once carved and are reused by their class;
+ * their number is capped by OIC_SLAB_MAX_CHUNKS and reported in chunkCount.
+ *
+ * @param stats - Array receiving up to count entries, smallest class first.
+ *                May be a null pointer to only query the number of classes.
+ * @param count - Number of entries available in stats.
+ *
+ * @return
+ *     the number of slab size classes, or 0 if the slab backend is disabled
+ */
+size_t OICGetSlabStats(OICSlabStats *stats, size_t count);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -22,8 +22,15 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include "oic_malloc.h"
 
+#ifdef WITH_MALLOC_SLAB
+#include <pthread.h>
+#endif
+
 // Enable extra debug logging for malloc.  Comment out to disable
 #ifdef ENABLE_MALLOC_DEBUG
 #include "logger.h"
@@ -34,13 +41,129 @@
 // Typedefs
 //-----------------------------------------------------------------------------
 
+/** Type with the strictest alignment an arena allocation must satisfy. */
+typedef union
+{
+    long long ll;
+    long double ld;
+    void *ptr;
+    void (*fn)(void);
+} OICArenaAlign_t;
+
+/** One contiguous chunk of arena memory; its data follows the header. */
+typedef struct OICArenaBlock
+{
+    struct OICArenaBlock *next;
+    size_t size;
+    size_t used;
+} OICArenaBlock;
+
+struct OICArena
+{
+    /** Block allocations are currently served from; chains back to first. */
+    OICArenaBlock *current;
+    /** Size of the blocks added once the current block is exhausted. */
+    size_t blockSize;
+    /** Block allocated together with the arena handle. */
+    OICArenaBlock first;
+};
+
+#ifdef WITH_MALLOC_SLAB
+/** Size and alignment of a slab chunk; every chunk serves one size class. */
+#define OIC_SLAB_CHUNK_SIZE (64 * 1024)
+/**
+ * Upper bound on slab chunks; once reached, allocations fall back to malloc.
+ * Chunks are never returned to the system (the lock-free registry below relies
+ * on that), so this also caps the memory the slab keeps after a usage peak:
+ * 256 chunks are 16 MiB.  Override at build time for larger deployments.
+ */
+#ifndef OIC_SLAB_MAX_CHUNKS
+#define OIC_SLAB_MAX_CHUNKS 256
+#endif
+/** Objects a thread may cache per class before half are returned to the class. */
+#define OIC_SLAB_CACHE_LIMIT 64
+/** Objects moved from a class to a thread cache in one locked refill. */
+#define OIC_SLAB_REFILL_COUNT 16
+
+/** Free object of a slab size class; the link overlays the object's storage. */
+typedef struct OICSlabObject
+{
+    struct OICSlabObject *next;
+} OICSlabObject;
+
+/** Header at the (chunk-size aligned) start of every slab chunk. */
+typedef struct
+{
+    size_t classIndex;
+} OICSlabChunk;
+
+/** Shared state of one size class; counters are updated atomically. */
+typedef struct
+{
+    OICSlabObject *freeList;    /**< Guarded by g_slabMutex. */
+    size_t allocCount;
+    size_t freeCount;
+    size_t inUse;
+    size_t peakInUse;
+    size_t chunkCount;
+} OICSlabClass;
+#endif
+
 //-----------------------------------------------------------------------------
 // Private variables
 //-----------------------------------------------------------------------------
+#ifdef WITH_MALLOC_SLAB
+/** Object sizes of the slab classes; larger requests go straight to malloc. */
+static const size_t g_slabSizes[] =
+{
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536
+};
+
+#define OIC_SLAB_CLASS_COUNT (sizeof(g_slabSizes) / sizeof(g_slabSizes[0]))
+
+/** Per-thread cache of free objects, refilled from and flushed to the classes. */
+typedef struct
+{
+    OICSlabObject *head[OIC_SLAB_CLASS_COUNT];
+    size_t count[OIC_SLAB_CLASS_COUNT];
+} OICSlabCache;
+
+static OICSlabClass g_slabClasses[OIC_SLAB_CLASS_COUNT];
+static pthread_mutex_t g_slabMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Open-addressed set of chunk base addresses.  Entries are only ever added
+ * (chunks are never handed back to the system), so lookups need no lock.
+ */
+static uintptr_t g_slabRegistry[2 * OIC_SLAB_MAX_CHUNKS];
+static size_t g_slabChunkTotal;
+
+static __thread OICSlabCache g_slabCache;
+static __thread bool g_slabCacheRegistered;
+static pthread_key_t g_slabCacheKey;
+static pthread_once_t g_slabCacheOnce = PTHREAD_ONCE_INIT;
+#endif
 
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
+#define OIC_ARENA_ALIGN(x) \
+    ((((x) + sizeof(OICArenaAlign_t) - 1) / sizeof(OICArenaAlign_t)) * sizeof(OICArenaAlign_t))
+#define OIC_ARENA_HEADER_SIZE OIC_ARENA_ALIGN(sizeof(struct OICArena))
+#define OIC_ARENA_BLOCK_HEADER_SIZE OIC_ARENA_ALIGN(sizeof(OICArenaBlock))
+
+/** Allocator behind the OIC* wrappers: the slab when enabled, libc otherwise. */
+#ifdef WITH_MALLOC_SLAB
+#define OIC_BACKEND_MALLOC(size) OICSlabAlloc(size)
+#define OIC_BACKEND_CALLOC(num, size) OICSlabCalloc(num, size)
+#define OIC_BACKEND_REALLOC(ptr, size) OICSlabRealloc(ptr, size)
+#define OIC_BACKEND_FREE(ptr) OICSlabFree(ptr)
+#else
+#define OIC_BACKEND_MALLOC(size) malloc(size)
+#define OIC_BACKEND_CALLOC(num, size) calloc(num, size)
+#define OIC_BACKEND_REALLOC(ptr, size) realloc(ptr, size)
+#define OIC_BACKEND_FREE(ptr) free(ptr)
+#endif
 
 //-----------------------------------------------------------------------------
 // Internal API function
@@ -49,6 +172,12 @@
 //-----------------------------------------------------------------------------
 // Private internal function prototypes
 //-----------------------------------------------------------------------------
+#ifdef WITH_MALLOC_SLAB
+static void *OICSlabAlloc(size_t size);
+static void *OICSlabCalloc(size_t num, size_t size);
+static void *OICSlabRealloc(void *ptr, size_t size);
+static void OICSlabFree(void *ptr);
+#endif
 
 //-----------------------------------------------------------------------------
 // Public APIs
@@ -65,7 +194,7 @@ void *OICMalloc(size_t size)
     }
 
 #ifdef ENABLE_MALLOC_DEBUG
-    void *ptr = malloc(size);
+    void *ptr = OIC_BACKEND_MALLOC(size);
     if (ptr)
     {
         count++;
@@ -73,7 +202,7 @@ void *OICMalloc(size_t size)
     OIC_LOG_V(INFO, TAG, "malloc: ptr=%p, size=%u, count=%u", ptr, size, count);
     return ptr;
 #else
-    return malloc(size);
+    return OIC_BACKEND_MALLOC(size);
 #endif
 }
 
@@ -85,7 +214,7 @@ void *OICCalloc(size_t num, size_t size)
     }
 
 #ifdef ENABLE_MALLOC_DEBUG
-    void *ptr = calloc(num, size);
+    void *ptr = OIC_BACKEND_CALLOC(num, size);
     if (ptr)
     {
         count++;
@@ -93,7 +222,7 @@ void *OICCalloc(size_t num, size_t size)
     OIC_LOG_V(INFO, TAG, "calloc: ptr=%p, num=%u, size=%u, count=%u", ptr, num, size, count);
     return ptr;
 #else
-    return calloc(num, size);
+    return OIC_BACKEND_CALLOC(num, size);
 #endif
 }
 
@@ -110,13 +239,13 @@ void *OICRealloc(void* ptr, size_t size)
     // Otherwise leave the behavior up to realloc() itself:
 
 #ifdef ENABLE_MALLOC_DEBUG
-    void* newptr = realloc(ptr, size);
+    void* newptr = OIC_BACKEND_REALLOC(ptr, size);
     OIC_LOG_V(INFO, TAG, "realloc: ptr=%p, newptr=%p, size=%u", ptr, newptr, size);
     // Very important to return the correct pointer here, as it only *somtimes*
     // differs and thus can be hard to notice/test:
     return newptr;
 #else
-    return realloc(ptr, size);
+    return OIC_BACKEND_REALLOC(ptr, size);
 #endif
 }
 
@@ -132,5 +261,366 @@ void OICFree(void *ptr)
     OIC_LOG_V(INFO, TAG, "free: ptr=%p, count=%u", ptr, count);
 #endif
 
-    free(ptr);
+    OIC_BACKEND_FREE(ptr);
+}
+
+OICArena *OICArenaCreate(size_t blockSize)
+{
+    if (0 == blockSize || blockSize > SIZE_MAX - OIC_ARENA_HEADER_SIZE - sizeof(OICArenaAlign_t))
+    {
+        return NULL;
+    }
+
+    blockSize = OIC_ARENA_ALIGN(blockSize);
+    OICArena *arena = (OICArena *)OICMalloc(OIC_ARENA_HEADER_SIZE + blockSize);
+    if (!arena)
+    {
+        return NULL;
+    }
+
+    arena->first.next = NULL;
+    arena->first.size = blockSize;
+    arena->first.used = 0;
+    arena->current = &arena->first;
+    arena->blockSize = blockSize;
+    return arena;
+}
+
+void *OICArenaAlloc(OICArena *arena, size_t size)
+{
+    if (!arena || 0 == size || size > SIZE_MAX - OIC_ARENA_BLOCK_HEADER_SIZE
+        - sizeof(OICArenaAlign_t))
+    {
+        return NULL;
+    }
+
+    size = OIC_ARENA_ALIGN(size);
+    OICArenaBlock *block = arena->current;
+    if (block->size - block->used < size)
+    {
+        size_t newSize = (size > arena->blockSize) ? size : arena->blockSize;
+        block = (OICArenaBlock *)OICMalloc(OIC_ARENA_BLOCK_HEADER_SIZE + newSize);
+        if (!block)
+        {
+            return NULL;
+        }
+        block->next = arena->current;
+        block->size = newSize;
+        block->used = 0;
+        arena->current = block;
+    }
+
+    uint8_t *data = (block == &arena->first)
+                    ? (uint8_t *)arena + OIC_ARENA_HEADER_SIZE
+                    : (uint8_t *)block + OIC_ARENA_BLOCK_HEADER_SIZE;
+    void *ptr = data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+void *OICArenaCalloc(OICArena *arena, size_t num, size_t size)
+{
+    if (0 == num || 0 == size || num > SIZE_MAX / size)
+    {
+        return NULL;
+    }
+
+    void *ptr = OICArenaAlloc(arena, num * size);
+    if (ptr)
+    {
+        memset(ptr, 0, num * size);
+    }
+    return ptr;
+}
+
+void OICArenaReset(OICArena *arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+
+    OICArenaBlock *block = arena->current;
+    while (block != &arena->first)
+    {
+        OICArenaBlock *next = block->next;
+        OICFree(block);
+        block = next;
+    }
+    arena->first.used = 0;
+    arena->current = &arena->first;
+}
+
+void OICArenaDestroy(OICArena *arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+
+    OICArenaReset(arena);
+    OICFree(arena);
+}
+
+size_t OICGetSlabStats(OICSlabStats *stats, size_t count)
+{
+#ifdef WITH_MALLOC_SLAB
+    for (size_t i = 0; stats && i < count && i < OIC_SLAB_CLASS_COUNT; i++)
+    {
+        OICSlabClass *slabClass = &g_slabClasses[i];
+        stats[i].objectSize = g_slabSizes[i];
+        stats[i].allocCount = __atomic_load_n(&slabClass->allocCount, __ATOMIC_RELAXED);
+        stats[i].freeCount = __atomic_load_n(&slabClass->freeCount, __ATOMIC_RELAXED);
+        stats[i].inUse = __atomic_load_n(&slabClass->inUse, __ATOMIC_RELAXED);
+        stats[i].peakInUse = __atomic_load_n(&slabClass->peakInUse, __ATOMIC_RELAXED);
+        stats[i].chunkCount = __atomic_load_n(&slabClass->chunkCount, __ATOMIC_RELAXED);
+    }
+    return OIC_SLAB_CLASS_COUNT;
+#else
+    (void)stats;
+    (void)count;
+    return 0;
+#endif
+}
+
+#ifdef WITH_MALLOC_SLAB
+static size_t OICSlabRegistrySlot(uintptr_t base)
+{
+    return (size_t)((base / OIC_SLAB_CHUNK_SIZE) * 2654435761u)
+           % (sizeof(g_slabRegistry) / sizeof(g_slabRegistry[0]));
+}
+
+static bool OICSlabIsChunk(uintptr_t base)
+{
+    const size_t slots = sizeof(g_slabRegistry) / sizeof(g_slabRegistry[0]);
+    for (size_t i = OICSlabRegistrySlot(base), n = 0; n < slots; i = (i + 1) % slots, n++)
+    {
+        uintptr_t entry = __atomic_load_n(&g_slabRegistry[i], __ATOMIC_ACQUIRE);
+        if (entry == base)
+        {
+            return true;
+        }
+        if (0 == entry)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+/** Carves a new chunk into the free list of a class.  Caller holds g_slabMutex. */
+static bool OICSlabAddChunk(size_t classIndex)
+{
+    if (g_slabChunkTotal >= OIC_SLAB_MAX_CHUNKS)
+    {
+        return false;
+    }
+
+    void *mem = NULL;
+    if (0 != posix_memalign(&mem, OIC_SLAB_CHUNK_SIZE, OIC_SLAB_CHUNK_SIZE))
+    {
+        return false;
+    }
+
+    OICSlabChunk *chunk = (OICSlabChunk *)mem;
+    chunk->classIndex = classIndex;
+
+    OICSlabClass *slabClass = &g_slabClasses[classIndex];
+    size_t objectSize = g_slabSizes[classIndex];
+    uint8_t *end = (uint8_t *)mem + OIC_SLAB_CHUNK_SIZE;
+    for (uint8_t *obj = (uint8_t *)mem + OIC_ARENA_ALIGN(sizeof(OICSlabChunk));
+         obj + objectSize <= end; obj += objectSize)
+    {
+        ((OICSlabObject *)obj)->next = slabClass->freeList;
+        slabClass->freeList = (OICSlabObject *)obj;
+    }
+
+    const size_t slots = sizeof(g_slabRegistry) / sizeof(g_slabRegistry[0]);
+    size_t i = OICSlabRegistrySlot((uintptr_t)mem);
+    while (g_slabRegistry[i])
+    {
+        i = (i + 1) % slots;
+    }
+    __atomic_store_n(&g_slabRegistry[i], (uintptr_t)mem, __ATOMIC_RELEASE);
+
+    g_slabChunkTotal++;
+    __atomic_add_fetch(&slabClass->chunkCount, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+/** Returns all but keep cached objects of a class to the shared free list. */
+static void OICSlabFlush(OICSlabCache *cache, size_t classIndex, size_t keep)
+{
+    pthread_mutex_lock(&g_slabMutex);
+    while (cache->count[classIndex] > keep)
+    {
+        OICSlabObject *obj = cache->head[classIndex];
+        cache->head[classIndex] = obj->next;
+        cache->count[classIndex]--;
+        obj->next = g_slabClasses[classIndex].freeList;
+        g_slabClasses[classIndex].freeList = obj;
+    }
+    pthread_mutex_unlock(&g_slabMutex);
+}
+
+static void OICSlabCacheDestroy(void *data)
+{
+    OICSlabCache *cache = (OICSlabCache *)data;
+    for (size_t i = 0; i < OIC_SLAB_CLASS_COUNT; i++)
+    {
+        OICSlabFlush(cache, i, 0);
+    }
+    // Frees issued by later thread-exit destructors re-register the cache
+    g_slabCacheRegistered = false;
+}
+
+static void OICSlabCreateCacheKey(void)
+{
+    pthread_key_create(&g_slabCacheKey, OICSlabCacheDestroy);
 }
+
+static OICSlabCache *OICSlabGetCache(void)
+{
+    if (!g_slabCacheRegistered)
+    {
+        // Only used to hand the cache back to the classes when the thread exits
+        pthread_once(&g_slabCacheOnce, OICSlabCreateCacheKey);
+        pthread_setspecific(g_slabCacheKey, &g_slabCache);
+        g_slabCacheRegistered = true;
+    }
+    return &g_slabCache;
+}
+
+static size_t OICSlabClassIndex(size_t size)
+{
+    size_t i = 0;
+    while (i < OIC_SLAB_CLASS_COUNT && g_slabSizes[i] < size)
+    {
+        i++;
+    }
+    return i;
+}
+
+static void *OICSlabAlloc(size_t size)
+{
+    size_t classIndex = OICSlabClassIndex(size);
+    if (classIndex >= OIC_SLAB_CLASS_COUNT)
+    {
+        return malloc(size);
+    }
+
+    OICSlabCache *cache = OICSlabGetCache();
+    if (!cache->head[classIndex])
+    {
+        pthread_mutex_lock(&g_slabMutex);
+        OICSlabClass *slabClass = &g_slabClasses[classIndex];
+        while (cache->count[classIndex] < OIC_SLAB_REFILL_COUNT
+               && (slabClass->freeList || OICSlabAddChunk(classIndex)))
+        {
+            OICSlabObject *obj = slabClass->freeList;
+            slabClass->freeList = obj->next;
+            obj->next = cache->head[classIndex];
+            cache->head[classIndex] = obj;
+            cache->count[classIndex]++;
+        }
+        pthread_mutex_unlock(&g_slabMutex);
+
+        if (!cache->head[classIndex])
+        {
+            // Chunk limit reached; OICSlabFree() hands this back to free()
+            return malloc(size);
+        }
+    }
+
+    OICSlabObject *obj = cache->head[classIndex];
+    cache->head[classIndex] = obj->next;
+    cache->count[classIndex]--;
+
+    OICSlabClass *slabClass = &g_slabClasses[classIndex];
+    __atomic_add_fetch(&slabClass->allocCount, 1, __ATOMIC_RELAXED);
+    size_t inUse = __atomic_add_fetch(&slabClass->inUse, 1, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&slabClass->peakInUse, __ATOMIC_RELAXED);
+    while (inUse > peak && !__atomic_compare_exchange_n(&slabClass->peakInUse, &peak, inUse,
+                                                        true, __ATOMIC_RELAXED,
+                                                        __ATOMIC_RELAXED))
+    {
+    }
+    return obj;
+}
+
+static void *OICSlabCalloc(size_t num, size_t size)
+{
+    if (num > SIZE_MAX / size)
+    {
+        return NULL;
+    }
+
+    size_t total = num * size;
+    if (OICSlabClassIndex(total) >= OIC_SLAB_CLASS_COUNT)
+    {
+        return calloc(num, size);
+    }
+
+    void *ptr = OICSlabAlloc(total);
+    if (ptr)
+    {
+        memset(ptr, 0, total);
+    }
+    return ptr;
+}
+
+static void *OICSlabRealloc(void *ptr, size_t size)
+{
+    uintptr_t base = (uintptr_t)ptr & ~((uintptr_t)OIC_SLAB_CHUNK_SIZE - 1);
+    if (!OICSlabIsChunk(base))
+    {
+        return realloc(ptr, size);
+    }
+
+    size_t objectSize = g_slabSizes[((OICSlabChunk *)base)->classIndex];
+    if (size <= objectSize)
+    {
+        return ptr;
+    }
+
+    void *newPtr = OICSlabAlloc(size);
+    if (newPtr)
+    {
+        memcpy(newPtr, ptr, objectSize);
+        OICSlabFree(ptr);
+    }
+    return newPtr;
+}
+
+static void OICSlabFree(void *ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    // Memory from malloc() (large requests, tinycbor, the fallback above) never
+    // lies inside a registered chunk, so anything else goes back to free().
+    uintptr_t base = (uintptr_t)ptr & ~((uintptr_t)OIC_SLAB_CHUNK_SIZE - 1);
+    if (!OICSlabIsChunk(base))
+    {
+        free(ptr);
+        return;
+    }
+
+    size_t classIndex = ((OICSlabChunk *)base)->classIndex;
+    OICSlabCache *cache = OICSlabGetCache();
+    OICSlabObject *obj = (OICSlabObject *)ptr;
+    obj->next = cache->head[classIndex];
+    cache->head[classIndex] = obj;
+    cache->count[classIndex]++;
+
+    __atomic_add_fetch(&g_slabClasses[classIndex].freeCount, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&g_slabClasses[classIndex].inUse, 1, __ATOMIC_RELAXED);
+
+    if (cache->count[classIndex] > OIC_SLAB_CACHE_LIMIT)
+    {
+        OICSlabFlush(cache, classIndex, OIC_SLAB_CACHE_LIMIT / 2);
+    }
+}
+#endif
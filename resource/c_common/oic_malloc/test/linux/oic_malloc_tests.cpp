@@ -39,6 +39,7 @@ extern "C" {
 #include <string.h>
 
 #include <iostream>
+#include <vector>
 #include <stdint.h>
 using namespace std;
 
@@ -138,3 +139,73 @@ TEST(OICCalloc, CallocFail4)
     EXPECT_TRUE(NULL == pBuffer);
     OICFree(pBuffer);
 }
+
+TEST(OICArena, AllocPass)
+{
+    OICArena *arena = OICArenaCreate(64);
+    ASSERT_TRUE(NULL != arena);
+
+    // Fill the first block, then spill into an oversized block
+    uint8_t *small = (uint8_t *)OICArenaAlloc(arena, 3);
+    uint8_t *large = (uint8_t *)OICArenaAlloc(arena, 1024);
+    ASSERT_TRUE(NULL != small);
+    ASSERT_TRUE(NULL != large);
+    EXPECT_EQ(0u, (uintptr_t)large % sizeof(void *));
+    memset(small, 0xA5, 3);
+    memset(large, 0x5A, 1024);
+
+    uint32_t *zeroed = (uint32_t *)OICArenaCalloc(arena, 16, sizeof(uint32_t));
+    ASSERT_TRUE(NULL != zeroed);
+    for (size_t i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(0u, zeroed[i]);
+    }
+
+    OICArenaReset(arena);
+    EXPECT_TRUE(small == OICArenaAlloc(arena, 3));
+    OICArenaDestroy(arena);
+}
+
+TEST(OICArena, AllocFail)
+{
+    EXPECT_TRUE(NULL == OICArenaCreate(0));
+    OICArena *arena = OICArenaCreate(16);
+    ASSERT_TRUE(NULL != arena);
+    EXPECT_TRUE(NULL == OICArenaAlloc(arena, 0));
+    EXPECT_TRUE(NULL == OICArenaAlloc(NULL, 8));
+    EXPECT_TRUE(NULL == OICArenaCalloc(arena, 2, SIZE_MAX));
+    OICArenaDestroy(arena);
+    OICArenaDestroy(NULL);
+}
+
+// malloctests_slab builds this file and oic_malloc.c with WITH_MALLOC_SLAB,
+// malloctests reports the test as disabled.
+#ifdef WITH_MALLOC_SLAB
+TEST(OICSlab, StatsTrackAllocations)
+#else
+TEST(OICSlab, DISABLED_StatsTrackAllocations)
+#endif
+{
+    size_t classes = OICGetSlabStats(NULL, 0);
+    ASSERT_LT(0u, classes);
+
+    std::vector<OICSlabStats> before(classes);
+    std::vector<OICSlabStats> after(classes);
+    ASSERT_EQ(classes, OICGetSlabStats(before.data(), classes));
+
+    // Mixed with system allocations, a slab block must grow through realloc
+    uint8_t *ptr = (uint8_t *)OICMalloc(10);
+    ASSERT_TRUE(NULL != ptr);
+    memset(ptr, 0x3C, 10);
+    ptr = (uint8_t *)OICRealloc(ptr, 100);
+    ASSERT_TRUE(NULL != ptr);
+    EXPECT_EQ(0x3C, ptr[9]);
+    OICFree(malloc(10));
+
+    OICGetSlabStats(after.data(), classes);
+    EXPECT_EQ(before[0].allocCount + 1, after[0].allocCount);
+    EXPECT_EQ(before[0].freeCount + 1, after[0].freeCount);
+    EXPECT_EQ(before[0].inUse, after[0].inUse);
+    EXPECT_LE(1u, after[0].chunkCount);
+    OICFree(ptr);
+}
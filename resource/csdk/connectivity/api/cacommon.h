@@ -90,6 +90,7 @@ extern "C"
 
 #ifdef WITH_BWT
 #define CA_DEFAULT_BLOCK_SIZE       CA_BLOCK_SIZE_1024_BYTE
+#define CA_MAX_BLOCK_WINDOW_SIZE    32 /* maximum number of blocks in flight per transfer */
 #endif
 
 /**
@@ -542,9 +543,10 @@ typedef struct
         void *threadpool;       /**< threadpool between Initialize and Start */
         CASocket_t ipv4;        /**< IPv4 accept socket */
         CASocket_t ipv6;        /**< IPv6 accept socket */
-        void *svrlist;          /**< unicast IPv4 TCP server information*/
         int selectTimeout;      /**< in seconds */
         int listenBacklog;      /**< backlog counts*/
+        size_t sendHighWatermark;   /**< per-session send queue size that rejects sends */
+        size_t sendLowWatermark;    /**< send queue size that accepts sends again */
         int shutdownFds[2];     /**< shutdown pipe */
         int connectionFds[2];   /**< connection pipe */
         int maxfd;              /**< highest fd (for select) */
@@ -78,6 +78,49 @@ typedef void (*CAKeepAliveConnectionCallback)(const CAEndpoint_t *object, bool i
  */
 void CARegisterKeepAliveHandler(CAKeepAliveConnectionCallback ConnHandler);
 #endif
+
+#ifdef WITH_BWT
+/**
+ * Callback function to stream the payload of a received block-wise transfer.
+ * @param[in]   object          remote device information.
+ * @param[in]   token           token of the transfer.
+ * @param[in]   tokenLength     length of the token.
+ * @param[in]   offset          offset of the block in the full payload.
+ * @param[in]   data            payload of the block.
+ * @param[in]   dataLength      length of data.
+ * @return true if the block was consumed. False for the first block buffers the transfer
+ *         as usual; false for a later block aborts the transfer.
+ */
+typedef bool (*CABlockDataSinkCallback)(const CAEndpoint_t *object, const CAToken_t token,
+                                        uint8_t tokenLength, size_t offset,
+                                        const uint8_t *data, size_t dataLength);
+
+/**
+ * Register a sink for the payload of received block-wise transfers.
+ * The sink is offered the first block of every transfer. If it accepts it, all
+ * later blocks of that transfer are passed to it as they arrive instead of being
+ * reassembled in memory, and the request or response delivered to the handler
+ * after the last block carries no payload. Offsets restart at 0 if the remote
+ * device restarts the transfer. If the sink refuses a later block the transfer is
+ * aborted: a server answers the request with 5.00 (Internal Server Error), and a
+ * client's response handler gets a response with that result and no payload.
+ * @param[in]   sinkHandler     sink callback, or NULL to buffer all transfers.
+ */
+void CARegisterBlockDataSink(CABlockDataSinkCallback sinkHandler);
+
+/**
+ * Set the number of blocks a block-wise transfer may have in flight.
+ * With a window larger than 1, a client requests up to this many Block2 blocks ahead
+ * once the first block and its Size2 option have arrived, and sends up to this many
+ * Block1 blocks without waiting for each 2.31 (Continue). Blocks arriving out of order
+ * are reassembled before the transfer is delivered. Both devices have to set the window
+ * so that every block is acknowledged with its own block number.
+ * Transfers passed to the block data sink stay stop-and-wait.
+ * @param[in]   windowSize      1 (stop-and-wait, the default) to ::CA_MAX_BLOCK_WINDOW_SIZE.
+ * @return ::CA_STATUS_OK or ::CA_STATUS_INVALID_PARAM.
+ */
+CAResult_t CASetBlockWiseWindowSize(uint8_t windowSize);
+#endif
 /**
  * Initialize the connectivity abstraction module.
  * It will initialize adapters, thread pool and other modules based on the platform
@@ -221,6 +264,19 @@ CAResult_t CAGetNetworkInformation(CAEndpoint_t **info, uint32_t *size);
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Block the caller until there is received data for ::CAHandleRequestResponse,
+ * ::CAWakeupRequestResponse is called or the timeout elapses.
+ * @param[in]   timeout     maximum time to wait in microseconds, 0 waits without timeout.
+ * @return   ::CA_STATUS_OK or ::CA_STATUS_NOT_INITIALIZED or ::CA_NOT_SUPPORTED
+ */
+CAResult_t CAWaitForRequestResponse(uint64_t timeout);
+
+/**
+ * Wake up a thread blocked in ::CAWaitForRequestResponse.
+ */
+void CAWakeupRequestResponse();
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
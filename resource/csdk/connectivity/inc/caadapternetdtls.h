@@ -99,6 +99,13 @@ typedef struct
     uint8_t ifIndex;                /**< Holds adapter index to get callback info. */
 } stCADtlsAddrInfo_t;
 
+/** Entry of the peerInfo list. */
+typedef struct
+{
+    CASecureEndpoint_t sep;         /**< Peer endpoint and identity. */
+    CAEndpointKey_t key;            /**< Peer address, used to look up the entry. */
+} CADtlsPeerInfo_t;
+
 /**
  * structure to holds the information of cache message and address info.
  */
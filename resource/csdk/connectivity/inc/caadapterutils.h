@@ -52,6 +52,18 @@ extern "C"
  */
 #define CA_INTERFACE_NAME_SIZE 16
 
+#if defined(__linux__) && !defined(__ANDROID__) && !defined(WITH_ARDUINO)
+/**
+ * Socket adapters wait for events with epoll instead of select.
+ */
+#define CA_USE_EPOLL
+
+/**
+ * The IP adapter sends the datagrams of its send queue in batches with sendmmsg.
+ */
+#define CA_USE_SENDMMSG
+#endif
+
 /**
  * Macro to allocate memory for ipv4 address in the form of uint8_t.
  */
@@ -190,6 +202,44 @@ void CAClearNetInterfaceInfoList(u_arraylist_t *infoList);
 void CAClearServerInfoList(u_arraylist_t *serverInfoList);
 
 #ifndef WITH_ARDUINO
+/**
+ * Binary form of an IP endpoint, used to match peers in internal tables
+ * without formatting or comparing address strings.
+ * Every byte is significant (it may be hashed or compared with memcmp), so
+ * it must only be filled in by CAConvertAddrToKey or CAConvertNameToKey.
+ */
+typedef struct
+{
+    uint16_t family;                    /**< AF_INET or AF_INET6 */
+    uint16_t port;                      /**< host order port number */
+    uint32_t scope;                     /**< IPv6 scope id, 0 for IPv4 */
+    uint8_t addr[16];                   /**< network order address, zero padded */
+} CAEndpointKey_t;
+
+/**
+ * Convert address from binary to endpoint key.
+ * @param[in]    sockAddr     IP address info.
+ * @param[out]   key          endpoint key.
+ */
+void CAConvertAddrToKey(const struct sockaddr_storage *sockAddr, CAEndpointKey_t *key);
+
+/**
+ * Convert address from string to endpoint key.
+ * @param[in]    host         numeric address string, optionally with a %scope suffix.
+ * @param[in]    port         host order port number.
+ * @param[out]   key          endpoint key.
+ * @return  true if host is a numeric IPv4 or IPv6 address, false otherwise.
+ */
+bool CAConvertNameToKey(const char *host, uint16_t port, CAEndpointKey_t *key);
+
+/**
+ * Convert endpoint key to string.
+ * @param[in]    key          endpoint key.
+ * @param[out]   host         address string (must be MAX_ADDR_STR_SIZE_CA).
+ * @param[out]   port         host order port number.
+ */
+void CAConvertKeyToName(const CAEndpointKey_t *key, char *host, uint16_t *port);
+
 /**
  * Convert address from binary to string.
  * @param[in]    sockAddr     IP address info.
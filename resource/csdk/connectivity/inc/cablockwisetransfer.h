@@ -33,8 +33,10 @@
 #include "camutex.h"
 #include "uarraylist.h"
 #include "cacommon.h"
+#include "cainterface.h"
 #include "caprotocolmessage.h"
 #include "camessagehandler.h"
+#include "uthash.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -64,8 +66,14 @@ typedef struct
     /** callback function for received message. **/
     CAReceiveThreadFunc receivedThreadFunc;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** block data of the ongoing transfers, hashed by block data ID. **/
+    struct CABlockData *dataTable;
+
+    /** sink for received payload, or NULL to buffer it. **/
+    CABlockDataSinkCallback dataSink;
+
+    /** number of blocks a transfer may have in flight. **/
+    uint8_t windowSize;
 
     /** data list mutex for synchronization. **/
     ca_mutex blockDataListMutex;
@@ -86,7 +94,7 @@ typedef struct
 /**
  * Block Data Set.
  */
-typedef struct
+typedef struct CABlockData
 {
     coap_block_t block1;                /**< block1 option. */
     coap_block_t block2;                /**< block2 option. */
@@ -94,8 +102,21 @@ typedef struct
     CABlockDataID_t* blockDataId;        /**< ID set of CABlockData. */
     CAData_t *sentData;                 /**< sent request or response data information. */
     CAPayload_t payload;                /**< payload buffer. */
+    size_t payloadCapacity;             /**< allocated size of the payload buffer. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
+    bool streamed;                      /**< received payload is passed to the data sink. */
+    bool windowed;                      /**< blocks are sent without waiting for each reply. */
+    uint8_t windowSize;                 /**< blocks in flight, 1 once the peer fell back
+                                             to stop-and-wait. */
+    uint32_t nextBlockNum;              /**< next block to be requested or sent in window. */
+    uint32_t windowBase;                /**< first block not yet received or acknowledged. */
+    uint32_t resentBase;                /**< windowBase last asked for again, UINT32_MAX
+                                             if none; each gap is re-requested once. */
+    uint32_t blocksAhead;               /**< bitmap of blocks received or acknowledged
+                                             after windowBase, bit n is windowBase + n. */
+    size_t aheadEnd;                    /**< payload end if the last block arrived ahead. */
+    UT_hash_handle hh;                  /**< handle of the block data table. */
 } CABlockData_t;
 
 /**
@@ -131,6 +152,19 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc blockSendMethod,
  */
 CAResult_t CATerminateBlockWiseTransfer();
 
+/**
+ * Set the sink for the payload of received block-wise transfers.
+ * @param[in]   sink    sink callback, or NULL to buffer all transfers.
+ */
+void CASetBlockDataSink(CABlockDataSinkCallback sink);
+
+/**
+ * Set the number of blocks a transfer may have in flight.
+ * @param[in]   windowSize  1 to ::CA_MAX_BLOCK_WINDOW_SIZE.
+ * @return ::CA_STATUS_OK or ::CA_STATUS_INVALID_PARAM.
+ */
+CAResult_t CASetBlockWindowSize(uint8_t windowSize);
+
 /**
  * initialize mutex.
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
@@ -148,6 +148,25 @@ void CAIPSendData(CAEndpoint_t *endpoint,
                   uint32_t dataLength,
                   bool isMulticast);
 
+/**
+ * Send UDP data like CAIPSendData(), but collect the datagrams until CAIPFlushSendData() and
+ * send them with as few system calls as possible. Only to be called from the IP send thread.
+ *
+ * @param[in]  endpoint          complete network address to send to.
+ * @param[in]  data              Data to be send, must stay valid until CAIPFlushSendData().
+ * @param[in]  dataLength        Length of data in bytes.
+ * @param[in]  isMulticast       Whether data needs to be sent to multicast ip.
+ */
+void CAIPQueueSendData(CAEndpoint_t *endpoint,
+                       const void *data,
+                       uint32_t dataLength,
+                       bool isMulticast);
+
+/**
+ * Send the datagrams collected by CAIPQueueSendData().
+ */
+void CAIPFlushSendData();
+
 /**
  * Get IP adapter connection state.
  *
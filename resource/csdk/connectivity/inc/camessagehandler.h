@@ -97,6 +97,18 @@ void CATerminateMessageHandler();
  */
 void CAHandleRequestResponseCallbacks();
 
+/**
+ * Wait until received data is queued for ::CAHandleRequestResponseCallbacks.
+ * @param[in] timeout    maximum time to wait in microseconds, 0 waits without timeout.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAWaitRequestResponseCallbacks(uint64_t timeout);
+
+/**
+ * Wake up a thread blocked in ::CAWaitRequestResponseCallbacks.
+ */
+void CAWakeupRequestResponseCallbacks();
+
 /**
  * Setting the Callback funtion for network state change callback.
  * @param[in] nwMonitorHandler    callback for network state change.
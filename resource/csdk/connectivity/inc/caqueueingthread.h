@@ -44,6 +44,40 @@ typedef void (*CAThreadTask)(void *threadData);
 /** Data destroy function. **/
 typedef void (*CADataDestroyFunction)(void *data, uint32_t size);
 
+/** Function invoked after each batch of data was given to the thread function. **/
+typedef void (*CAThreadBatchEndTask)();
+
+/** Data match function used to remove queued data, returns true for data to be removed. **/
+typedef bool (*CADataMatchFunction)(void *data, uint32_t size, void *context);
+
+/**
+ * Lock-free queue the thread is operating on. Producers publish into a bounded ring without
+ * taking the thread mutex; only the overflow path (ring full) and waking a sleeping consumer
+ * take it.
+ */
+typedef struct CAQueueingRing CAQueueingRing_t;
+
+/** Counters of a queueing thread, see ::CAQueueingThreadGetStats. **/
+typedef struct
+{
+    /** Number of data added to the queue. **/
+    uint64_t enqueued;
+    /** Number of data taken from the queue. **/
+    uint64_t dequeued;
+    /** Number of data which did not fit into the ring and went to the overflow list. **/
+    uint64_t overflowed;
+    /** Number of times the consumer went to sleep on an empty queue. **/
+    uint64_t waits;
+    /** Current number of queued data. **/
+    uint32_t depth;
+    /** Highest number of queued data seen. **/
+    uint32_t maxDepth;
+    /** Sum of the time data spent queued, in microseconds. **/
+    uint64_t totalLatencyUs;
+    /** Longest time a data spent queued, in microseconds. **/
+    uint64_t maxLatencyUs;
+} CAQueueingThreadStats_t;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -56,10 +90,12 @@ typedef struct
     CAThreadTask threadTask;
     /** Data destroy function. **/
     CADataDestroyFunction destroy;
+    /** Function invoked after each batch, before the data of the batch is destroyed. **/
+    CAThreadBatchEndTask batchEnd;
     /** Variable to inform the thread to stop. **/
     bool isStop;
     /** Que on which the thread is operating. **/
-    u_queue_t *dataQueue;
+    CAQueueingRing_t *dataQueue;
 } CAQueueingThread_t;
 
 /**
@@ -73,6 +109,16 @@ typedef struct
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy);
 
+/**
+ * Set the function invoked after each batch of data was processed. The data of the batch is
+ * destroyed only after the function returned, so the thread function may keep references to
+ * it until then.
+ * @param[in]   thread       thread data.
+ * @param[in]   task         function to be called after each batch, NULL for none.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadSetBatchEndTask(CAQueueingThread_t *thread, CAThreadBatchEndTask task);
+
 /**
  * Start the queuing thread.
  * @param[in]   thread        thread data that needs to be started.
@@ -89,6 +135,55 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
  */
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size);
 
+/**
+ * Get the number of data currently queued.
+ * @param[in]   thread       thread data.
+ * @return  number of queued data, 0 if the thread is not initialized.
+ */
+uint32_t CAQueueingThreadGetSize(CAQueueingThread_t *thread);
+
+/**
+ * Take the oldest data out of the queue without processing it. Used by callers which run the
+ * queue from their own thread instead of starting the queueing thread.
+ * @param[in]   thread       thread data.
+ * @param[out]  data         data taken from the queue, to be released by the caller.
+ * @param[out]  size         length of the data.
+ * @return  true if data was taken, false if the queue is empty.
+ */
+bool CAQueueingThreadGetData(CAQueueingThread_t *thread, void **data, uint32_t *size);
+
+/**
+ * Wait until data is queued, ::CAQueueingThreadWakeup is called or the timeout expires.
+ * @param[in]   thread       thread data.
+ * @param[in]   timeout      timeout in microseconds, 0 to wait without timeout.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadWaitData(CAQueueingThread_t *thread, uint64_t timeout);
+
+/**
+ * Wake up a caller blocked in ::CAQueueingThreadWaitData.
+ * @param[in]   thread       thread data.
+ */
+void CAQueueingThreadWakeup(CAQueueingThread_t *thread);
+
+/**
+ * Remove and destroy queued data for which the match function returns true.
+ * @param[in]   thread       thread data.
+ * @param[in]   match        function deciding whether the data is removed.
+ * @param[in]   context      context passed to the match function.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadRemoveData(CAQueueingThread_t *thread, CADataMatchFunction match,
+                                      void *context);
+
+/**
+ * Get the queue counters of the thread.
+ * @param[in]   thread       thread data.
+ * @param[out]  stats        counters of the thread.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadGetStats(CAQueueingThread_t *thread, CAQueueingThreadStats_t *stats);
+
 /**
  * Stop the queuing thread.
  * @param[in]   thread       thread data that needs to be started.
@@ -44,9 +44,6 @@
 /** default max retransmission trying count is 4(CoAP). **/
 #define DEFAULT_RETRANSMISSION_COUNT      4
 
-/** check period is 1 sec. **/
-#define RETRANSMISSION_CHECK_PERIOD_SEC     1
-
 /** retransmission data send method type. **/
 typedef CAResult_t (*CADataSendMethod_t)(const CAEndpoint_t *endpoint,
                                          const void *pdu,
@@ -67,6 +64,9 @@ typedef struct
 
 } CARetransmissionConfig_t;
 
+/** retransmission data, defined in caretransmission.c. **/
+struct CARetransmissionData;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -90,8 +90,17 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** retransmission data ordered by next retransmission time (binary min-heap). **/
+    struct CARetransmissionData **dataHeap;
+
+    /** number of retransmission data in dataHeap. **/
+    uint32_t dataCount;
+
+    /** allocated size of dataHeap. **/
+    uint32_t dataCapacity;
+
+    /** retransmission data indexed by message id and transport adapter. **/
+    struct CARetransmissionData *dataTable;
 
 } CARetransmission_t;
 
@@ -27,15 +27,37 @@
 
 #include "cacommon.h"
 #include "caadapterinterface.h"
+#include "caadapterutils.h"
 #include "cathreadpool.h"
 #include "cainterface.h"
 #include "pdu.h"
+#include "uthash.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/**
+ * Outbound data queued on a TCP session until the socket becomes writable.
+ */
+typedef struct CATCPSendBuffer
+{
+    struct CATCPSendBuffer *next;       /**< next queued buffer */
+    unsigned char *data;                /**< data, allocated with this structure */
+    size_t len;                         /**< data length */
+    size_t offset;                      /**< bytes of data already sent */
+} CATCPSendBuffer_t;
+
+/**
+ * Key of the TCP session endpoint index. Every byte is significant, it is hashed.
+ */
+typedef struct
+{
+    CAEndpointKey_t endpoint;           /**< remote address and port */
+    uint32_t flags;                     /**< transport flags that tell sessions apart */
+} CATCPSessionKey_t;
+
 /**
  * TCP Session Information for IPv4 TCP transport
  */
@@ -43,9 +65,17 @@ typedef struct
 {
     CASecureEndpoint_t sep;             /**< secure endpoint information */
     int fd;                             /**< file descriptor info */
-    void *recvData;                     /**< received data from remote device*/
-    size_t recvDataLen;                 /**< received data length */
-    size_t totalDataLen;                /**< total data length */
+    void *recvData;                     /**< receive buffer, reused across messages */
+    size_t recvDataLen;                 /**< bytes of received data in recvData */
+    size_t recvBufSize;                 /**< allocated size of recvData */
+    CATCPSendBuffer_t *sendHead;        /**< first queued outbound buffer */
+    CATCPSendBuffer_t *sendTail;        /**< last queued outbound buffer */
+    size_t sendQueueLen;                /**< bytes waiting in the send queue */
+    bool sendBlocked;                   /**< send queue is above the high watermark */
+    bool writeWatched;                  /**< socket is watched for writability */
+    CATCPSessionKey_t key;              /**< key of the endpoint index */
+    UT_hash_handle fdHh;                /**< handle of the file descriptor index */
+    UT_hash_handle epHh;                /**< handle of the endpoint index */
 } CATCPSessionInfo_t;
 
 /**
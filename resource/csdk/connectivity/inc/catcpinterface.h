@@ -170,10 +170,9 @@ CATCPSessionInfo_t *CAConnectTCPSession(const CAEndpoint_t *endpoint);
  * Disconnect from TCP Server.
  *
  * @param[in]   svritem     TCP session information.
- * @param[in]   index       current session index in list.
  * @return  ::CA_STATUS_OK or Appropriate error code.
  */
-CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem, size_t index);
+CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem);
 
 /**
  * Disconnect all connection from TCP Server.
@@ -181,14 +180,12 @@ CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem, size_t index);
 void CATCPDisconnectAll();
 
 /**
- * Get TCP connection information from list.
+ * Get TCP connection information from the session table.
  *
  * @param[in]   endpoint    remote endpoint information.
- * @param[out]  index   index of array list.
  * @return  TCP Session Information structure.
  */
-CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint,
-                                                    size_t *index);
+CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint);
 
 /**
  * Get total length from CoAP over TCP header.
@@ -199,13 +196,12 @@ CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint
 size_t CAGetTotalLengthFromHeader(const unsigned char *recvBuffer);
 
 /**
- * Get session information from file descriptor index.
+ * Get session information from file descriptor.
  *
  * @param[in]   fd      file descriptor.
- * @param[out]  index   index of array list
  * @return  TCP Server Information structure.
  */
-CATCPSessionInfo_t *CAGetSessionInfoFromFD(int fd, size_t *index);
+CATCPSessionInfo_t *CAGetSessionInfoFromFD(int fd);
 
 #ifdef __cplusplus
 }
@@ -12,7 +12,14 @@
 
 #include <stdlib.h>
 
+#ifdef WITH_MALLOC_SLAB
+#include "oic_malloc.h"
+
+#define coap_malloc(size) OICMalloc(size)
+#define coap_free(size) OICFree(size)
+#else
 #define coap_malloc(size) malloc(size)
 #define coap_free(size) free(size)
+#endif
 
 #endif /* _COAP_MEM_H_ */
@@ -96,42 +96,44 @@ static CAGetDTLSCrlHandler g_getCrlCallback = NULL;
 #endif //__WITH_X509__
 
 
-static CASecureEndpoint_t *GetPeerInfo(const CAEndpoint_t *peer)
+static CADtlsPeerInfo_t *GetPeerInfo(const CAEndpointKey_t *key, uint32_t *index)
 {
     uint32_t list_index = 0;
     uint32_t list_length = 0;
 
-    if(NULL == peer)
+    if(NULL == key)
     {
         OIC_LOG(ERROR, NET_DTLS_TAG, "CAPeerInfoListContains invalid parameters");
         return NULL;
     }
 
-    CASecureEndpoint_t *peerInfo = NULL;
+    CADtlsPeerInfo_t *peerInfo = NULL;
     list_length = u_arraylist_length(g_caDtlsContext->peerInfoList);
     for (list_index = 0; list_index < list_length; list_index++)
     {
-        peerInfo = (CASecureEndpoint_t *)u_arraylist_get(g_caDtlsContext->peerInfoList, list_index);
+        peerInfo = (CADtlsPeerInfo_t *)u_arraylist_get(g_caDtlsContext->peerInfoList, list_index);
         if (NULL == peerInfo)
         {
             continue;
         }
 
-        if((0 == strncmp(peer->addr, peerInfo->endpoint.addr, MAX_ADDR_STR_SIZE_CA)) &&
-                (peer->port == peerInfo->endpoint.port))
+        if (0 == memcmp(key, &peerInfo->key, sizeof (*key)))
         {
+            if (index)
+            {
+                *index = list_index;
+            }
             return peerInfo;
         }
     }
     return NULL;
 }
 
-static CAResult_t CAAddIdToPeerInfoList(const char *peerAddr, uint32_t port,
+static CAResult_t CAAddIdToPeerInfoList(const stCADtlsAddrInfo_t *addrInfo,
         const unsigned char *id, uint16_t id_length)
 {
-    if(NULL == peerAddr
+    if(NULL == addrInfo
        || NULL == id
-       || 0 == port
        || 0 == id_length
        || CA_MAX_ENDPOINT_IDENTITY_LEN < id_length)
     {
@@ -139,26 +141,33 @@ static CAResult_t CAAddIdToPeerInfoList(const char *peerAddr, uint32_t port,
         return CA_STATUS_INVALID_PARAM;
     }
 
-    CASecureEndpoint_t *peer = (CASecureEndpoint_t *)OICCalloc(1, sizeof (CASecureEndpoint_t));
-    if (NULL == peer)
+    CAEndpointKey_t key;
+    CAConvertAddrToKey(&(addrInfo->addr.st), &key);
+    if (0 == key.port)
     {
-        OIC_LOG(ERROR, NET_DTLS_TAG, "peerInfo malloc failed!");
-        return CA_MEMORY_ALLOC_FAILED;
+        OIC_LOG(ERROR, NET_DTLS_TAG, "CAAddIdToPeerInfoList invalid port");
+        return CA_STATUS_INVALID_PARAM;
     }
 
-    OICStrcpy(peer->endpoint.addr, sizeof(peer->endpoint.addr), peerAddr);
-    peer->endpoint.port = port;
-
-    memcpy(peer->identity.id, id, id_length);
-    peer->identity.id_length = id_length;
-
-    if (NULL != GetPeerInfo(&peer->endpoint))
+    if (NULL != GetPeerInfo(&key, NULL))
     {
         OIC_LOG(ERROR, NET_DTLS_TAG, "CAAddIdToPeerInfoList peer already exist");
-        OICFree(peer);
         return CA_STATUS_FAILED;
     }
 
+    CADtlsPeerInfo_t *peer = (CADtlsPeerInfo_t *)OICCalloc(1, sizeof (CADtlsPeerInfo_t));
+    if (NULL == peer)
+    {
+        OIC_LOG(ERROR, NET_DTLS_TAG, "peerInfo malloc failed!");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    peer->key = key;
+    CAConvertKeyToName(&key, peer->sep.endpoint.addr, &peer->sep.endpoint.port);
+
+    memcpy(peer->sep.identity.id, id, id_length);
+    peer->sep.identity.id_length = id_length;
+
     bool result = u_arraylist_add(g_caDtlsContext->peerInfoList, (void *)peer);
     if (!result)
     {
@@ -175,7 +184,7 @@ static void CAFreePeerInfoList()
     uint32_t list_length = u_arraylist_length(g_caDtlsContext->peerInfoList);
     for (uint32_t list_index = 0; list_index < list_length; list_index++)
     {
-        CAEndpoint_t *peerInfo = (CAEndpoint_t *)u_arraylist_get(
+        CADtlsPeerInfo_t *peerInfo = (CADtlsPeerInfo_t *)u_arraylist_get(
                                      g_caDtlsContext->peerInfoList, list_index);
         OICFree(peerInfo);
     }
@@ -183,29 +192,18 @@ static void CAFreePeerInfoList()
     g_caDtlsContext->peerInfoList = NULL;
 }
 
-static void CARemovePeerFromPeerInfoList(const char * addr, uint16_t port)
+static void CARemovePeerFromPeerInfoList(const CAEndpointKey_t *key)
 {
-    if (NULL == addr || 0 >= port)
+    if (NULL == key || 0 == key->port)
     {
         OIC_LOG(ERROR, NET_DTLS_TAG, "CADTLSGetPeerPSKId invalid parameters");
         return;
     }
 
-    uint32_t list_length = u_arraylist_length(g_caDtlsContext->peerInfoList);
-    for (uint32_t list_index = 0; list_index < list_length; list_index++)
+    uint32_t list_index = 0;
+    if (GetPeerInfo(key, &list_index))
     {
-        CAEndpoint_t *peerInfo = (CAEndpoint_t *)u_arraylist_get(
-                                g_caDtlsContext->peerInfoList,list_index);
-        if (NULL == peerInfo)
-        {
-            continue;
-        }
-        if((0 == strncmp(addr, peerInfo->addr, MAX_ADDR_STR_SIZE_CA)) &&
-                (port == peerInfo->port))
-        {
-            OICFree(u_arraylist_remove(g_caDtlsContext->peerInfoList, list_index));
-            return;
-        }
+        OICFree(u_arraylist_remove(g_caDtlsContext->peerInfoList, list_index));
     }
 }
 
@@ -436,7 +434,9 @@ static int32_t CAReadDecryptedPayload(dtls_context_t *context,
             ((addrInfo->addr.st.ss_family == AF_INET) ? CA_IPV4 : CA_IPV6) | CA_SECURE, .port = 0 },
             .identity =
             { 0 } };
-    CAConvertAddrToName(&(addrInfo->addr.st), addrInfo->size, sep.endpoint.addr, &sep.endpoint.port);
+    CAEndpointKey_t key;
+    CAConvertAddrToKey(&(addrInfo->addr.st), &key);
+    CAConvertKeyToName(&key, sep.endpoint.addr, &sep.endpoint.port);
 
     if (NULL == g_caDtlsContext)
     {
@@ -449,10 +449,10 @@ static int32_t CAReadDecryptedPayload(dtls_context_t *context,
         (NULL != g_caDtlsContext->adapterCallbacks[type].recvCallback))
     {
         // Get identity of the source of packet
-        CASecureEndpoint_t *peerInfo = GetPeerInfo(&sep.endpoint);
+        CADtlsPeerInfo_t *peerInfo = GetPeerInfo(&key, NULL);
         if (peerInfo)
         {
-            sep.identity = peerInfo->identity;
+            sep.identity = peerInfo->sep.identity;
         }
 
         g_caDtlsContext->adapterCallbacks[type].recvCallback(&sep, buf, bufLen);
@@ -525,9 +525,8 @@ static int32_t CAHandleSecureEvent(dtls_context_t *context,
     CAErrorInfo_t errorInfo = {.result=CA_STATUS_OK};
 
     stCADtlsAddrInfo_t *addrInfo = (stCADtlsAddrInfo_t *)session;
-    char peerAddr[MAX_ADDR_STR_SIZE_CA] = { 0 };
-    uint16_t port = 0;
-    CAConvertAddrToName(&(addrInfo->addr.st), addrInfo->size, peerAddr, &port);
+    CAEndpointKey_t key;
+    CAConvertAddrToKey(&(addrInfo->addr.st), &key);
 
     if (!level && (DTLS_EVENT_CONNECTED == code))
     {
@@ -535,8 +534,7 @@ static int32_t CAHandleSecureEvent(dtls_context_t *context,
 
         if(g_dtlsHandshakeCallback)
         {
-            OICStrcpy(endpoint.addr, MAX_ADDR_STR_SIZE_CA, peerAddr);
-            endpoint.port = port;
+            CAConvertKeyToName(&key, endpoint.addr, &endpoint.port);
             errorInfo.result = CA_STATUS_OK;
             g_dtlsHandshakeCallback(&endpoint, &errorInfo);
         }
@@ -547,9 +545,7 @@ static int32_t CAHandleSecureEvent(dtls_context_t *context,
     {
         if(g_dtlsHandshakeCallback)
         {
-            OICStrcpy(endpoint.addr, MAX_ADDR_STR_SIZE_CA, peerAddr);
-            endpoint.addr[MAX_ADDR_STR_SIZE_CA - 1] = '\0';
-            endpoint.port = port;
+            CAConvertKeyToName(&key, endpoint.addr, &endpoint.port);
             errorInfo.result = CA_DTLS_AUTHENTICATION_FAILURE;
             g_dtlsHandshakeCallback(&endpoint, &errorInfo);
         }
@@ -557,12 +553,12 @@ static int32_t CAHandleSecureEvent(dtls_context_t *context,
     else if(DTLS_ALERT_LEVEL_FATAL == level && DTLS_ALERT_HANDSHAKE_FAILURE == code)
     {
         OIC_LOG(INFO, NET_DTLS_TAG, "Failed to DTLS handshake, the peer will be removed.");
-        CARemovePeerFromPeerInfoList(peerAddr, port);
+        CARemovePeerFromPeerInfoList(&key);
     }
     else if(DTLS_ALERT_LEVEL_FATAL == level || DTLS_ALERT_CLOSE_NOTIFY == code)
     {
         OIC_LOG(INFO, NET_DTLS_TAG, "Peer closing connection");
-        CARemovePeerFromPeerInfoList(peerAddr, port);
+        CARemovePeerFromPeerInfoList(&key);
     }
 
     OIC_LOG(DEBUG, NET_DTLS_TAG, "OUT");
@@ -597,11 +593,7 @@ static int32_t CAGetPskCredentials(dtls_context_t *ctx,
         // data structure when handshake completes. Therefore, currently this is a
         // workaround to cache remote end-point identity when tinyDTLS asks for PSK.
         stCADtlsAddrInfo_t *addrInfo = (stCADtlsAddrInfo_t *)session;
-        char peerAddr[MAX_ADDR_STR_SIZE_CA] = { 0 };
-        uint16_t port = 0;
-        CAConvertAddrToName(&(addrInfo->addr.st), addrInfo->size, peerAddr, &port);
-
-        if(CA_STATUS_OK != CAAddIdToPeerInfoList(peerAddr, port, desc, descLen) )
+        if(CA_STATUS_OK != CAAddIdToPeerInfoList(addrInfo, desc, descLen) )
         {
             OIC_LOG(ERROR, NET_DTLS_TAG, "Fail to add peer id to gDtlsPeerInfoList");
         }
@@ -984,11 +976,7 @@ static int CAVerifyCertificate(struct dtls_context_t *ctx, const session_t *sess
     memcpy(y, crtChain[0].pubKey.data + PUBLIC_KEY_SIZE / 2, yLen);
 
     stCADtlsAddrInfo_t *addrInfo = (stCADtlsAddrInfo_t *)session;
-    char peerAddr[MAX_ADDR_STR_SIZE_CA] = { 0 };
-    uint16_t port = 0;
-    CAConvertAddrToName(&(addrInfo->addr.st), addrInfo->size, peerAddr, &port);
-
-    CAResult_t result = CAAddIdToPeerInfoList(peerAddr, port,
+    CAResult_t result = CAAddIdToPeerInfoList(addrInfo,
             crtChain[0].subject.data + DER_SUBJECT_HEADER_LEN + 2, crtChain[0].subject.data[DER_SUBJECT_HEADER_LEN + 1]);
     if (CA_STATUS_OK != result )
     {
@@ -20,6 +20,7 @@
 
 #include "caadapterutils.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include "oic_string.h"
@@ -29,7 +30,10 @@
 #ifndef WITH_ARDUINO
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
 #include <netdb.h>
+#include <stdlib.h>
 #endif
 
 #ifdef __ANDROID__
@@ -119,9 +123,118 @@ CAResult_t CAParseIPv4AddressInternal(const char *ipAddrStr, uint8_t *ipAddr,
 }
 
 #else // not with_arduino
+void CAConvertAddrToKey(const struct sockaddr_storage *sockAddr, CAEndpointKey_t *key)
+{
+    VERIFY_NON_NULL_VOID(sockAddr, CA_ADAPTER_UTILS_TAG, "sockAddr is null");
+    VERIFY_NON_NULL_VOID(key, CA_ADAPTER_UTILS_TAG, "key is null");
+
+    memset(key, 0, sizeof (*key));
+    key->family = sockAddr->ss_family;
+    if (AF_INET6 == sockAddr->ss_family)
+    {
+        const struct sockaddr_in6 *sin6 = (const struct sockaddr_in6 *)sockAddr;
+        key->port = ntohs(sin6->sin6_port);
+        key->scope = sin6->sin6_scope_id;
+        memcpy(key->addr, &sin6->sin6_addr, sizeof (sin6->sin6_addr));
+    }
+    else
+    {
+        const struct sockaddr_in *sin = (const struct sockaddr_in *)sockAddr;
+        key->port = ntohs(sin->sin_port);
+        memcpy(key->addr, &sin->sin_addr, sizeof (sin->sin_addr));
+    }
+}
+
+bool CAConvertNameToKey(const char *host, uint16_t port, CAEndpointKey_t *key)
+{
+    VERIFY_NON_NULL_RET(host, CA_ADAPTER_UTILS_TAG, "host is null", false);
+    VERIFY_NON_NULL_RET(key, CA_ADAPTER_UTILS_TAG, "key is null", false);
+
+    memset(key, 0, sizeof (*key));
+    key->port = port;
+
+    const char *scope = strchr(host, '%');
+    if (!scope)
+    {
+        if (1 == inet_pton(AF_INET, host, key->addr))
+        {
+            key->family = AF_INET;
+            return true;
+        }
+        if (1 == inet_pton(AF_INET6, host, key->addr))
+        {
+            key->family = AF_INET6;
+            return true;
+        }
+        return false;
+    }
+
+    // scoped IPv6 address, e.g. fe80::1%eth0
+    char addr[INET6_ADDRSTRLEN];
+    size_t addrLen = scope - host;
+    if (addrLen >= sizeof (addr))
+    {
+        return false;
+    }
+    memcpy(addr, host, addrLen);
+    addr[addrLen] = '\0';
+    if (1 != inet_pton(AF_INET6, addr, key->addr))
+    {
+        return false;
+    }
+    key->family = AF_INET6;
+
+    scope++;
+    if (isdigit(*scope))
+    {
+        char *end = NULL;
+        key->scope = strtoul(scope, &end, 10);
+        return '\0' == *end;
+    }
+    key->scope = if_nametoindex(scope);
+    return 0 != key->scope;
+}
+
+static void CAFormatAddr(int family, const void *addr, uint32_t scope, char *host)
+{
+    if (!inet_ntop(family, addr, host, MAX_ADDR_STR_SIZE_CA))
+    {
+        OIC_LOG_V(ERROR, CA_ADAPTER_UTILS_TAG, "inet_ntop failed: %s", strerror(errno));
+        host[0] = '\0';
+        return;
+    }
+
+    if (AF_INET6 == family && scope)
+    {
+        // same rendering as getnameinfo: interface name, or index if it has none
+        size_t len = strlen(host);
+        char ifname[IF_NAMESIZE];
+        if (if_indextoname(scope, ifname))
+        {
+            snprintf(host + len, MAX_ADDR_STR_SIZE_CA - len, "%%%s", ifname);
+        }
+        else
+        {
+            snprintf(host + len, MAX_ADDR_STR_SIZE_CA - len, "%%%u", scope);
+        }
+    }
+}
+
+void CAConvertKeyToName(const CAEndpointKey_t *key, char *host, uint16_t *port)
+{
+    VERIFY_NON_NULL_VOID(key, CA_ADAPTER_UTILS_TAG, "key is null");
+    VERIFY_NON_NULL_VOID(host, CA_ADAPTER_UTILS_TAG, "host is null");
+    VERIFY_NON_NULL_VOID(port, CA_ADAPTER_UTILS_TAG, "port is null");
+
+    CAFormatAddr(key->family, key->addr, key->scope, host);
+    *port = key->port;
+}
+
 /*
  * These two conversion functions return void because errors can't happen
- * (because of NI_NUMERIC), and there's nothing to do if they do happen.
+ * (addresses are always numeric), and there's nothing to do if they do happen.
+ * They run for every message, so they use inet_ntop and inet_pton directly
+ * rather than getnameinfo and getaddrinfo.
  */
 void CAConvertAddrToName(const struct sockaddr_storage *sockAddr, socklen_t sockAddrLen,
                          char *host, uint16_t *port)
@@ -130,23 +243,20 @@ void CAConvertAddrToName(const struct sockaddr_storage *sockAddr, socklen_t sock
     VERIFY_NON_NULL_VOID(host, CA_ADAPTER_UTILS_TAG, "host is null");
     VERIFY_NON_NULL_VOID(port, CA_ADAPTER_UTILS_TAG, "port is null");
 
-    int r = getnameinfo((struct sockaddr *)sockAddr,
-                        sockAddrLen,
-                        host, MAX_ADDR_STR_SIZE_CA,
-                        NULL, 0,
-                        NI_NUMERICHOST|NI_NUMERICSERV);
-    if (r)
+    if (AF_INET6 == sockAddr->ss_family && sockAddrLen >= sizeof (struct sockaddr_in6))
     {
-        if (EAI_SYSTEM == r)
-        {
-            OIC_LOG_V(ERROR, CA_ADAPTER_UTILS_TAG,
-                            "getnameinfo failed: errno %s", strerror(errno));
-        }
-        else
-        {
-            OIC_LOG_V(ERROR, CA_ADAPTER_UTILS_TAG,
-                            "getnameinfo failed: %s", gai_strerror(r));
-        }
+        const struct sockaddr_in6 *sin6 = (const struct sockaddr_in6 *)sockAddr;
+        CAFormatAddr(AF_INET6, &sin6->sin6_addr, sin6->sin6_scope_id, host);
+    }
+    else if (AF_INET == sockAddr->ss_family && sockAddrLen >= sizeof (struct sockaddr_in))
+    {
+        const struct sockaddr_in *sin = (const struct sockaddr_in *)sockAddr;
+        CAFormatAddr(AF_INET, &sin->sin_addr, 0, host);
+    }
+    else
+    {
+        OIC_LOG_V(ERROR, CA_ADAPTER_UTILS_TAG, "unsupported address family %d",
+                  sockAddr->ss_family);
         return;
     }
     *port = ntohs(((struct sockaddr_in *)sockAddr)->sin_port); // IPv4 and IPv6
@@ -157,6 +267,30 @@ void CAConvertNameToAddr(const char *host, uint16_t port, struct sockaddr_storag
     VERIFY_NON_NULL_VOID(host, CA_ADAPTER_UTILS_TAG, "host is null");
     VERIFY_NON_NULL_VOID(sockaddr, CA_ADAPTER_UTILS_TAG, "sockaddr is null");
 
+    CAEndpointKey_t key;
+    if (CAConvertNameToKey(host, port, &key))
+    {
+        if (AF_INET6 == key.family)
+        {
+            struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)sockaddr;
+            memset(sin6, 0, sizeof (*sin6));
+            sin6->sin6_family = AF_INET6;
+            sin6->sin6_port = htons(port);
+            sin6->sin6_scope_id = key.scope;
+            memcpy(&sin6->sin6_addr, key.addr, sizeof (sin6->sin6_addr));
+        }
+        else
+        {
+            struct sockaddr_in *sin = (struct sockaddr_in *)sockaddr;
+            memset(sin, 0, sizeof (*sin));
+            sin->sin_family = AF_INET;
+            sin->sin_port = htons(port);
+            memcpy(&sin->sin_addr, key.addr, sizeof (sin->sin_addr));
+        }
+        return;
+    }
+
+    // other numeric forms (e.g. abbreviated IPv4) are left to getaddrinfo
     struct addrinfo *addrs;
     struct addrinfo hints = { .ai_family = AF_UNSPEC,
                               .ai_socktype = SOCK_DGRAM,
@@ -2615,6 +2615,20 @@ static void CALEErrorHandler(const char *remoteAddress,
 }
 
 #ifndef SINGLE_THREAD
+static bool CALESendQueueDataMatch(void *data, uint32_t size, void *context)
+{
+    (void)size;
+    CALEData_t *bleData = (CALEData_t *) data;
+    const char *address = (const char *) context;
+
+    if (bleData && bleData->remoteEndpoint && !strcmp(bleData->remoteEndpoint->addr, address))
+    {
+        OIC_LOG(DEBUG, CALEADAPTER_TAG, "found the message of disconnected device");
+        return true;
+    }
+    return false;
+}
+
 static void CALERemoveSendQueueData(CAQueueingThread_t *queueHandle, ca_mutex mutex,
                                     const char* address)
 {
@@ -2624,32 +2638,7 @@ static void CALERemoveSendQueueData(CAQueueingThread_t *queueHandle, ca_mutex mu
     VERIFY_NON_NULL_VOID(address, CALEADAPTER_TAG, "address");
 
     ca_mutex_lock(mutex);
-    while (u_queue_get_size(queueHandle->dataQueue) > 0)
-    {
-        OIC_LOG(DEBUG, CALEADAPTER_TAG, "get data from queue");
-        u_queue_message_t *message = u_queue_get_element(queueHandle->dataQueue);
-        if (NULL != message)
-        {
-            CALEData_t *bleData = (CALEData_t *) message->msg;
-            if (bleData && bleData->remoteEndpoint)
-            {
-                if (!strcmp(bleData->remoteEndpoint->addr, address))
-                {
-                    OIC_LOG(DEBUG, CALEADAPTER_TAG, "found the message of disconnected device");
-                    if (NULL != queueHandle->destroy)
-                    {
-                        queueHandle->destroy(message->msg, message->size);
-                    }
-                    else
-                    {
-                        OICFree(message->msg);
-                    }
-
-                    OICFree(message);
-                }
-            }
-        }
-    }
+    CAQueueingThreadRemoveData(queueHandle, CALESendQueueDataMatch, (void *) address);
     ca_mutex_unlock(mutex);
 }
 
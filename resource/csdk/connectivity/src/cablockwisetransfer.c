@@ -53,10 +53,49 @@
 
 #define BLOCK_SIZE(arg) (1 << ((arg) + 4))
 
+/**
+ * Largest payload buffer allocated up front from a Size1/Size2 option.
+ * Larger transfers grow the buffer as blocks arrive.
+ */
+#define BLOCK_PAYLOAD_PREALLOC_MAX (1024 * 1024)
+
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .receivedThreadFunc = NULL,
-                                          .dataList = NULL };
+                                          .dataTable = NULL,
+                                          .dataSink = NULL,
+                                          .windowSize = 1 };
+
+/**
+ * Find the block data with the given ID.
+ * blockDataListMutex must be held by the caller.
+ */
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!blockID->id || !blockID->idLength)
+    {
+        return NULL;
+    }
+
+    CABlockData_t *currData = NULL;
+    HASH_FIND(hh, g_context.dataTable, blockID->id, blockID->idLength, currData);
+    return currData;
+}
+
+static CAResult_t CASendBlockMessageImpl(const coap_pdu_t *pdu, CAMessageType_t msgType,
+                                         const CABlockDataID_t *blockID, uint16_t blockType,
+                                         const coap_block_t *block);
+
+static void CADestroyBlockData(CABlockData_t *data)
+{
+    if (data->sentData)
+    {
+        CADestroyDataSet(data->sentData);
+    }
+    CADestroyBlockID(data->blockDataId);
+    OICFree(data->payload);
+    OICFree(data);
+}
 
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
@@ -75,6 +114,38 @@ static bool CACheckPayloadLength(const CAData_t *sendData)
     return true;
 }
 
+static CAResult_t CAReservePayload(CABlockData_t *currData, size_t length, bool isSizeOption)
+{
+    if (length <= currData->payloadCapacity)
+    {
+        return CA_STATUS_OK;
+    }
+
+    // the size option gives the total payload length up front; without it,
+    // grow geometrically so the payload isn't copied again for every block
+    size_t capacity = currData->payloadCapacity * 2;
+    if (isSizeOption && currData->payloadLength <= BLOCK_PAYLOAD_PREALLOC_MAX)
+    {
+        capacity = currData->payloadLength;
+    }
+    if (capacity < length)
+    {
+        capacity = length;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "allocate %zu bytes for the payload", capacity);
+    CAPayload_t newPayload = OICRealloc(currData->payload, capacity);
+    if (NULL == newPayload)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    currData->payload = newPayload;
+    currData->payloadCapacity = capacity;
+
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
                                          CAReceiveThreadFunc receivedThreadFunc)
 {
@@ -91,16 +162,9 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.receivedThreadFunc = receivedThreadFunc;
     }
 
-    if (!g_context.dataList)
-    {
-        g_context.dataList = u_arraylist_create();
-    }
-
     CAResult_t res = CAInitBlockWiseMutexVariables();
     if (CA_STATUS_OK != res)
     {
-        u_arraylist_free(&g_context.dataList);
-        g_context.dataList = NULL;
         OIC_LOG(ERROR, TAG, "init has failed");
     }
 
@@ -111,10 +175,9 @@ CAResult_t CATerminateBlockWiseTransfer()
 {
     OIC_LOG(DEBUG, TAG, "CATerminateBlockWiseTransfer");
 
-    if (g_context.dataList)
+    if (g_context.blockDataListMutex)
     {
         CARemoveAllBlockDataFromList();
-        u_arraylist_free(&g_context.dataList);
     }
 
     CATerminateBlockWiseMutexVariables();
@@ -122,6 +185,23 @@ CAResult_t CATerminateBlockWiseTransfer()
     return CA_STATUS_OK;
 }
 
+void CASetBlockDataSink(CABlockDataSinkCallback sink)
+{
+    g_context.dataSink = sink;
+}
+
+CAResult_t CASetBlockWindowSize(uint8_t windowSize)
+{
+    if (!windowSize || CA_MAX_BLOCK_WINDOW_SIZE < windowSize)
+    {
+        OIC_LOG_V(ERROR, TAG, "invalid window size [%d]", windowSize);
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    g_context.windowSize = windowSize;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAInitBlockWiseMutexVariables()
 {
     if (!g_context.blockDataListMutex)
@@ -251,11 +331,72 @@ CAResult_t CASendBlockWiseData(const CAData_t *sendData)
     return res;
 }
 
-CAResult_t CAAddSendThreadQueue(const CAData_t *sendData, const CABlockDataID_t *blockID)
+/**
+ * Add a block option to the header options of the message.
+ * Messages of a windowed transfer carry their block number this way, since the state
+ * of the transfer has moved on by the time the send thread builds the PDU.
+ */
+static CAResult_t CAAddBlockHeaderOption(CAData_t *data, uint16_t blockType,
+                                         const coap_block_t *block)
 {
-    VERIFY_NON_NULL(sendData, TAG, "sendData");
-    VERIFY_NON_NULL(blockID, TAG, "blockID");
+    CAInfo_t *info = data->requestInfo ? &data->requestInfo->info :
+            (data->responseInfo ? &data->responseInfo->info : NULL);
+    if (!info || UINT8_MAX == info->numOptions)
+    {
+        OIC_LOG(ERROR, TAG, "no room for the block option");
+        return CA_STATUS_FAILED;
+    }
+
+    CAHeaderOption_t *options = OICRealloc(info->options,
+                                           (info->numOptions + 1) * sizeof(CAHeaderOption_t));
+    if (!options)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    info->options = options;
+
+    CAHeaderOption_t *option = &options[info->numOptions];
+    memset(option, 0, sizeof(*option));
+    option->protocolID = CA_COAP_ID;
+    option->optionID = blockType;
+    option->optionLength = coap_encode_var_bytes((unsigned char *) option->optionData,
+                                                 ((block->num << BLOCK_NUMBER_IDX)
+                                                  | (block->m << BLOCK_M_BIT_IDX)
+                                                  | block->szx));
+    info->numOptions++;
 
+    return CA_STATUS_OK;
+}
+
+/**
+ * Take the block option added by CAAddBlockHeaderOption() out of the option list.
+ */
+static bool CATakeBlockOption(coap_list_t **options, uint16_t blockType, coap_block_t *block)
+{
+    for (coap_list_t **opt = options; *opt; opt = &(*opt)->next)
+    {
+        coap_option *option = (coap_option *) (*opt)->data;
+        if (blockType == COAP_OPTION_KEY(*option))
+        {
+            unsigned int value = coap_decode_var_bytes(COAP_OPTION_DATA(*option),
+                                                       COAP_OPTION_LENGTH(*option));
+            block->num = value >> BLOCK_NUMBER_IDX;
+            block->m = (value >> BLOCK_M_BIT_IDX) & 0x01;
+            block->szx = value & 0x07;
+
+            coap_list_t *node = *opt;
+            *opt = node->next;
+            coap_delete(node);
+            return true;
+        }
+    }
+    return false;
+}
+
+static CAResult_t CAQueueBlockMessage(const CAData_t *sendData, const CABlockDataID_t *blockID,
+                                      uint16_t blockType, const coap_block_t *block)
+{
     CAData_t *cloneData = CACloneCAData(sendData);
     if (!cloneData)
     {
@@ -264,6 +405,13 @@ CAResult_t CAAddSendThreadQueue(const CAData_t *sendData, const CABlockDataID_t
         return CA_STATUS_FAILED;
     }
 
+    if (block && CA_STATUS_OK != CAAddBlockHeaderOption(cloneData, blockType, block))
+    {
+        CADestroyDataSet(cloneData);
+        CARemoveBlockDataFromList(blockID);
+        return CA_STATUS_FAILED;
+    }
+
     if (g_context.sendThreadFunc)
     {
         ca_mutex_lock(g_context.blockDataSenderMutex);
@@ -277,6 +425,14 @@ CAResult_t CAAddSendThreadQueue(const CAData_t *sendData, const CABlockDataID_t
     return CA_STATUS_OK;
 }
 
+CAResult_t CAAddSendThreadQueue(const CAData_t *sendData, const CABlockDataID_t *blockID)
+{
+    VERIFY_NON_NULL(sendData, TAG, "sendData");
+    VERIFY_NON_NULL(blockID, TAG, "blockID");
+
+    return CAQueueBlockMessage(sendData, blockID, 0, NULL);
+}
+
 CAResult_t CACheckBlockOptionType(CABlockData_t *currData)
 {
     VERIFY_NON_NULL(currData, TAG, "currData");
@@ -452,6 +608,28 @@ CAResult_t CAReceiveBlockWiseData(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
     return CA_STATUS_OK;
 }
 
+/**
+ * Copy the block option of a transfer to send with a reply in window mode.
+ * Pipelined requests may update the transfer before the reply is sent.
+ */
+static const coap_block_t *CASnapshotBlock(const CABlockDataID_t *blockID, uint16_t blockType,
+                                           coap_block_t *block)
+{
+    if (2 > g_context.windowSize)
+    {
+        return NULL;
+    }
+
+    coap_block_t *current = CAGetBlockOption(blockID, blockType);
+    if (!current)
+    {
+        return NULL;
+    }
+
+    *block = *current;
+    return block;
+}
+
 CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData,
                              uint8_t blockWiseStatus, const CABlockDataID_t *blockID)
 {
@@ -461,6 +639,7 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
 
     CAResult_t res = CA_STATUS_OK;
     CAData_t *data = NULL;
+    coap_block_t block = { 0 };
 
     // process blockWiseStatus
     switch (blockWiseStatus)
@@ -493,7 +672,8 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
                 data->responseInfo->info.messageId = pdu->hdr->coap_hdr_udp_t.id;
             }
 
-            res = CAAddSendThreadQueue(data, blockID);
+            res = CAQueueBlockMessage(data, blockID, COAP_OPTION_BLOCK2,
+                                      CASnapshotBlock(blockID, COAP_OPTION_BLOCK2, &block));
             if (CA_STATUS_OK != res)
             {
                 OIC_LOG(ERROR, TAG, "add has failed");
@@ -504,7 +684,6 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
 
         case CA_OPTION1_RESPONSE:
         case CA_OPTION2_RESPONSE:
-        case CA_OPTION1_REQUEST_BLOCK:
             res = CASendBlockMessage(pdu, pdu->hdr->coap_hdr_udp_t.type, blockID);
             if (CA_STATUS_OK != res)
             {
@@ -513,6 +692,17 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
             }
             break;
 
+        case CA_OPTION1_REQUEST_BLOCK:
+            res = CASendBlockMessageImpl(pdu, pdu->hdr->coap_hdr_udp_t.type, blockID,
+                                         COAP_OPTION_BLOCK1,
+                                         CASnapshotBlock(blockID, COAP_OPTION_BLOCK1, &block));
+            if (CA_STATUS_OK != res)
+            {
+                OIC_LOG(ERROR, TAG, "send has failed");
+                return res;
+            }
+            break;
+
         case CA_OPTION2_LAST_BLOCK:
             // process last block and send upper layer
             res = CAReceiveLastBlock(blockID, receivedData);
@@ -578,8 +768,9 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
     return CA_STATUS_OK;
 }
 
-CAResult_t CASendBlockMessage(const coap_pdu_t *pdu, CAMessageType_t msgType,
-                              const CABlockDataID_t *blockID)
+static CAResult_t CASendBlockMessageImpl(const coap_pdu_t *pdu, CAMessageType_t msgType,
+                                         const CABlockDataID_t *blockID, uint16_t blockType,
+                                         const coap_block_t *block)
 {
     VERIFY_NON_NULL(pdu, TAG, "pdu");
     VERIFY_NON_NULL(pdu->hdr, TAG, "pdu->hdr");
@@ -628,7 +819,7 @@ CAResult_t CASendBlockMessage(const coap_pdu_t *pdu, CAMessageType_t msgType,
     }
 
     // add data to send thread
-    CAResult_t res = CAAddSendThreadQueue(data, blockID);
+    CAResult_t res = CAQueueBlockMessage(data, blockID, blockType, block);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "add has failed");
@@ -637,6 +828,315 @@ CAResult_t CASendBlockMessage(const coap_pdu_t *pdu, CAMessageType_t msgType,
     return res;
 }
 
+CAResult_t CASendBlockMessage(const coap_pdu_t *pdu, CAMessageType_t msgType,
+                              const CABlockDataID_t *blockID)
+{
+    return CASendBlockMessageImpl(pdu, msgType, blockID, 0, NULL);
+}
+
+static bool CAStartBlockWindow(CABlockData_t *data, uint32_t blockNum)
+{
+    if (2 > g_context.windowSize || data->streamed)
+    {
+        return false;
+    }
+
+    // the number of Block2 blocks to request is only known from the size option
+    if (COAP_OPTION_BLOCK2 == data->type && !data->payloadLength)
+    {
+        return false;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "start window of %d blocks at %u", g_context.windowSize, blockNum);
+    data->windowed = true;
+    data->windowSize = g_context.windowSize;
+    data->windowBase = blockNum;
+    data->resentBase = UINT32_MAX;
+    data->nextBlockNum = blockNum;
+    data->blocksAhead = 0;
+    data->aheadEnd = 0;
+    return true;
+}
+
+/**
+ * Request (Block2) or send (Block1) blocks until the window is full.
+ */
+static CAResult_t CASendBlockWindow(const coap_pdu_t *pdu, CABlockData_t *data,
+                                    const CABlockDataID_t *blockID)
+{
+    coap_block_t block = (COAP_OPTION_BLOCK2 == data->type) ? data->block2 : data->block1;
+    size_t blockSize = BLOCK_SIZE(block.szx);
+
+    size_t payloadLen = data->payloadLength;
+    if (COAP_OPTION_BLOCK1 == data->type)
+    {
+        CAGetPayloadInfo(data->sentData, &payloadLen);
+    }
+    size_t blockCount = (payloadLen + blockSize - 1) / blockSize;
+
+    while (data->nextBlockNum < blockCount
+           && data->nextBlockNum - data->windowBase < data->windowSize)
+    {
+        block.num = data->nextBlockNum;
+        block.m = 0;
+
+        // on failure the block data is removed from the list
+        CAResult_t res = CASendBlockMessageImpl(pdu, pdu->hdr->coap_hdr_udp_t.type, blockID,
+                                                data->type, &block);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "send has failed");
+            return res;
+        }
+        data->nextBlockNum++;
+    }
+
+    return CA_STATUS_OK;
+}
+
+/**
+ * Request (Block2) or send (Block1) the first block of the window again. Called when
+ * a later block was answered while this one is still missing, or when the peer does
+ * not pipeline and each block has to be asked for in turn. Every further block that
+ * overtakes the same missing one would ask for it again, so it is only resent once.
+ */
+static CAResult_t CAResendWindowBase(const coap_pdu_t *pdu, CABlockData_t *data,
+                                     const CABlockDataID_t *blockID)
+{
+    if (data->resentBase == data->windowBase)
+    {
+        OIC_LOG_V(DEBUG, TAG, "block %u was already asked for again", data->windowBase);
+        return CA_STATUS_OK;
+    }
+    data->resentBase = data->windowBase;
+
+    coap_block_t block = (COAP_OPTION_BLOCK2 == data->type) ? data->block2 : data->block1;
+    block.num = data->windowBase;
+    block.m = 0;
+
+    OIC_LOG_V(DEBUG, TAG, "resend block %u of the window", block.num);
+    return CASendBlockMessageImpl(pdu, pdu->hdr->coap_hdr_udp_t.type, blockID,
+                                  data->type, &block);
+}
+
+/**
+ * Continue a windowed transfer after a block was received or acknowledged.
+ * @param[in]   ahead   the block was ahead of the first missing one.
+ */
+static CAResult_t CAContinueBlockWindow(const coap_pdu_t *pdu, CABlockData_t *data,
+                                        bool ahead, const CABlockDataID_t *blockID)
+{
+    // The first block is not outstanding any more if a later one overtook it, and
+    // without pipelining it has to be asked for anyway once earlier requests are done.
+    if (data->windowBase < data->nextBlockNum && (ahead || 1 == data->windowSize))
+    {
+        CAResult_t res = CAResendWindowBase(pdu, data, blockID);
+        if (CA_STATUS_OK != res)
+        {
+            return res;
+        }
+    }
+    return CASendBlockWindow(pdu, data, blockID);
+}
+
+/**
+ * Switch a windowed transfer to one block at a time, for a peer that answered a
+ * block which was not asked for.
+ */
+static void CAFallBackToStopAndWait(CABlockData_t *data, uint32_t blockNum)
+{
+    if (1 < data->windowSize)
+    {
+        OIC_LOG_V(INFO, TAG, "block %u was not requested, continue block by block", blockNum);
+        data->windowSize = 1;
+    }
+}
+
+/**
+ * Take over the blocks received ahead of the one that was just stored in order.
+ * @return true if the last block was among them.
+ */
+static bool CAAdvanceBlockWindow(CABlockData_t *currData, size_t blockSize)
+{
+    currData->blocksAhead >>= 1;
+    while (currData->blocksAhead & 0x01)
+    {
+        currData->blocksAhead >>= 1;
+        currData->receivedPayloadLen += blockSize;
+
+        if (currData->aheadEnd && currData->receivedPayloadLen >= currData->aheadEnd)
+        {
+            currData->receivedPayloadLen = currData->aheadEnd;
+            currData->aheadEnd = 0;
+            currData->blocksAhead = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Store a received block of a windowed transfer at its offset in the payload.
+ * Blocks ahead of the first missing one are kept until the gap is filled.
+ * @param[out]  isComplete  set if the transfer has received all blocks.
+ * @return ::CA_BLOCK_UNKNOWN if stored, ::CA_BLOCK_RECEIVED_ALREADY for a duplicate or
+ *         ::CA_BLOCK_INCOMPLETE if the block doesn't fit the transfer.
+ */
+static uint8_t CAStoreWindowBlock(CABlockData_t *currData, const coap_block_t *block,
+                                  uint8_t szx, const CAData_t *receivedData, bool *isComplete)
+{
+    *isComplete = false;
+
+    size_t blockPayloadLen = 0;
+    CAPayload_t blockPayload = CAGetPayloadInfo(receivedData, &blockPayloadLen);
+
+    size_t blockSize = BLOCK_SIZE(szx);
+    if (block->szx != szx || blockPayloadLen > blockSize
+        || (block->m && blockPayloadLen != blockSize))
+    {
+        OIC_LOG(ERROR, TAG, "payload len != block sze");
+        return CA_BLOCK_INCOMPLETE;
+    }
+
+    uint32_t firstMissing = currData->receivedPayloadLen / blockSize;
+    if (block->num < firstMissing)
+    {
+        return CA_BLOCK_RECEIVED_ALREADY;
+    }
+
+    uint32_t ahead = block->num - firstMissing;
+    if (CA_MAX_BLOCK_WINDOW_SIZE <= ahead)
+    {
+        OIC_LOG(ERROR, TAG, "block is out of the window");
+        return CA_BLOCK_INCOMPLETE;
+    }
+
+    if (currData->blocksAhead & (1u << ahead))
+    {
+        return CA_BLOCK_RECEIVED_ALREADY;
+    }
+
+    size_t offset = (size_t) block->num * blockSize;
+    size_t end = offset + blockPayloadLen;
+    if ((currData->aheadEnd && (end > currData->aheadEnd
+                                || (!block->m && end != currData->aheadEnd)))
+        || (!block->m && ((currData->blocksAhead >> ahead)
+                          || (currData->payloadLength && end != currData->payloadLength))))
+    {
+        OIC_LOG(ERROR, TAG, "total payload length is wrong");
+        return CA_BLOCK_INCOMPLETE;
+    }
+
+    if (CA_STATUS_OK != CAReservePayload(currData, end, 0 != currData->payloadLength))
+    {
+        return CA_BLOCK_INCOMPLETE;
+    }
+    if (blockPayloadLen)
+    {
+        memcpy(currData->payload + offset, blockPayload, blockPayloadLen);
+    }
+
+    if (ahead)
+    {
+        OIC_LOG_V(DEBUG, TAG, "block %u is %u ahead", block->num, ahead);
+        currData->blocksAhead |= 1u << ahead;
+        if (!block->m)
+        {
+            currData->aheadEnd = end;
+        }
+        return CA_BLOCK_UNKNOWN;
+    }
+
+    currData->receivedPayloadLen = end;
+    *isComplete = !block->m || CAAdvanceBlockWindow(currData, blockSize);
+    currData->windowBase = currData->receivedPayloadLen / blockSize;
+
+    OIC_LOG_V(DEBUG, TAG, "updated payload len: %zu", currData->receivedPayloadLen);
+    return CA_BLOCK_UNKNOWN;
+}
+
+/**
+ * Handle a 2.31 (Continue) for a block sent in window mode.
+ */
+static CAResult_t CAReceiveBlock1Ack(const coap_pdu_t *pdu, CABlockData_t *data,
+                                     const coap_block_t *block, const CABlockDataID_t *blockID)
+{
+    if (block->szx != data->block1.szx || block->num < data->windowBase)
+    {
+        OIC_LOG_V(DEBUG, TAG, "ignore ack of block %u", block->num);
+        return CA_STATUS_OK;
+    }
+
+    if (block->num >= data->nextBlockNum)
+    {
+        CAFallBackToStopAndWait(data, block->num);
+        return CAResendWindowBase(pdu, data, blockID);
+    }
+
+    uint32_t ahead = block->num - data->windowBase;
+    if (ahead)
+    {
+        if (data->blocksAhead & (1u << ahead))
+        {
+            return CA_STATUS_OK;
+        }
+        data->blocksAhead |= 1u << ahead;
+        return CAContinueBlockWindow(pdu, data, true, blockID);
+    }
+
+    do
+    {
+        data->windowBase++;
+        data->blocksAhead >>= 1;
+    } while (data->blocksAhead & 0x01);
+
+    return CAContinueBlockWindow(pdu, data, false, blockID);
+}
+
+/**
+ * Handle a Block2 response received in window mode.
+ */
+static CAResult_t CAReceiveBlock2Window(const coap_pdu_t *pdu, const CAData_t *receivedData,
+                                        const coap_block_t *block, CABlockData_t *data,
+                                        const CABlockDataID_t *blockID)
+{
+    uint32_t code = CA_RESPONSE_CODE(pdu->hdr->coap_hdr_udp_t.code);
+    if (CA_REQUEST_ENTITY_INCOMPLETE == code || CA_REQUEST_ENTITY_TOO_LARGE == code)
+    {
+        OIC_LOG_V(ERROR, TAG, "windowed transfer has failed [%d]", code);
+        return CA_STATUS_FAILED;
+    }
+
+    if (block->num >= data->nextBlockNum)
+    {
+        CAFallBackToStopAndWait(data, block->num);
+    }
+
+    bool ahead = block->num > data->windowBase;
+    bool isComplete = false;
+    uint8_t blockWiseStatus = CAStoreWindowBlock(data, block, data->block2.szx, receivedData,
+                                                 &isComplete);
+    if (CA_BLOCK_INCOMPLETE == blockWiseStatus)
+    {
+        OIC_LOG(ERROR, TAG, "windowed transfer has failed");
+        return CA_STATUS_FAILED;
+    }
+
+    if (isComplete)
+    {
+        return CAProcessNextStep(pdu, receivedData, CA_OPTION2_LAST_BLOCK, blockID);
+    }
+
+    if (CA_BLOCK_RECEIVED_ALREADY == blockWiseStatus)
+    {
+        // the block was asked for again and both answers made it
+        return CA_STATUS_OK;
+    }
+
+    data->block2.num = data->windowBase;
+    return CAContinueBlockWindow(pdu, data, ahead, blockID);
+}
+
 CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
                               CAResponseResult_t responseResult, const CABlockDataID_t *blockID)
 {
@@ -734,8 +1234,11 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     {
         OICFree(data->payload);
         data->payload = NULL;
+        data->payloadCapacity = 0;
         data->payloadLength = 0;
         data->receivedPayloadLen = 0;
+        data->blocksAhead = 0;
+        data->aheadEnd = 0;
         data->block1.num = 0;
         data->block2.num = 0;
     }
@@ -756,6 +1259,20 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
         return CA_MEMORY_ALLOC_FAILED;
     }
 
+    // the payload of a streamed transfer was already passed to the data sink
+    CABlockData_t *data = CAGetBlockDataFromBlockDataList(blockID);
+    if (data && data->streamed)
+    {
+        CAInfo_t *info = cloneData->requestInfo ? &cloneData->requestInfo->info :
+                (cloneData->responseInfo ? &cloneData->responseInfo->info : NULL);
+        if (info)
+        {
+            OICFree(info->payload);
+            info->payload = NULL;
+            info->payloadSize = 0;
+        }
+    }
+
     // update payload
     size_t fullPayloadLen = 0;
     CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
@@ -782,6 +1299,46 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
     return CA_STATUS_OK;
 }
 
+/**
+ * Ends a transfer the data sink gave up on. A server answers the request with
+ * 5.00 (Internal Server Error), a client passes the response up with that result
+ * and without payload.
+ */
+static CAResult_t CAAbortStreamedTransfer(const coap_pdu_t *pdu, const CAData_t *receivedData,
+                                          const CABlockDataID_t *blockID)
+{
+    if (receivedData->requestInfo)
+    {
+        return CASendErrorMessage(pdu, CA_BLOCK_UNKNOWN, CA_INTERNAL_SERVER_ERROR, blockID);
+    }
+
+    CAData_t *cloneData = CACloneCAData(receivedData);
+    if (!cloneData)
+    {
+        OIC_LOG(ERROR, TAG, "clone has failed");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    if (cloneData->responseInfo)
+    {
+        OICFree(cloneData->responseInfo->info.payload);
+        cloneData->responseInfo->info.payload = NULL;
+        cloneData->responseInfo->info.payloadSize = 0;
+        cloneData->responseInfo->result = CA_INTERNAL_SERVER_ERROR;
+    }
+
+    if (g_context.receivedThreadFunc)
+    {
+        g_context.receivedThreadFunc(cloneData);
+    }
+    else
+    {
+        CADestroyDataSet(cloneData);
+    }
+
+    return CA_STATUS_OK;
+}
+
 // TODO make pdu const after libcoap is updated to support that.
 CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                                  const CAData_t *receivedData, coap_block_t block,
@@ -850,8 +1407,49 @@ CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
         bool isSizeOption = CAIsPayloadLengthInPduWithBlockSizeOption(pdu, COAP_OPTION_SIZE1,
                                                                       &(data->payloadLength));
 
-        blockWiseStatus = CACheckBlockErrorType(data, &block, receivedData,
-                                                COAP_OPTION_BLOCK1, dataLen);
+        size_t blockSize = BLOCK_SIZE(block.szx);
+        if (2 <= g_context.windowSize && !data->streamed && block.m
+            && blockSize * (block.num + 1) <= data->receivedPayloadLen)
+        {
+            // a block of a windowed transfer was sent again; its acknowledgement must
+            // carry its own number for the sender to move its window on
+            res = CASendBlockMessageImpl(pdu, pdu->hdr->coap_hdr_udp_t.type, blockDataID,
+                                         COAP_OPTION_BLOCK1, &block);
+            if (CA_STATUS_OK != res)
+            {
+                OIC_LOG(ERROR, TAG, "send has failed");
+                goto exit;
+            }
+
+            CADestroyBlockID(blockDataID);
+            return res;
+        }
+        else if (2 <= g_context.windowSize && !data->streamed
+                 && blockSize * block.num > data->receivedPayloadLen)
+        {
+            // a block of a windowed transfer arrived ahead of a missing one
+            bool isComplete = false;
+            blockWiseStatus = CAStoreWindowBlock(data, &block, data->block1.szx, receivedData,
+                                                 &isComplete);
+            if (CA_BLOCK_INCOMPLETE != blockWiseStatus)
+            {
+                res = CASendBlockMessageImpl(pdu, pdu->hdr->coap_hdr_udp_t.type, blockDataID,
+                                             COAP_OPTION_BLOCK1, &block);
+                if (CA_STATUS_OK != res)
+                {
+                    OIC_LOG(ERROR, TAG, "send has failed");
+                    goto exit;
+                }
+
+                CADestroyBlockID(blockDataID);
+                return res;
+            }
+        }
+        else
+        {
+            blockWiseStatus = CACheckBlockErrorType(data, &block, receivedData,
+                                                    COAP_OPTION_BLOCK1, dataLen);
+        }
 
         if (CA_BLOCK_RECEIVED_ALREADY != blockWiseStatus)
         {
@@ -861,6 +1459,10 @@ CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             if (CA_STATUS_OK != res)
             {
                 OIC_LOG(ERROR, TAG, "update has failed");
+                if (data->streamed)
+                {
+                    CAAbortStreamedTransfer(pdu, receivedData, blockDataID);
+                }
                 goto exit;
             }
 
@@ -879,6 +1481,16 @@ CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                 OIC_LOG(ERROR, TAG, "update has failed");
                 goto exit;
             }
+
+            if (CA_BLOCK_UNKNOWN == blockWiseStatus && data->blocksAhead
+                && CAAdvanceBlockWindow(data, blockSize))
+            {
+                // the response to the last block acknowledges the whole transfer
+                OIC_LOG(DEBUG, TAG, "blocks received ahead complete the transfer");
+                data->block1.num = (data->receivedPayloadLen - 1) / blockSize;
+                data->block1.m = 0;
+                block.m = 0;
+            }
         }
 
         // check the blcok-wise transfer status for next step
@@ -901,6 +1513,27 @@ CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
     {
         // received message type is response
         uint32_t code = CA_RESPONSE_CODE(pdu->hdr->coap_hdr_udp_t.code);
+        if (data->windowed)
+        {
+            if (CA_CONTINUE == code)
+            {
+                res = CAReceiveBlock1Ack(pdu, data, &block, blockDataID);
+                if (CA_STATUS_OK != res)
+                {
+                    goto exit;
+                }
+
+                CADestroyBlockID(blockDataID);
+                return res;
+            }
+
+            if (CA_REQUEST_ENTITY_INCOMPLETE == code || CA_REQUEST_ENTITY_TOO_LARGE == code)
+            {
+                OIC_LOG(INFO, TAG, "windowed transfer restarts block by block");
+                data->windowed = false;
+            }
+        }
+
         if (0 == block.m && (CA_REQUEST_ENTITY_INCOMPLETE != code
                 && CA_REQUEST_ENTITY_TOO_LARGE != code))
         {
@@ -937,6 +1570,18 @@ CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             OIC_LOG(ERROR, TAG, "update has failed");
             goto exit;
         }
+
+        if (CA_CONTINUE == code && CAStartBlockWindow(data, block.num))
+        {
+            res = CASendBlockWindow(pdu, data, blockDataID);
+            if (CA_STATUS_OK != res)
+            {
+                goto exit;
+            }
+
+            CADestroyBlockID(blockDataID);
+            return res;
+        }
     }
 
     res = CAProcessNextStep(pdu, receivedData, blockWiseStatus, blockDataID);
@@ -1062,6 +1707,18 @@ CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             // received message type is response
             OIC_LOG(DEBUG, TAG, "received response message with block option2");
 
+            if (data->windowed)
+            {
+                res = CAReceiveBlock2Window(pdu, receivedData, &block, data, blockDataID);
+                if (CA_STATUS_OK != res)
+                {
+                    goto exit;
+                }
+
+                CADestroyBlockID(blockDataID);
+                return res;
+            }
+
             // check the size option
             bool isSizeOption = CAIsPayloadLengthInPduWithBlockSizeOption(pdu,
                                                                           COAP_OPTION_SIZE2,
@@ -1083,6 +1740,10 @@ CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                 if (CA_STATUS_OK != res)
                 {
                     OIC_LOG(ERROR, TAG, "update has failed");
+                    if (data->streamed)
+                    {
+                        CAAbortStreamedTransfer(pdu, receivedData, blockDataID);
+                    }
                     goto exit;
                 }
             }
@@ -1115,6 +1776,21 @@ CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                     OIC_LOG(ERROR, TAG, "update has failed");
                     goto exit;
                 }
+
+                if (CA_OPTION2_RESPONSE == blockWiseStatus
+                    && CA_REQUEST_ENTITY_INCOMPLETE != code && CA_REQUEST_ENTITY_TOO_LARGE != code
+                    && CAStartBlockWindow(data, data->receivedPayloadLen
+                                                / BLOCK_SIZE(data->block2.szx)))
+                {
+                    res = CASendBlockWindow(pdu, data, blockDataID);
+                    if (CA_STATUS_OK != res)
+                    {
+                        goto exit;
+                    }
+
+                    CADestroyBlockID(blockDataID);
+                    return res;
+                }
             }
         }
     }
@@ -1493,6 +2169,13 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
         return CA_STATUS_FAILED;
     }
 
+    // a message of a windowed transfer carries its own block number
+    coap_block_t windowBlock = { 0 };
+    if (CATakeBlockOption(options, COAP_OPTION_BLOCK2, &windowBlock))
+    {
+        block2 = &windowBlock;
+    }
+
     CAResult_t res = CA_STATUS_OK;
     uint32_t code = (*pdu)->hdr->coap_hdr_udp_t.code;
     if (CA_GET != code && CA_POST != code && CA_PUT != code && CA_DELETE != code)
@@ -1597,6 +2280,13 @@ CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
         return CA_STATUS_FAILED;
     }
 
+    // a message of a windowed transfer carries its own block number
+    coap_block_t windowBlock = { 0 };
+    if (CATakeBlockOption(options, COAP_OPTION_BLOCK1, &windowBlock))
+    {
+        block1 = &windowBlock;
+    }
+
     CAResult_t res = CA_STATUS_OK;
     uint32_t code = (*pdu)->hdr->coap_hdr_udp_t.code;
     if (CA_GET == code || CA_POST == code || CA_PUT == code || CA_DELETE == code)
@@ -1666,7 +2356,8 @@ CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
         }
 
         // if it is last block message, remove block data from list.
-        if (0 == block1->m)
+        // a windowed transfer acknowledges its last block before earlier ones may arrive.
+        if (0 == block1->m && CA_CONTINUE != CA_RESPONSE_CODE(code))
         {
             // remove data from list
             res = CARemoveBlockDataFromList(blockID);
@@ -1901,6 +2592,26 @@ uint8_t CACheckBlockErrorType(CABlockData_t *currData, coap_block_t *receivedBlo
     return CA_BLOCK_UNKNOWN;
 }
 
+static bool CAOfferBlockToSink(const CABlockData_t *currData, const CAPayload_t blockPayload,
+                               size_t blockPayloadLen, size_t offset)
+{
+    const CAData_t *sentData = currData->sentData;
+    if (!sentData || !sentData->remoteEndpoint)
+    {
+        return false;
+    }
+
+    const CAInfo_t *info = sentData->requestInfo ? &sentData->requestInfo->info :
+            (sentData->responseInfo ? &sentData->responseInfo->info : NULL);
+    if (!info)
+    {
+        return false;
+    }
+
+    return g_context.dataSink(sentData->remoteEndpoint, info->token, info->tokenLength,
+                              offset, (const uint8_t *) blockPayload, blockPayloadLen);
+}
+
 CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *receivedData,
                                uint8_t status, bool isSizeOption, uint16_t blockType)
 {
@@ -1925,55 +2636,39 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
                 BLOCK_SIZE(currData->block2.szx) : BLOCK_SIZE(currData->block1.szx);
     }
 
-    // memory allocation for the received block payload
     size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        // offer a new transfer to the data sink, unless blocks arrived ahead of this one
+        if (0 == prePayloadLen && !currData->streamed && !currData->blocksAhead
+            && g_context.dataSink)
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
-            {
-                CAPayload_t prePayload = currData->payload;
-
-                OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
-                {
-                    OIC_LOG(ERROR, TAG, "out of memory");
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
-            }
-
-            // update the total payload
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+            currData->streamed = CAOfferBlockToSink(currData, blockPayload, blockPayloadLen, 0);
         }
-        else
+        else if (currData->streamed
+                 && !CAOfferBlockToSink(currData, blockPayload, blockPayloadLen, prePayloadLen))
         {
-            OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
+            OIC_LOG(ERROR, TAG, "data sink refused the block");
+            return CA_STATUS_FAILED;
+        }
 
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
-            if (NULL == newPayload)
+        if (!currData->streamed)
+        {
+            CAResult_t res = CAReservePayload(currData, prePayloadLen + blockPayloadLen,
+                                              isSizeOption);
+            if (CA_STATUS_OK != res)
             {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return CA_MEMORY_ALLOC_FAILED;
+                return res;
             }
 
             // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
-            currData->payload = newPayload;
             memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
         }
 
         // update received payload length
         currData->receivedPayloadLen += blockPayloadLen;
 
-        OIC_LOG_V(DEBUG, TAG, "updated payload: %s, len: %zu", currData->payload,
-                  currData->receivedPayloadLen);
+        OIC_LOG_V(DEBUG, TAG, "updated payload len: %zu", currData->receivedPayloadLen);
     }
 
     OIC_LOG(DEBUG, TAG, "OUT-UpdatePayloadData");
@@ -2213,17 +2908,13 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID,
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
+        return CA_STATUS_OK;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2238,16 +2929,12 @@ uint8_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
+        return currData->type;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2261,15 +2948,11 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        return currData->sentData;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2286,15 +2969,10 @@ CAResult_t CAGetTokenFromBlockDataList(const coap_pdu_t *pdu, const CAEndpoint_t
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = NULL;
+    CABlockData_t *tmp = NULL;
+    HASH_ITER(hh, g_context.dataTable, currData, tmp)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (NULL == currData)
-        {
-            continue;
-        }
-
         if (NULL != currData->sentData && NULL != currData->sentData->requestInfo)
         {
             if (pdu->hdr->coap_hdr_udp_t.id == currData->sentData->requestInfo->info.messageId &&
@@ -2363,58 +3041,32 @@ CAResult_t CACheckBlockDataValidation(const CAData_t *sendData, CABlockData_t **
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockDataID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (!currData)
-        {
-            continue;
-        }
-
         if (sendData->requestInfo) // sendData is requestMessage
         {
             OIC_LOG(DEBUG, TAG, "Send request");
-            if (NULL != currData->blockDataId
-                    && NULL != currData->blockDataId->id
-                    && currData->blockDataId->idLength > 0
-                    && NULL != sendData->requestInfo->info.token)
+            if (NULL != sendData->requestInfo->info.token)
             {
-                if (CABlockidMatches(currData, blockDataID))
-                {
-                    OIC_LOG(ERROR, TAG, "already sent");
-                    continue;
-                }
+                OIC_LOG(ERROR, TAG, "already sent");
             }
         }
-        else if (sendData->responseInfo) // sendData is responseMessage
+        else if (NULL != sendData->responseInfo->info.token) // sendData is responseMessage
         {
             OIC_LOG(DEBUG, TAG, "Send response");
-            if (NULL != currData->blockDataId
-                    && NULL != currData->blockDataId->id
-                    && currData->blockDataId->idLength > 0
-                    && NULL != sendData->responseInfo->info.token)
+
+            // set sendData
+            if (NULL != currData->sentData)
             {
-                if (CABlockidMatches(currData, blockDataID))
-                {
-                    // set sendData
-                    if (NULL != currData->sentData)
-                    {
-                        OIC_LOG(DEBUG, TAG, "init block number");
-                        CADestroyDataSet(currData->sentData);
-                    }
-                    currData->sentData = CACloneCAData(sendData);
-                    *blockData = currData;
-                    ca_mutex_unlock(g_context.blockDataListMutex);
-                    CADestroyBlockID(blockDataID);
-                    return CA_STATUS_OK;
-                }
+                OIC_LOG(DEBUG, TAG, "init block number");
+                CADestroyDataSet(currData->sentData);
             }
-        }
-        else
-        {
-            OIC_LOG(ERROR, TAG, "no CAInfo data");
-            continue;
+            currData->sentData = CACloneCAData(sendData);
+            *blockData = currData;
+            ca_mutex_unlock(g_context.blockDataListMutex);
+            CADestroyBlockID(blockDataID);
+            return CA_STATUS_OK;
         }
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
@@ -2429,20 +3081,10 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
     VERIFY_NON_NULL_RET(blockID, TAG, "blockID", NULL);
 
     ca_mutex_lock(g_context.blockDataListMutex);
-
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     ca_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData;
 }
 
 coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockType)
@@ -2452,23 +3094,20 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockTyp
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
+        if (COAP_OPTION_BLOCK2 == blockType)
         {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else if (COAP_OPTION_BLOCK1 == blockType)
-            {
-                return &currData->block1;
-            }
+            return &currData->block2;
+        }
+        else if (COAP_OPTION_BLOCK1 == blockType)
+        {
+            return &currData->block1;
         }
+        return NULL;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2485,17 +3124,13 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        *fullPayloadLen = currData->receivedPayloadLen;
+        OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
+        return currData->payload;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2562,16 +3197,18 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    bool res = u_arraylist_add(g_context.dataList, (void *) data);
-    if (!res)
+    // other threads may still hold the existing transfer, so it is not replaced
+    if (CAFindBlockData(blockDataID))
     {
-        OIC_LOG(ERROR, TAG, "add has failed");
-        CADestroyBlockID(data->blockDataId);
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(ERROR, TAG, "block data with the same ID already exists");
+        CADestroyBlockID(blockDataID);
         CADestroyDataSet(data->sentData);
         OICFree(data);
-        ca_mutex_unlock(g_context.blockDataListMutex);
         return NULL;
     }
+
+    HASH_ADD_KEYPTR(hh, g_context.dataTable, blockDataID->id, blockDataID->idLength, data);
     ca_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-CreateBlockData");
@@ -2585,28 +3222,13 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
-            if (!removedData)
-            {
-                OIC_LOG(ERROR, TAG, "data is NULL");
-                ca_mutex_unlock(g_context.blockDataListMutex);
-                return CA_STATUS_FAILED;
-            }
+        HASH_DELETE(hh, g_context.dataTable, currData);
 
-            // destroy memory
-            CADestroyDataSet(currData->sentData);
-            CADestroyBlockID(currData->blockDataId);
-            OICFree(currData->payload);
-            OICFree(currData);
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return CA_STATUS_OK;
-        }
+        // destroy memory
+        CADestroyBlockData(currData);
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2619,21 +3241,14 @@ CAResult_t CARemoveAllBlockDataFromList()
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = len; i > 0; i--)
+    CABlockData_t *removedData = NULL;
+    CABlockData_t *tmp = NULL;
+    HASH_ITER(hh, g_context.dataTable, removedData, tmp)
     {
-        CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i - 1);
-        if (removedData)
-        {
-            // destroy memory
-            if (removedData->sentData)
-            {
-                CADestroyDataSet(removedData->sentData);
-            }
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
-        }
+        HASH_DELETE(hh, g_context.dataTable, removedData);
+
+        // destroy memory
+        CADestroyBlockData(removedData);
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
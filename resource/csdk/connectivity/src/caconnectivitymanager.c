@@ -39,6 +39,10 @@
 #include "catcpadapter.h"
 #endif
 
+#ifdef WITH_BWT
+#include "cablockwisetransfer.h"
+#endif
+
 CAGlobals_t caglobals = { .clientFlags = 0,
                           .serverFlags = 0, };
 
@@ -463,6 +467,27 @@ CAResult_t CAHandleRequestResponse()
     return CA_STATUS_OK;
 }
 
+CAResult_t CAWaitForRequestResponse(uint64_t timeout)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CAWaitRequestResponseCallbacks(timeout);
+}
+
+void CAWakeupRequestResponse()
+{
+    if (!g_isInitialized)
+    {
+        return;
+    }
+
+    CAWakeupRequestResponseCallbacks();
+}
+
 #ifdef __WITH_DTLS__
 CAResult_t CASelectCipherSuite(const uint16_t cipher)
 {
@@ -558,3 +583,15 @@ void CARegisterKeepAliveHandler(CAKeepAliveConnectionCallback ConnHandler)
     CATCPSetKeepAliveCallbacks(ConnHandler);
 }
 #endif
+
+#ifdef WITH_BWT
+void CARegisterBlockDataSink(CABlockDataSinkCallback sinkHandler)
+{
+    CASetBlockDataSink(sinkHandler);
+}
+
+CAResult_t CASetBlockWiseWindowSize(uint8_t windowSize)
+{
+    return CASetBlockWindowSize(windowSize);
+}
+#endif
@@ -83,6 +83,9 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
 #ifdef SINGLE_THREAD
 static void CAProcessReceivedData(CAData_t *data);
 #endif
+#ifdef SINGLE_HANDLE
+static void CAHandleReceivedQueueData();
+#endif
 static void CADestroyData(void *data, uint32_t size);
 static void CALogPayloadInfo(CAInfo_t *info);
 static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *endpoint, uint16_t id,
@@ -850,23 +853,35 @@ void CAHandleRequestResponseCallbacks()
     CARetransmissionBaseRoutine((void *)&g_retransmissionContext);
 #else
 #ifdef SINGLE_HANDLE
+    // only handle the data queued so far, callbacks may queue more.
+    uint32_t count = CAQueueingThreadGetSize(&g_receiveThread);
+
+    for (; count > 0; count--)
+    {
+        CAHandleReceivedQueueData();
+    }
+
+#endif // SINGLE_HANDLE
+#endif // SINGLE_THREAD
+}
+
+#if !defined(SINGLE_THREAD) && defined(SINGLE_HANDLE)
+static void CAHandleReceivedQueueData()
+{
     // parse the data and call the callbacks.
     // #1 parse the data
     // #2 get endpoint
 
-    ca_mutex_lock(g_receiveThread.threadMutex);
-
-    u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
+    void *msg = NULL;
+    uint32_t size = 0;
 
-    ca_mutex_unlock(g_receiveThread.threadMutex);
-
-    if (NULL == item || NULL == item->msg)
+    if (!CAQueueingThreadGetData(&g_receiveThread, &msg, &size) || NULL == msg)
     {
         return;
     }
 
     // get endpoint
-    CAData_t *td = (CAData_t *) item->msg;
+    CAData_t *td = (CAData_t *) msg;
 
     if (td->requestInfo && g_requestHandler)
     {
@@ -884,11 +899,27 @@ void CAHandleRequestResponseCallbacks()
         g_errorHandler(td->remoteEndpoint, td->errorInfo);
     }
 
-    CADestroyData(item->msg, sizeof(CAData_t));
-    OICFree(item);
+    CADestroyData(msg, size);
+}
+#endif // !SINGLE_THREAD && SINGLE_HANDLE
 
-#endif // SINGLE_HANDLE
-#endif // SINGLE_THREAD
+CAResult_t CAWaitRequestResponseCallbacks(uint64_t timeout)
+{
+#if !defined(SINGLE_THREAD) && defined(SINGLE_HANDLE)
+    // the queueing thread is not started in single handle mode, so the only waiter on its
+    // condition is the caller of this function.
+    return CAQueueingThreadWaitData(&g_receiveThread, timeout);
+#else
+    (void)timeout;
+    return CA_NOT_SUPPORTED;
+#endif
+}
+
+void CAWakeupRequestResponseCallbacks()
+{
+#if !defined(SINGLE_THREAD) && defined(SINGLE_HANDLE)
+    CAQueueingThreadWakeup(&g_receiveThread);
+#endif
 }
 
 static CAData_t* CAPrepareSendData(const CAEndpoint_t *endpoint, const void *sendData,
@@ -967,7 +998,7 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
 
 #ifdef ARDUINO
     // If max retransmission queue is reached, then don't handle new request
-    if (CA_MAX_RT_ARRAY_SIZE == u_arraylist_length(g_retransmissionContext.dataList))
+    if (CA_MAX_RT_ARRAY_SIZE == g_retransmissionContext.dataCount)
     {
         OIC_LOG(ERROR, TAG, "max RT queue size reached!");
         return CA_SEND_FAILED;
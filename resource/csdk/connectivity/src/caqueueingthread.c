@@ -26,10 +26,301 @@
 
 #include "caqueueingthread.h"
 #include "oic_malloc.h"
+#include "oic_time.h"
 #include "logger.h"
 
 #define TAG PCF("OIC_CA_QING")
 
+/** Number of slots in the ring, must be a power of two. **/
+#ifndef CA_QUEUEING_THREAD_RING_SIZE
+#define CA_QUEUEING_THREAD_RING_SIZE 256
+#endif
+
+/** Maximum number of data taken out of the queue per lock of the thread mutex. **/
+#define CA_QUEUEING_THREAD_BATCH_SIZE 32
+
+/** Keeps the producer and consumer positions on separate cache lines. **/
+#define CA_QUEUEING_CACHE_LINE 64
+
+typedef struct
+{
+    /** Sequence number telling whether the slot is free or published. **/
+    size_t sequence;
+    void *msg;
+    uint32_t size;
+    /** Time the data was queued, in microseconds. **/
+    uint64_t timestamp;
+} CAQueueingSlot_t;
+
+/**
+ * Bounded multi producer, single consumer ring (sequence numbered slots as in Vyukov's bounded
+ * queue). Producers claim a slot with a compare and swap on enqueuePos and publish it by storing
+ * its sequence. Data which does not fit goes to the overflow list under the thread mutex, and
+ * producers keep using the overflow list until the consumer drained it to preserve their order.
+ * The consumer takes data under the thread mutex, once per batch, so that
+ * ::CAQueueingThreadRemoveData can filter the queue from another thread.
+ */
+struct CAQueueingRing
+{
+    size_t enqueuePos;
+    char pad1[CA_QUEUEING_CACHE_LINE - sizeof(size_t)];
+    size_t dequeuePos;
+    /** Set while the consumer sleeps, producers only signal the condition when it is set. **/
+    uint32_t waiting;
+    /** Set by ::CAQueueingThreadWakeup, cleared by the waiter. **/
+    bool wakeupPending;
+    char pad2[CA_QUEUEING_CACHE_LINE - sizeof(size_t) - sizeof(uint32_t) - sizeof(bool)];
+    /** Number of data in the overflow list, read by producers without the mutex. **/
+    uint32_t overflowCount;
+    /** Data which did not fit into the ring, newer than the ring content. **/
+    u_queue_t *overflow;
+    /** Data kept by ::CAQueueingThreadRemoveData, older than the ring content. **/
+    u_queue_t *requeued;
+    CAQueueingThreadStats_t stats;
+    CAQueueingSlot_t slots[CA_QUEUEING_THREAD_RING_SIZE];
+};
+
+/** A data taken out of the queue. **/
+typedef struct
+{
+    void *msg;
+    uint32_t size;
+    uint64_t timestamp;
+} CAQueueingItem_t;
+
+static void CAQueueingThreadDestroyItem(CAQueueingThread_t *thread, void *msg, uint32_t size)
+{
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(msg, size);
+    }
+    else
+    {
+        OICFree(msg);
+    }
+}
+
+static CAQueueingRing_t *CAQueueingRingCreate()
+{
+    CAQueueingRing_t *ring = (CAQueueingRing_t *) OICCalloc(1, sizeof(CAQueueingRing_t));
+    if (NULL == ring)
+    {
+        return NULL;
+    }
+
+    ring->overflow = u_queue_create();
+    ring->requeued = u_queue_create();
+    if (NULL == ring->overflow || NULL == ring->requeued)
+    {
+        u_queue_delete(ring->overflow);
+        u_queue_delete(ring->requeued);
+        OICFree(ring);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < CA_QUEUEING_THREAD_RING_SIZE; i++)
+    {
+        ring->slots[i].sequence = i;
+    }
+    return ring;
+}
+
+static void CAQueueingRingUpdateDepth(CAQueueingRing_t *ring)
+{
+    uint64_t enqueued = __atomic_add_fetch(&ring->stats.enqueued, 1, __ATOMIC_RELAXED);
+    uint64_t dequeued = __atomic_load_n(&ring->stats.dequeued, __ATOMIC_RELAXED);
+    uint32_t depth = (enqueued > dequeued) ? (uint32_t)(enqueued - dequeued) : 0;
+    uint32_t maxDepth = __atomic_load_n(&ring->stats.maxDepth, __ATOMIC_RELAXED);
+    while (depth > maxDepth &&
+           !__atomic_compare_exchange_n(&ring->stats.maxDepth, &maxDepth, depth, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/**
+ * Publish data into the ring.
+ * @return  false if the ring is full.
+ */
+static bool CAQueueingRingPush(CAQueueingRing_t *ring, void *msg, uint32_t size,
+                               uint64_t timestamp)
+{
+    size_t pos = __atomic_load_n(&ring->enqueuePos, __ATOMIC_RELAXED);
+    CAQueueingSlot_t *slot = NULL;
+    for (;;)
+    {
+        slot = &ring->slots[pos & (CA_QUEUEING_THREAD_RING_SIZE - 1)];
+        size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+        if (0 == diff)
+        {
+            // sequentially consistent, pairs with the consumer announcing its sleep.
+            if (__atomic_compare_exchange_n(&ring->enqueuePos, &pos, pos + 1, true,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->msg = msg;
+    slot->size = size;
+    slot->timestamp = timestamp;
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Take the oldest published data out of the ring. Only called by the consumer holding the
+ * thread mutex.
+ */
+static bool CAQueueingRingPop(CAQueueingRing_t *ring, CAQueueingItem_t *item)
+{
+    size_t pos = ring->dequeuePos;
+    CAQueueingSlot_t *slot = &ring->slots[pos & (CA_QUEUEING_THREAD_RING_SIZE - 1)];
+    size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if (sequence != pos + 1)
+    {
+        return false;
+    }
+
+    item->msg = slot->msg;
+    item->size = slot->size;
+    item->timestamp = slot->timestamp;
+    ring->dequeuePos = pos + 1;
+    __atomic_store_n(&slot->sequence, pos + CA_QUEUEING_THREAD_RING_SIZE, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool CAQueueingListPop(u_queue_t *list, CAQueueingItem_t *item)
+{
+    u_queue_message_t *message = u_queue_get_element(list);
+    if (NULL == message)
+    {
+        return false;
+    }
+
+    CAQueueingItem_t *queued = (CAQueueingItem_t *) message->msg;
+    *item = *queued;
+    OICFree(queued);
+    OICFree(message);
+    return true;
+}
+
+static CAResult_t CAQueueingListAdd(u_queue_t *list, const CAQueueingItem_t *item)
+{
+    u_queue_message_t *message = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
+    CAQueueingItem_t *queued = (CAQueueingItem_t *) OICMalloc(sizeof(CAQueueingItem_t));
+    if (NULL == message || NULL == queued)
+    {
+        OICFree(message);
+        OICFree(queued);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    *queued = *item;
+    message->msg = queued;
+    message->size = sizeof(CAQueueingItem_t);
+    u_queue_add_element(list, message);
+    return CA_STATUS_OK;
+}
+
+/**
+ * Take the oldest data out of the queue. Called with the thread mutex held.
+ */
+static bool CAQueueingThreadPop(CAQueueingRing_t *ring, CAQueueingItem_t *item)
+{
+    if (CAQueueingListPop(ring->requeued, item) || CAQueueingRingPop(ring, item))
+    {
+        return true;
+    }
+
+    // the overflow list is newer than everything claimed in the ring, including slots whose
+    // producer has not published them yet.
+    if (__atomic_load_n(&ring->overflowCount, __ATOMIC_ACQUIRE) > 0
+        && __atomic_load_n(&ring->enqueuePos, __ATOMIC_ACQUIRE) == ring->dequeuePos
+        && CAQueueingListPop(ring->overflow, item))
+    {
+        __atomic_sub_fetch(&ring->overflowCount, 1, __ATOMIC_RELEASE);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Take up to @p max data out of the queue, oldest first. Called with the thread mutex held.
+ */
+static uint32_t CAQueueingThreadTakeBatch(CAQueueingThread_t *thread, CAQueueingItem_t *items,
+                                          uint32_t max)
+{
+    CAQueueingRing_t *ring = thread->dataQueue;
+    uint32_t count = 0;
+
+    while (count < max && CAQueueingThreadPop(ring, &items[count]))
+    {
+        count++;
+    }
+
+    if (count > 0)
+    {
+        uint64_t now = OICGetCurrentTime(TIME_IN_US);
+        uint64_t total = 0;
+        uint64_t maxLatency = __atomic_load_n(&ring->stats.maxLatencyUs, __ATOMIC_RELAXED);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint64_t latency = (now > items[i].timestamp) ? now - items[i].timestamp : 0;
+            total += latency;
+            if (latency > maxLatency)
+            {
+                maxLatency = latency;
+            }
+        }
+        __atomic_add_fetch(&ring->stats.totalLatencyUs, total, __ATOMIC_RELAXED);
+        __atomic_store_n(&ring->stats.maxLatencyUs, maxLatency, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&ring->stats.dequeued, count, __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+/**
+ * Whether the queue holds data, possibly not yet visible to ::CAQueueingThreadTakeBatch when a
+ * producer is between claiming and publishing its slot. Called with the thread mutex held.
+ */
+static bool CAQueueingThreadHasData(CAQueueingThread_t *thread)
+{
+    CAQueueingRing_t *ring = thread->dataQueue;
+    return u_queue_get_size(ring->requeued) > 0
+        || __atomic_load_n(&ring->overflowCount, __ATOMIC_ACQUIRE) > 0
+        || __atomic_load_n(&ring->enqueuePos, __ATOMIC_SEQ_CST) != ring->dequeuePos;
+}
+
+/**
+ * Block on the thread condition until data is queued or the thread is signalled. Called with
+ * the thread mutex held.
+ */
+static void CAQueueingThreadSleep(CAQueueingThread_t *thread, uint64_t timeout)
+{
+    CAQueueingRing_t *ring = thread->dataQueue;
+
+    // announce the sleep before the last check, a producer publishing after the check sees
+    // the flag and signals under the mutex, which is only released by the wait.
+    __atomic_store_n(&ring->waiting, 1, __ATOMIC_SEQ_CST);
+    if (!CAQueueingThreadHasData(thread))
+    {
+        __atomic_add_fetch(&ring->stats.waits, 1, __ATOMIC_RELAXED);
+        ca_cond_wait_for(thread->threadCond, thread->threadMutex, timeout);
+    }
+    __atomic_store_n(&ring->waiting, 0, __ATOMIC_RELAXED);
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     OIC_LOG(DEBUG, TAG, "message handler main thread start..");
@@ -43,53 +334,55 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
         return;
     }
 
+    CAQueueingItem_t items[CA_QUEUEING_THREAD_BATCH_SIZE];
+
     while (!thread->isStop)
     {
         // mutex lock
         ca_mutex_lock(thread->threadMutex);
 
+        uint32_t count = CAQueueingThreadTakeBatch(thread, items, CA_QUEUEING_THREAD_BATCH_SIZE);
+
         // if queue is empty, thread will wait
-        if (!thread->isStop && u_queue_get_size(thread->dataQueue) <= 0)
+        if (0 == count && !thread->isStop)
         {
             OIC_LOG(DEBUG, TAG, "wait..");
 
-            // wait
-            ca_cond_wait(thread->threadCond, thread->threadMutex);
+            CAQueueingThreadSleep(thread, 0);
+            thread->dataQueue->wakeupPending = false;
 
             OIC_LOG(DEBUG, TAG, "wake up..");
-        }
 
-        // check stop flag
-        if (thread->isStop)
-        {
-            // mutex unlock
-            ca_mutex_unlock(thread->threadMutex);
-            continue;
+            if (!thread->isStop)
+            {
+                count = CAQueueingThreadTakeBatch(thread, items, CA_QUEUEING_THREAD_BATCH_SIZE);
+            }
         }
 
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
         // mutex unlock
         ca_mutex_unlock(thread->threadMutex);
-        if (NULL == message)
+
+        // process data, data taken after a stop request is only released.
+        bool processed = false;
+        for (uint32_t i = 0; i < count; i++)
         {
-            continue;
+            if (!thread->isStop)
+            {
+                thread->threadTask(items[i].msg);
+                processed = true;
+            }
         }
 
-        // process data
-        thread->threadTask(message->msg);
-
-        // free
-        if (NULL != thread->destroy)
+        // the batch end task may still use the data of the batch.
+        if (processed && NULL != thread->batchEnd)
         {
-            thread->destroy(message->msg, message->size);
+            thread->batchEnd();
         }
-        else
+
+        for (uint32_t i = 0; i < count; i++)
         {
-            OICFree(message->msg);
+            CAQueueingThreadDestroyItem(thread, items[i].msg, items[i].size);
         }
-
-        OICFree(message);
     }
 
     ca_mutex_lock(thread->threadMutex);
@@ -118,12 +411,13 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
 
     // set send thread data
     thread->threadPool = handle;
-    thread->dataQueue = u_queue_create();
+    thread->dataQueue = CAQueueingRingCreate();
     thread->threadMutex = ca_mutex_new();
     thread->threadCond = ca_cond_new();
     thread->isStop = true;
     thread->threadTask = task;
     thread->destroy = destroy;
+    thread->batchEnd = NULL;
     if(NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
         goto ERROR_MEM_FAILURE;
 
@@ -131,7 +425,9 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     ERROR_MEM_FAILURE:
     if(thread->dataQueue)
     {
-        u_queue_delete(thread->dataQueue);
+        u_queue_delete(thread->dataQueue->overflow);
+        u_queue_delete(thread->dataQueue->requeued);
+        OICFree(thread->dataQueue);
         thread->dataQueue = NULL;
     }
     if(thread->threadMutex)
@@ -148,6 +444,18 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
 
 }
 
+CAResult_t CAQueueingThreadSetBatchEndTask(CAQueueingThread_t *thread, CAThreadBatchEndTask task)
+{
+    if (NULL == thread)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    thread->batchEnd = task;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -199,30 +507,206 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
         return CA_STATUS_INVALID_PARAM;
     }
 
-    // create thread data
-    u_queue_message_t *message = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
+    if (NULL == thread->dataQueue)
+    {
+        OIC_LOG(ERROR, TAG, "thread is not initialized..");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
 
-    if (NULL == message)
+    CAQueueingRing_t *ring = thread->dataQueue;
+    uint64_t timestamp = OICGetCurrentTime(TIME_IN_US);
+
+    // data goes to the overflow list while it holds data, so that it stays behind the data
+    // the same producer queued before.
+    if (0 == __atomic_load_n(&ring->overflowCount, __ATOMIC_ACQUIRE)
+        && CAQueueingRingPush(ring, data, size, timestamp))
     {
-        OIC_LOG(ERROR, TAG, "memory error!!");
-        return CA_MEMORY_ALLOC_FAILED;
+        CAQueueingRingUpdateDepth(ring);
+
+        // notify the thread only if it sleeps.
+        if (__atomic_load_n(&ring->waiting, __ATOMIC_SEQ_CST))
+        {
+            ca_mutex_lock(thread->threadMutex);
+            ca_cond_signal(thread->threadCond);
+            ca_mutex_unlock(thread->threadMutex);
+        }
+        return CA_STATUS_OK;
     }
 
-    message->msg = data;
-    message->size = size;
+    CAQueueingItem_t item = { .msg = data, .size = size, .timestamp = timestamp };
 
     // mutex lock
     ca_mutex_lock(thread->threadMutex);
 
-    // add thread data into list
-    u_queue_add_element(thread->dataQueue, message);
+    // add thread data into overflow list
+    CAResult_t res = CAQueueingListAdd(ring->overflow, &item);
+    if (CA_STATUS_OK == res)
+    {
+        __atomic_add_fetch(&ring->overflowCount, 1, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&ring->stats.overflowed, 1, __ATOMIC_RELAXED);
+        CAQueueingRingUpdateDepth(ring);
 
-    // notity the thread
-    ca_cond_signal(thread->threadCond);
+        // notity the thread
+        ca_cond_signal(thread->threadCond);
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "memory error!!");
+    }
 
     // mutex unlock
     ca_mutex_unlock(thread->threadMutex);
 
+    return res;
+}
+
+uint32_t CAQueueingThreadGetSize(CAQueueingThread_t *thread)
+{
+    if (NULL == thread || NULL == thread->dataQueue)
+    {
+        return 0;
+    }
+
+    CAQueueingRing_t *ring = thread->dataQueue;
+    uint64_t dequeued = __atomic_load_n(&ring->stats.dequeued, __ATOMIC_RELAXED);
+    uint64_t enqueued = __atomic_load_n(&ring->stats.enqueued, __ATOMIC_RELAXED);
+    return (enqueued > dequeued) ? (uint32_t)(enqueued - dequeued) : 0;
+}
+
+bool CAQueueingThreadGetData(CAQueueingThread_t *thread, void **data, uint32_t *size)
+{
+    if (NULL == thread || NULL == thread->dataQueue || NULL == data || NULL == size)
+    {
+        return false;
+    }
+
+    CAQueueingItem_t item;
+
+    ca_mutex_lock(thread->threadMutex);
+    uint32_t count = CAQueueingThreadTakeBatch(thread, &item, 1);
+    ca_mutex_unlock(thread->threadMutex);
+
+    if (0 == count)
+    {
+        return false;
+    }
+
+    *data = item.msg;
+    *size = item.size;
+    return true;
+}
+
+CAResult_t CAQueueingThreadWaitData(CAQueueingThread_t *thread, uint64_t timeout)
+{
+    if (NULL == thread)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == thread->threadMutex || NULL == thread->dataQueue)
+    {
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    ca_mutex_lock(thread->threadMutex);
+    if (!thread->dataQueue->wakeupPending)
+    {
+        CAQueueingThreadSleep(thread, timeout);
+    }
+    thread->dataQueue->wakeupPending = false;
+    ca_mutex_unlock(thread->threadMutex);
+
+    return CA_STATUS_OK;
+}
+
+void CAQueueingThreadWakeup(CAQueueingThread_t *thread)
+{
+    if (NULL == thread || NULL == thread->threadMutex || NULL == thread->dataQueue)
+    {
+        return;
+    }
+
+    ca_mutex_lock(thread->threadMutex);
+    thread->dataQueue->wakeupPending = true;
+    ca_cond_signal(thread->threadCond);
+    ca_mutex_unlock(thread->threadMutex);
+}
+
+CAResult_t CAQueueingThreadRemoveData(CAQueueingThread_t *thread, CADataMatchFunction match,
+                                      void *context)
+{
+    if (NULL == thread || NULL == match)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == thread->threadMutex || NULL == thread->dataQueue)
+    {
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    CAQueueingRing_t *ring = thread->dataQueue;
+    u_queue_t *kept = u_queue_create();
+    if (NULL == kept)
+    {
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    CAResult_t res = CA_STATUS_OK;
+    uint32_t removed = 0;
+    CAQueueingItem_t item;
+
+    // take everything queued so far, the data kept goes back in front of the ring.
+    ca_mutex_lock(thread->threadMutex);
+    while (CAQueueingThreadPop(ring, &item))
+    {
+        if (match(item.msg, item.size, context))
+        {
+            CAQueueingThreadDestroyItem(thread, item.msg, item.size);
+            removed++;
+        }
+        else if (CA_STATUS_OK != CAQueueingListAdd(kept, &item))
+        {
+            // keep the queue usable, the data is lost.
+            CAQueueingThreadDestroyItem(thread, item.msg, item.size);
+            removed++;
+            res = CA_MEMORY_ALLOC_FAILED;
+        }
+    }
+    u_queue_delete(ring->requeued);
+    ring->requeued = kept;
+    __atomic_add_fetch(&ring->stats.dequeued, removed, __ATOMIC_RELAXED);
+    ca_mutex_unlock(thread->threadMutex);
+
+    return res;
+}
+
+CAResult_t CAQueueingThreadGetStats(CAQueueingThread_t *thread, CAQueueingThreadStats_t *stats)
+{
+    if (NULL == thread || NULL == stats)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == thread->dataQueue)
+    {
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    CAQueueingThreadStats_t *current = &thread->dataQueue->stats;
+    stats->dequeued = __atomic_load_n(&current->dequeued, __ATOMIC_RELAXED);
+    stats->enqueued = __atomic_load_n(&current->enqueued, __ATOMIC_RELAXED);
+    stats->overflowed = __atomic_load_n(&current->overflowed, __ATOMIC_RELAXED);
+    stats->waits = __atomic_load_n(&current->waits, __ATOMIC_RELAXED);
+    stats->depth = (stats->enqueued > stats->dequeued) ?
+                   (uint32_t)(stats->enqueued - stats->dequeued) : 0;
+    stats->maxDepth = __atomic_load_n(&current->maxDepth, __ATOMIC_RELAXED);
+    stats->totalLatencyUs = __atomic_load_n(&current->totalLatencyUs, __ATOMIC_RELAXED);
+    stats->maxLatencyUs = __atomic_load_n(&current->maxLatencyUs, __ATOMIC_RELAXED);
+
     return CA_STATUS_OK;
 }
 
@@ -241,28 +725,19 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
     ca_cond_free(thread->threadCond);
 
     // remove all remained list data.
-    while (u_queue_get_size(thread->dataQueue) > 0)
+    if (NULL != thread->dataQueue)
     {
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
-
-        // free
-        if(NULL != message)
+        CAQueueingItem_t item;
+        while (CAQueueingThreadTakeBatch(thread, &item, 1) > 0)
         {
-            if (NULL != thread->destroy)
-            {
-                thread->destroy(message->msg, message->size);
-            }
-            else
-            {
-                OICFree(message->msg);
-            }
-
-            OICFree(message);
+            CAQueueingThreadDestroyItem(thread, item.msg, item.size);
         }
-    }
 
-    u_queue_delete(thread->dataQueue);
+        u_queue_delete(thread->dataQueue->overflow);
+        u_queue_delete(thread->dataQueue->requeued);
+        OICFree(thread->dataQueue);
+        thread->dataQueue = NULL;
+    }
 
     return CA_STATUS_OK;
 }
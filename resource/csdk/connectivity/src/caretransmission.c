@@ -44,6 +44,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 
 #ifndef SINGLE_THREAD
 #include <unistd.h>
@@ -60,20 +61,33 @@
 #include "caprotocolmessage.h"
 #include "oic_malloc.h"
 #include "logger.h"
+#include "uthash.h"
 
 #define TAG "OIC_CA_RETRANS"
 
+/** initial size of the retransmission heap. **/
+#define RETRANSMISSION_HEAP_INITIAL_SIZE    16
+
 typedef struct
+{
+    uint16_t messageId;                 /**< coap PDU message id */
+    CATransportAdapter_t adapter;       /**< transport adapter of the remote endpoint */
+} CARetransmissionKey_t;
+
+typedef struct CARetransmissionData
 {
     uint64_t timeStamp;                 /**< last sent time. microseconds */
 #ifndef SINGLE_THREAD
     uint64_t timeout;                   /**< timeout value. microseconds */
 #endif
+    uint64_t nextTime;                  /**< next retransmission time. microseconds */
+    uint32_t heapIndex;                 /**< position in the retransmission heap */
     uint8_t triedCount;                 /**< retransmission count */
-    uint16_t messageId;                 /**< coap PDU message id */
+    CARetransmissionKey_t key;          /**< coap PDU message id and adapter */
     CAEndpoint_t *endpoint;             /**< remote endpoint */
     void *pdu;                          /**< coap PDU */
     uint32_t size;                      /**< coap PDU size */
+    UT_hash_handle hh;                  /**< handle of the message id index */
 } CARetransmissionData_t;
 
 static const uint64_t USECS_PER_SEC = 1000000;
@@ -126,36 +140,131 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 #endif
 
 /**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
+ * @brief   calculate the next retransmission time
  * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
+ * @return  microseconds. the timeout doubles with every retransmission.
  */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
+static uint64_t CAGetNextRetransmissionTime(const CARetransmissionData_t *retData)
 {
 #ifndef SINGLE_THREAD
-    // #1. calculate timeout
     uint32_t milliTimeoutValue = retData->timeout * 0.001;
     uint64_t timeout = (milliTimeoutValue << retData->triedCount) * (uint64_t) 1000;
+#else
+    uint64_t timeout = (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
+#endif
+    return retData->timeStamp + timeout;
+}
+
+static void CASwapRetransmissionData(CARetransmission_t *context, uint32_t i, uint32_t j)
+{
+    CARetransmissionData_t *tmp = context->dataHeap[i];
+    context->dataHeap[i] = context->dataHeap[j];
+    context->dataHeap[j] = tmp;
+    context->dataHeap[i]->heapIndex = i;
+    context->dataHeap[j]->heapIndex = j;
+}
 
-    if (currentTime >= retData->timeStamp + timeout)
+static void CASiftUpRetransmissionData(CARetransmission_t *context, uint32_t index)
+{
+    while (index > 0)
     {
-        OIC_LOG_V(DEBUG, TAG, "%llu microseconds time out!!, tried count(%d)",
-                  timeout, retData->triedCount);
-        return true;
+        uint32_t parent = (index - 1) / 2;
+        if (context->dataHeap[parent]->nextTime <= context->dataHeap[index]->nextTime)
+        {
+            break;
+        }
+        CASwapRetransmissionData(context, parent, index);
+        index = parent;
     }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * 1000000;
+}
 
-    if (currentTime >= retData->timeStamp + timeOut)
+static void CASiftDownRetransmissionData(CARetransmission_t *context, uint32_t index)
+{
+    while (true)
     {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
+        uint32_t smallest = index;
+        uint32_t left = 2 * index + 1;
+        uint32_t right = left + 1;
+
+        if (left < context->dataCount
+            && context->dataHeap[left]->nextTime < context->dataHeap[smallest]->nextTime)
+        {
+            smallest = left;
+        }
+        if (right < context->dataCount
+            && context->dataHeap[right]->nextTime < context->dataHeap[smallest]->nextTime)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        CASwapRetransmissionData(context, index, smallest);
+        index = smallest;
     }
-#endif
-    return false;
+}
+
+/**
+ * @brief   add retransmission data to the heap and the message id index.
+ *          threadMutex must be held by the caller.
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ * @return  ::CA_STATUS_OK or ::CA_MEMORY_ALLOC_FAILED
+ */
+static CAResult_t CAAddRetransmissionData(CARetransmission_t *context,
+                                          CARetransmissionData_t *retData)
+{
+    if (context->dataCount == context->dataCapacity)
+    {
+        uint32_t capacity = context->dataCapacity ?
+                context->dataCapacity * 2 : RETRANSMISSION_HEAP_INITIAL_SIZE;
+        CARetransmissionData_t **heap = (CARetransmissionData_t **) OICRealloc(
+                context->dataHeap, capacity * sizeof (*heap));
+        if (NULL == heap)
+        {
+            OIC_LOG(ERROR, TAG, "memory error");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        context->dataHeap = heap;
+        context->dataCapacity = capacity;
+    }
+
+    retData->heapIndex = context->dataCount++;
+    context->dataHeap[retData->heapIndex] = retData;
+    CASiftUpRetransmissionData(context, retData->heapIndex);
+
+    HASH_ADD(hh, context->dataTable, key, sizeof (retData->key), retData);
+    return CA_STATUS_OK;
+}
+
+/**
+ * @brief   remove retransmission data from the heap and the message id index.
+ *          threadMutex must be held by the caller.
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ */
+static void CARemoveRetransmissionData(CARetransmission_t *context,
+                                       CARetransmissionData_t *retData)
+{
+    HASH_DELETE(hh, context->dataTable, retData);
+
+    uint32_t index = retData->heapIndex;
+    uint32_t last = --context->dataCount;
+    if (index != last)
+    {
+        CASwapRetransmissionData(context, index, last);
+        CASiftDownRetransmissionData(context, index);
+        CASiftUpRetransmissionData(context, index);
+    }
+    context->dataHeap[last] = NULL;
+}
+
+static void CAFreeRetransmissionData(CARetransmissionData_t *retData)
+{
+    CAFreeEndpoint(retData->endpoint);
+    OICFree(retData->pdu);
+    OICFree(retData);
 }
 
 static void CACheckRetransmissionList(CARetransmission_t *context)
@@ -169,64 +278,47 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
     // mutex lock
     ca_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
+    uint64_t currentTime = getCurrentTimeInMicroSeconds();
 
-    for (i = 0; i < len; i++)
+    // only the data whose time is up is visited, earliest first.
+    while (context->dataCount > 0 && context->dataHeap[0]->nextTime <= currentTime)
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
-
-        if (NULL == retData)
-        {
-            continue;
-        }
+        CARetransmissionData_t *retData = context->dataHeap[0];
 
-        uint64_t currentTime = getCurrentTimeInMicroSeconds();
+        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
+                  retData->nextTime - retData->timeStamp, retData->triedCount);
 
-        if (CACheckTimeout(currentTime, retData))
+        // #2. if time's up, send the data.
+        if (NULL != context->dataSendMethod)
         {
-            // #2. if time's up, send the data.
-            if (NULL != context->dataSendMethod)
-            {
-                OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
-                          retData->messageId);
-                context->dataSendMethod(retData->endpoint, retData->pdu, retData->size);
-            }
-
-            // #3. increase the retransmission count and update timestamp.
-            retData->timeStamp = currentTime;
-            retData->triedCount++;
+            OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
+                      retData->key.messageId);
+            context->dataSendMethod(retData->endpoint, retData->pdu, retData->size);
         }
 
+        // #3. increase the retransmission count and update timestamp.
+        retData->timeStamp = currentTime;
+        retData->triedCount++;
+
         // #4. if tried count is max, remove the retransmission data from list.
         if (retData->triedCount >= context->config.tryingCount)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                ca_mutex_unlock(context->threadMutex);
-                return;
-            }
+            CARemoveRetransmissionData(context, retData);
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
+                      "msgid=%d", retData->key.messageId);
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                context->timeoutCallback(retData->endpoint, retData->pdu, retData->size);
             }
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-
-            OICFree(removedData);
-
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
+            CAFreeRetransmissionData(retData);
+        }
+        else
+        {
+            retData->nextTime = CAGetNextRetransmissionTime(retData);
+            CASiftDownRetransmissionData(context, 0);
         }
     }
 
@@ -261,7 +353,7 @@ void CARetransmissionBaseRoutine(void *threadValue)
         // mutex lock
         ca_mutex_lock(context->threadMutex);
 
-        if (!context->isStop && u_arraylist_length(context->dataList) <= 0)
+        if (!context->isStop && 0 == context->dataCount)
         {
             // if list is empty, thread will wait
             OIC_LOG(DEBUG, TAG, "wait..there is no retransmission data.");
@@ -273,13 +365,17 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
-            OIC_LOG_V(DEBUG, TAG, "wait..(%lld)microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
+            // sleep until the earliest retransmission is due.
+            uint64_t currentTime = getCurrentTimeInMicroSeconds();
+            uint64_t nextTime = context->dataHeap[0]->nextTime;
+            if (nextTime > currentTime)
+            {
+                OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds", nextTime - currentTime);
 
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            ca_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+                // wait
+                ca_cond_wait_for(context->threadCond, context->threadMutex,
+                                 nextTime - currentTime);
+            }
         }
         else
         {
@@ -345,7 +441,6 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->timeoutCallback = timeoutCallback;
     context->config = cfg;
     context->isStop = false;
-    context->dataList = u_arraylist_create();
 
     return CA_STATUS_OK;
 }
@@ -415,54 +510,47 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     retData->timeout = CAGetTimeoutValue();
 #endif
     retData->triedCount = 0;
-    retData->messageId = messageId;
+    retData->nextTime = CAGetNextRetransmissionTime(retData);
+    retData->key.messageId = messageId;
+    retData->key.adapter = endpoint->adapter;
     retData->endpoint = remoteEndpoint;
     retData->pdu = pduData;
     retData->size = size;
-#ifndef SINGLE_THREAD
+
     // mutex lock
     ca_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
-
     // #3. add data into list
-    for (i = 0; i < len; i++)
+    CARetransmissionData_t *currData = NULL;
+    HASH_FIND(hh, context->dataTable, &retData->key, sizeof (retData->key), currData);
+    if (NULL != currData)
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
-
-        if (NULL == currData)
-        {
-            continue;
-        }
-
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
 
-            // mutex unlock
-            ca_mutex_unlock(context->threadMutex);
+        // mutex unlock
+        ca_mutex_unlock(context->threadMutex);
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
+        CAFreeRetransmissionData(retData);
+        return CA_STATUS_FAILED;
     }
 
-    u_arraylist_add(context->dataList, (void *) retData);
+    CAResult_t res = CAAddRetransmissionData(context, retData);
+    if (CA_STATUS_OK != res)
+    {
+        ca_mutex_unlock(context->threadMutex);
+        CAFreeRetransmissionData(retData);
+        return res;
+    }
 
+#ifndef SINGLE_THREAD
     // notify the thread
     ca_cond_signal(context->threadCond);
+#endif
 
     // mutex unlock
     ca_mutex_unlock(context->threadMutex);
 
-#else
-    u_arraylist_add(context->dataList, (void *) retData);
-
+#ifdef SINGLE_THREAD
     CACheckRetransmissionList(context);
 #endif
     return CA_STATUS_OK;
@@ -501,77 +589,45 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
         return CA_STATUS_OK;
     }
 
+    CARetransmissionKey_t key;
+    memset(&key, 0, sizeof (key));
+    key.messageId = messageId;
+    key.adapter = endpoint->adapter;
+
     // mutex lock
     ca_mutex_lock(context->threadMutex);
-    uint32_t len = u_arraylist_length(context->dataList);
 
-    // find index
-    uint32_t i;
-    for (i = 0; i < len; i++)
+    // find data
+    CARetransmissionData_t *retData = NULL;
+    HASH_FIND(hh, context->dataTable, &key, sizeof (key), retData);
+    if (NULL != retData)
     {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
-
-        if (NULL == retData)
+        // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+        // if retransmission was finish..token will be unavailable.
+        if (CA_EMPTY == code)
         {
-            continue;
-        }
-
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
-        {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
-            {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    ca_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    ca_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
-            }
+            OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
+            // copy PDU data
+            (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+            if ((*retransmissionPdu) == NULL)
             {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+                OIC_LOG(ERROR, TAG, "memory error");
 
                 // mutex unlock
                 ca_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            memcpy((*retransmissionPdu), retData->pdu, retData->size);
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+        // #2. remove data from list
+        CARemoveRetransmissionData(context, retData);
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+        OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
 
-            break;
-        }
+        CAFreeRetransmissionData(retData);
     }
 
     // mutex unlock
@@ -618,10 +674,21 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
 
     OIC_LOG(DEBUG, TAG, "retransmission context destroy..");
 
+    CARetransmissionData_t *retData = NULL;
+    CARetransmissionData_t *tmp = NULL;
+    HASH_ITER(hh, context->dataTable, retData, tmp)
+    {
+        HASH_DELETE(hh, context->dataTable, retData);
+        CAFreeRetransmissionData(retData);
+    }
+    OICFree(context->dataHeap);
+    context->dataHeap = NULL;
+    context->dataCount = 0;
+    context->dataCapacity = 0;
+
     ca_mutex_free(context->threadMutex);
     context->threadMutex = NULL;
     ca_cond_free(context->threadCond);
-    u_arraylist_free(&context->dataList);
 
     return CA_STATUS_OK;
 }
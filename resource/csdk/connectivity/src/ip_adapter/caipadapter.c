@@ -125,6 +125,9 @@ CAResult_t CAIPInitializeQueueHandles()
         return CA_STATUS_FAILED;
     }
 
+    // datagrams of a queue batch are sent together once the batch is processed.
+    CAQueueingThreadSetBatchEndTask(g_sendQueueHandle, CAIPFlushSendData);
+
     return CA_STATUS_OK;
 }
 
@@ -445,7 +448,7 @@ void CAIPSendDataThread(void *threadData)
     {
         //Processing for sending multicast
         OIC_LOG(DEBUG, TAG, "Send Multicast Data is called");
-        CAIPSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, true);
+        CAIPQueueSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, true);
     }
     else
     {
@@ -466,10 +469,10 @@ void CAIPSendDataThread(void *threadData)
         else
         {
             OIC_LOG(DEBUG, TAG, "Send Unicast Data is called");
-            CAIPSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, false);
+            CAIPQueueSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, false);
         }
 #else
-        CAIPSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, false);
+        CAIPQueueSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, false);
 #endif
     }
 }
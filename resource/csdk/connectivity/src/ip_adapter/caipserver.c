@@ -44,6 +44,15 @@
 #include "pdu.h"
 #include "caipinterface.h"
 #include "caadapterutils.h"
+#ifdef CA_USE_EPOLL
+#include <sys/epoll.h>
+#endif
+#ifdef CA_USE_SENDMMSG
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103         // from linux/udp.h, the kernel support is probed at runtime
+#endif
+#endif
 #ifdef __WITH_DTLS__
 #include "caadapternetdtls.h"
 #endif
@@ -100,10 +109,82 @@ static CAIPPacketReceivedCallback g_packetReceivedCallback = NULL;
 
 static CAIPErrorHandleCallback g_ipErrorHandler = NULL;
 
+/**
+ * Ancillary data buffer for the packet info of a received datagram.
+ */
+typedef union
+{
+    struct cmsghdr cmsg;
+    unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+} CAIPControl_t;
+
+/**
+ * Network interface multicast data is sent on.
+ */
+typedef struct
+{
+    uint32_t index;
+    uint16_t family;
+    uint32_t ipv4addr;
+} CAIPMulticastInterface_t;
+
+/**
+ * Interfaces multicast data is sent on, rebuilt when the netlink socket reports a change
+ * instead of enumerating the interfaces for every multicast message.
+ */
+static CAIPMulticastInterface_t *g_multicastInterfaces = NULL;
+static uint32_t g_multicastInterfaceCount = 0;
+static bool g_multicastInterfacesValid = false;
+static ca_mutex g_multicastInterfaceMutex = NULL;
+
+#ifdef CA_USE_SENDMMSG
+#define SEND_BATCH_SIZE  32     // datagrams sent per sendmmsg()
+#define GSO_MAX_SEGMENTS 64     // UDP GSO segments per message (UDP_MAX_SEGMENTS)
+#define GSO_MAX_SIZE     65000  // UDP GSO payload per message
+#endif
+
 static void CAFindReadyMessage();
 static void CASelectReturned(fd_set *readFds, int ret);
 static void CAProcessNewInterface(CAInterface_t *ifchanged);
+static void CAHandleNetlinkMessage();
+static void CAIPSetMulticastInterfaces(const u_arraylist_t *iflist);
+static CAResult_t CAIPUpdateMulticastInterfaces();
 static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags);
+static void CAHandleReceivedMessage(CATransportFlags_t flags, struct msghdr *msg,
+                                    char *recvBuffer, size_t recvLen);
+
+#ifdef CA_USE_EPOLL
+#define EPOLL_MAX_EVENTS 16     // events handled per epoll_wait()
+#define RECV_BATCH_SIZE  16     // datagrams received per recvmmsg()
+
+/**
+ * Sockets registered with epoll. The index is the epoll event data.
+ */
+static const struct
+{
+    CASocket_t *socket;
+    CATransportFlags_t flags;
+} g_epollSockets[] = {
+    { &caglobals.ip.u6,  CA_IPV6 },
+    { &caglobals.ip.u6s, CA_IPV6 | CA_SECURE },
+    { &caglobals.ip.u4,  CA_IPV4 },
+    { &caglobals.ip.u4s, CA_IPV4 | CA_SECURE },
+    { &caglobals.ip.m6,  CA_MULTICAST | CA_IPV6 },
+    { &caglobals.ip.m6s, CA_MULTICAST | CA_IPV6 | CA_SECURE },
+    { &caglobals.ip.m4,  CA_MULTICAST | CA_IPV4 },
+    { &caglobals.ip.m4s, CA_MULTICAST | CA_IPV4 | CA_SECURE }
+};
+
+#define EPOLL_SOCKET_COUNT (sizeof (g_epollSockets) / sizeof (g_epollSockets[0]))
+#define EPOLL_ID_NETLINK   (EPOLL_SOCKET_COUNT)
+#define EPOLL_ID_SHUTDOWN  (EPOLL_SOCKET_COUNT + 1)
+
+static int g_epollFd = -1;
+
+static void CAInitializeEpoll();
+static void CAFindReadyMessageEpoll();
+static void CAReceiveMessages(int fd, CATransportFlags_t flags);
+#endif
 
 #define SET(TYPE, FDS) \
     if (caglobals.ip.TYPE.fd != -1) \
@@ -141,6 +222,24 @@ void CADeInitializeIPGlobals()
         close(caglobals.ip.netlinkFd);
         caglobals.ip.netlinkFd = -1;
     }
+
+#ifdef CA_USE_EPOLL
+    if (g_epollFd != -1)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+#endif
+
+    OICFree(g_multicastInterfaces);
+    g_multicastInterfaces = NULL;
+    g_multicastInterfaceCount = 0;
+    g_multicastInterfacesValid = false;
+    if (g_multicastInterfaceMutex)
+    {
+        ca_mutex_free(g_multicastInterfaceMutex);
+        g_multicastInterfaceMutex = NULL;
+    }
 }
 
 static void CAReceiveHandler(void *data)
@@ -149,6 +248,13 @@ static void CAReceiveHandler(void *data)
 
     while (!caglobals.ip.terminate)
     {
+#ifdef CA_USE_EPOLL
+        if (g_epollFd != -1)
+        {
+            CAFindReadyMessageEpoll();
+            continue;
+        }
+#endif
         CAFindReadyMessage();
     }
 }
@@ -217,12 +323,7 @@ static void CASelectReturned(fd_set *readFds, int ret)
         else ISSET(m4s, readFds, CA_MULTICAST | CA_IPV4 | CA_SECURE)
         else if (FD_ISSET(caglobals.ip.netlinkFd, readFds))
         {
-            CAInterface_t *ifchanged = CAFindInterfaceChange();
-            if (ifchanged)
-            {
-                CAProcessNewInterface(ifchanged);
-                OICFree(ifchanged);
-            }
+            CAHandleNetlinkMessage();
             break;
         }
         else if (FD_ISSET(caglobals.ip.shutdownFds[0], readFds))
@@ -249,39 +350,17 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
 {
     char recvBuffer[COAP_MAX_PDU_SIZE] = {0};
 
-    size_t len;
-    int level, type, namelen;
     struct sockaddr_storage srcAddr;
-    unsigned char *pktinfo = NULL;
-    struct cmsghdr *cmp = NULL;
     struct iovec iov = { recvBuffer, sizeof (recvBuffer) };
-    union control
-    {
-        struct cmsghdr cmsg;
-        unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
-    } cmsg;
-
-    if (flags & CA_IPV6)
-    {
-        namelen = sizeof (struct sockaddr_in6);
-        level = IPPROTO_IPV6;
-        type = IPV6_PKTINFO;
-        len = sizeof (struct in6_pktinfo);
-    }
-    else
-    {
-        namelen = sizeof (struct sockaddr_in);
-        level = IPPROTO_IP;
-        type = IP_PKTINFO;
-        len = sizeof (struct in6_pktinfo);
-    }
+    CAIPControl_t cmsg;
 
     struct msghdr msg = { .msg_name = &srcAddr,
-                          .msg_namelen = namelen,
+                          .msg_namelen = (flags & CA_IPV6) ? sizeof (struct sockaddr_in6)
+                                                           : sizeof (struct sockaddr_in),
                           .msg_iov = &iov,
                           .msg_iovlen = 1,
                           .msg_control = &cmsg,
-                          .msg_controllen = CMSG_SPACE(len) };
+                          .msg_controllen = sizeof (cmsg) };
 
     ssize_t recvLen = recvmsg(fd, &msg, flags);
     if (-1 == recvLen)
@@ -290,9 +369,32 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
         return CA_STATUS_FAILED;
     }
 
+    CAHandleReceivedMessage(flags, &msg, recvBuffer, recvLen);
+    return CA_STATUS_OK;
+}
+
+static void CAHandleReceivedMessage(CATransportFlags_t flags, struct msghdr *msg,
+                                    char *recvBuffer, size_t recvLen)
+{
+    int level, type;
+    struct sockaddr_storage *srcAddr = (struct sockaddr_storage *)msg->msg_name;
+    unsigned char *pktinfo = NULL;
+    struct cmsghdr *cmp = NULL;
+
+    if (flags & CA_IPV6)
+    {
+        level = IPPROTO_IPV6;
+        type = IPV6_PKTINFO;
+    }
+    else
+    {
+        level = IPPROTO_IP;
+        type = IP_PKTINFO;
+    }
+
     if (flags & CA_MULTICAST)
     {
-        for (cmp = CMSG_FIRSTHDR(&msg); cmp != NULL; cmp = CMSG_NXTHDR(&msg, cmp))
+        for (cmp = CMSG_FIRSTHDR(msg); cmp != NULL; cmp = CMSG_NXTHDR(msg, cmp))
         {
             if (cmp->cmsg_level == level && cmp->cmsg_type == type)
             {
@@ -305,8 +407,8 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
 
     if (flags & CA_IPV6)
     {
-        sep.endpoint.interface = ((struct sockaddr_in6 *)&srcAddr)->sin6_scope_id;
-        ((struct sockaddr_in6 *)&srcAddr)->sin6_scope_id = 0;
+        sep.endpoint.interface = ((struct sockaddr_in6 *)srcAddr)->sin6_scope_id;
+        ((struct sockaddr_in6 *)srcAddr)->sin6_scope_id = 0;
 
         if ((flags & CA_MULTICAST) && pktinfo)
         {
@@ -332,7 +434,7 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
         }
     }
 
-    CAConvertAddrToName(&srcAddr, msg.msg_namelen, sep.endpoint.addr, &sep.endpoint.port);
+    CAConvertAddrToName(srcAddr, msg->msg_namelen, sep.endpoint.addr, &sep.endpoint.port);
 
     if (flags & CA_SECURE)
     {
@@ -350,9 +452,147 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
             g_packetReceivedCallback(&sep, recvBuffer, recvLen);
         }
     }
+}
+
+#ifdef CA_USE_EPOLL
+static void CAEpollAdd(int fd, uint32_t events, uint32_t id)
+{
+    if (-1 == fd || -1 == g_epollFd)
+    {
+        return;
+    }
 
-    return CA_STATUS_OK;
+    struct epoll_event event = { .events = events, .data = { .u32 = id } };
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl failed: %s", strerror(errno));
+        close(g_epollFd);
+        g_epollFd = -1;   // fall back to select
+    }
+}
+
+static void CAInitializeEpoll()
+{
+    if (g_epollFd != -1)
+    {
+        close(g_epollFd);
+    }
+
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed: %s", strerror(errno));
+        return;
+    }
+
+    // Datagram sockets are edge triggered and drained by CAReceiveMessages.
+    for (uint32_t i = 0; i < EPOLL_SOCKET_COUNT; i++)
+    {
+        CAEpollAdd(g_epollSockets[i].socket->fd, EPOLLIN | EPOLLET, i);
+    }
+    CAEpollAdd(caglobals.ip.netlinkFd, EPOLLIN, EPOLL_ID_NETLINK);
+    CAEpollAdd(caglobals.ip.shutdownFds[0], EPOLLIN, EPOLL_ID_SHUTDOWN);
+}
+
+static void CAFindReadyMessageEpoll()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int timeout = caglobals.ip.selectTimeout == -1 ? -1 : caglobals.ip.selectTimeout * 1000;
+
+    int ret = epoll_wait(g_epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (caglobals.ip.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+    if (ret <= 0)
+    {
+        if (ret < 0 && EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.ip.terminate; i++)
+    {
+        uint32_t id = events[i].data.u32;
+        if (id < EPOLL_SOCKET_COUNT)
+        {
+            int fd = g_epollSockets[id].socket->fd;
+            if (fd != -1)
+            {
+                CAReceiveMessages(fd, g_epollSockets[id].flags);
+            }
+        }
+        else if (EPOLL_ID_NETLINK == id)
+        {
+            CAHandleNetlinkMessage();
+        }
+        else
+        {
+            char buf[10] = {0};
+            if (-1 == read(caglobals.ip.shutdownFds[0], buf, sizeof (buf)))
+            {
+                OIC_LOG_V(DEBUG, TAG, "read failed: %s", strerror(errno));
+            }
+        }
+    }
+}
+
+static void CAReceiveMessages(int fd, CATransportFlags_t flags)
+{
+    // Only used by the receive thread.
+    static char recvBuffers[RECV_BATCH_SIZE][COAP_MAX_PDU_SIZE];
+    static struct sockaddr_storage srcAddrs[RECV_BATCH_SIZE];
+    static CAIPControl_t cmsgs[RECV_BATCH_SIZE];
+    struct iovec iovs[RECV_BATCH_SIZE];
+    struct mmsghdr msgs[RECV_BATCH_SIZE];
+
+    socklen_t namelen = (flags & CA_IPV6) ? sizeof (struct sockaddr_in6)
+                                          : sizeof (struct sockaddr_in);
+    int count = 0;
+
+    // The socket is edge triggered, so read until it would block.
+    do
+    {
+        for (int i = 0; i < RECV_BATCH_SIZE; i++)
+        {
+            iovs[i].iov_base = recvBuffers[i];
+            iovs[i].iov_len = sizeof (recvBuffers[i]);
+            msgs[i].msg_hdr = (struct msghdr){ .msg_name = &srcAddrs[i],
+                                               .msg_namelen = namelen,
+                                               .msg_iov = &iovs[i],
+                                               .msg_iovlen = 1,
+                                               .msg_control = &cmsgs[i],
+                                               .msg_controllen = sizeof (cmsgs[i]) };
+            msgs[i].msg_len = 0;
+        }
+
+        count = recvmmsg(fd, msgs, RECV_BATCH_SIZE, MSG_DONTWAIT, NULL);
+        if (-1 == count)
+        {
+            if (EINTR == errno)
+            {
+                count = RECV_BATCH_SIZE;
+                continue;
+            }
+            if (EAGAIN != errno && EWOULDBLOCK != errno)
+            {
+                OIC_LOG_V(ERROR, TAG, "recvmmsg failed %s", strerror(errno));
+            }
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            CAHandleReceivedMessage(flags, &msgs[i].msg_hdr, recvBuffers[i], msgs[i].msg_len);
+        }
+        // A short batch means the receive queue was empty.
+    } while (RECV_BATCH_SIZE == count && !caglobals.ip.terminate);
 }
+#endif
 
 void CAIPPullData()
 {
@@ -470,8 +710,10 @@ static int CACreateSocket(int family, uint16_t *port, bool isMulticast)
 static void CAInitializeNetlink()
 {
 #ifdef __linux__
-    // create NETLINK fd for interface change notifications
-    struct sockaddr_nl sa = { AF_NETLINK, 0, 0, RTMGRP_LINK };
+    // create NETLINK fd for interface change notifications, address changes update the
+    // cached multicast interfaces.
+    struct sockaddr_nl sa = { AF_NETLINK, 0, 0,
+                              RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR };
 
     caglobals.ip.netlinkFd = socket(AF_NETLINK, SOCK_RAW|SOCK_CLOEXEC, NETLINK_ROUTE);
     if (caglobals.ip.netlinkFd == -1)
@@ -559,6 +801,16 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
         caglobals.ip.ipv4enabled = true;  // only needed to run CA tests
     }
 
+    if (!g_multicastInterfaceMutex)
+    {
+        g_multicastInterfaceMutex = ca_mutex_new();
+        if (!g_multicastInterfaceMutex)
+        {
+            OIC_LOG(ERROR, TAG, "ca_mutex_new has failed");
+            return CA_STATUS_FAILED;
+        }
+    }
+
     if (caglobals.ip.ipv6enabled)
     {
         NEWSOCKET(AF_INET6, u6, false)
@@ -595,6 +847,10 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
     // create source of network interface change notifications
     CAInitializeNetlink();
 
+#ifdef CA_USE_EPOLL
+    CAInitializeEpoll();
+#endif
+
     caglobals.ip.selectTimeout = CAGetPollingInterval(caglobals.ip.selectTimeout);
 
     res = CAIPStartListenServer();
@@ -749,6 +1005,8 @@ CAResult_t CAIPStartListenServer()
         }
     }
 
+    CAIPSetMulticastInterfaces(iflist);
+
     u_arraylist_destroy(iflist);
     return CA_STATUS_OK;
 }
@@ -817,6 +1075,83 @@ static void CAProcessNewInterface(CAInterface_t *ifitem)
     }
 }
 
+static void CAHandleNetlinkMessage()
+{
+    CAInterface_t *ifchanged = CAFindInterfaceChange();
+    if (ifchanged)
+    {
+        CAProcessNewInterface(ifchanged);
+        OICFree(ifchanged);
+    }
+
+    // links and addresses both changed the interfaces multicast is sent on.
+    (void)CAIPUpdateMulticastInterfaces();
+}
+
+static void CAIPSetMulticastInterfaces(const u_arraylist_t *iflist)
+{
+    uint32_t len = u_arraylist_length(iflist);
+    CAIPMulticastInterface_t *interfaces = NULL;
+    uint32_t count = 0;
+
+    if (len)
+    {
+        interfaces = (CAIPMulticastInterface_t *)OICMalloc(len * sizeof (*interfaces));
+        if (!interfaces)
+        {
+            OIC_LOG(ERROR, TAG, "Malloc failed");
+            return;
+        }
+    }
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
+        if (!ifitem)
+        {
+            continue;
+        }
+        if ((ifitem->flags & (IFF_UP|IFF_RUNNING)) != (IFF_UP|IFF_RUNNING))
+        {
+            continue;
+        }
+        if (ifitem->family != AF_INET && ifitem->family != AF_INET6)
+        {
+            continue;
+        }
+
+        interfaces[count].index = ifitem->index;
+        interfaces[count].family = ifitem->family;
+        interfaces[count].ipv4addr = ifitem->ipv4addr;
+        count++;
+    }
+
+    ca_mutex_lock(g_multicastInterfaceMutex);
+    CAIPMulticastInterface_t *old = g_multicastInterfaces;
+    g_multicastInterfaces = interfaces;
+    g_multicastInterfaceCount = count;
+    // without netlink there is no change notification, interfaces are read for every send.
+    g_multicastInterfacesValid = (caglobals.ip.netlinkFd != -1);
+    ca_mutex_unlock(g_multicastInterfaceMutex);
+
+    OICFree(old);
+    OIC_LOG_V(DEBUG, TAG, "multicast interfaces: %u", count);
+}
+
+static CAResult_t CAIPUpdateMulticastInterfaces()
+{
+    u_arraylist_t *iflist = CAIPGetInterfaceInformation(0);
+    if (!iflist)
+    {
+        OIC_LOG_V(ERROR, TAG, "get interface info failed: %s", strerror(errno));
+        return CA_STATUS_FAILED;
+    }
+
+    CAIPSetMulticastInterfaces(iflist);
+    u_arraylist_destroy(iflist);
+    return CA_STATUS_OK;
+}
+
 void CAIPSetPacketReceiveCallback(CAIPPacketReceivedCallback callback)
 {
     g_packetReceivedCallback = callback;
@@ -827,9 +1162,262 @@ void CAIPSetConnectionStateChangeCallback(CAIPConnectionStateChangeCallback call
     CAIPSetNetworkMonitorCallback(callback);
 }
 
+#ifdef CA_USE_SENDMMSG
+/**
+ * Datagram collected by CAIPQueueSendData().
+ */
+typedef struct
+{
+    CAEndpoint_t endpoint;      /**< for error reports */
+    const void *data;
+    uint32_t dataLen;
+} CAIPBatchData_t;
+
+/**
+ * Message of a sendmmsg() batch. Consecutive datagrams of equal size to the same destination
+ * share one message and are split by the kernel (UDP GSO).
+ */
+typedef struct
+{
+    struct sockaddr_storage addr;
+    socklen_t addrLen;
+    CAIPControl_t control;
+    size_t controlLen;
+    uint32_t first;             /**< index of the first datagram */
+    uint32_t count;             /**< number of datagrams */
+} CAIPBatchMessage_t;
+
+/**
+ * Datagrams collected by the IP send thread, all for the same socket.
+ */
+static struct
+{
+    int fd;
+    uint32_t dataCount;
+    uint32_t messageCount;
+    CAIPBatchData_t data[SEND_BATCH_SIZE];
+    struct iovec iov[SEND_BATCH_SIZE];
+    CAIPBatchMessage_t messages[SEND_BATCH_SIZE];
+    struct mmsghdr mmsg[SEND_BATCH_SIZE];
+} g_sendBatch = { .fd = -1 };
+
+/**
+ * Whether the kernel supports UDP GSO, probed on first use (-1 until then).
+ */
+static int g_udpGsoSupported = -1;
+
+static bool CAIPSameAddress(const struct sockaddr_storage *a, const struct sockaddr_storage *b)
+{
+    if (a->ss_family != b->ss_family)
+    {
+        return false;
+    }
+    if (AF_INET6 == a->ss_family)
+    {
+        const struct sockaddr_in6 *a6 = (const struct sockaddr_in6 *)a;
+        const struct sockaddr_in6 *b6 = (const struct sockaddr_in6 *)b;
+        return a6->sin6_port == b6->sin6_port
+            && a6->sin6_scope_id == b6->sin6_scope_id
+            && !memcmp(&a6->sin6_addr, &b6->sin6_addr, sizeof (a6->sin6_addr));
+    }
+    const struct sockaddr_in *a4 = (const struct sockaddr_in *)a;
+    const struct sockaddr_in *b4 = (const struct sockaddr_in *)b;
+    return a4->sin_port == b4->sin_port && a4->sin_addr.s_addr == b4->sin_addr.s_addr;
+}
+
+/**
+ * Whether the datagram can be appended to the last message as another GSO segment. All
+ * segments but the last must have the same size.
+ */
+static bool CAIPCanAppendSegment(int fd, const struct sockaddr_storage *sock,
+                                 size_t controlLen, uint32_t dlen)
+{
+    if (!g_sendBatch.messageCount || controlLen)
+    {
+        return false;
+    }
+
+    CAIPBatchMessage_t *last = &g_sendBatch.messages[g_sendBatch.messageCount - 1];
+    uint32_t segmentSize = g_sendBatch.data[last->first].dataLen;
+    uint32_t lastSize = g_sendBatch.data[last->first + last->count - 1].dataLen;
+    if (last->controlLen
+        || lastSize != segmentSize
+        || dlen > segmentSize
+        || last->count >= GSO_MAX_SEGMENTS
+        || (last->count + 1) * segmentSize > GSO_MAX_SIZE
+        || !CAIPSameAddress(&last->addr, sock))
+    {
+        return false;
+    }
+
+    if (-1 == g_udpGsoSupported)
+    {
+        int segment = 0;
+        socklen_t optlen = sizeof (segment);
+        g_udpGsoSupported = !getsockopt(fd, IPPROTO_UDP, UDP_SEGMENT, &segment, &optlen);
+        OIC_LOG_V(DEBUG, TAG, "UDP GSO %s", g_udpGsoSupported ? "supported" : "not supported");
+    }
+    return g_udpGsoSupported;
+}
+
+static void CAIPBatchAdd(int fd, const CAEndpoint_t *endpoint, struct sockaddr_storage *sock,
+                         socklen_t socklen, const CAIPControl_t *control, size_t controlLen,
+                         const void *data, uint32_t dlen)
+{
+    if (SEND_BATCH_SIZE == g_sendBatch.dataCount
+        || (g_sendBatch.dataCount && g_sendBatch.fd != fd))
+    {
+        CAIPFlushSendData();
+    }
+    g_sendBatch.fd = fd;
+
+    uint32_t index = g_sendBatch.dataCount++;
+    CAIPBatchData_t *item = &g_sendBatch.data[index];
+    item->endpoint = *endpoint;
+    item->data = data;
+    item->dataLen = dlen;
+    g_sendBatch.iov[index].iov_base = (void *)data;
+    g_sendBatch.iov[index].iov_len = dlen;
+
+    if (CAIPCanAppendSegment(fd, sock, controlLen, dlen))
+    {
+        g_sendBatch.messages[g_sendBatch.messageCount - 1].count++;
+        return;
+    }
+
+    CAIPBatchMessage_t *message = &g_sendBatch.messages[g_sendBatch.messageCount++];
+    message->addr = *sock;
+    message->addrLen = socklen;
+    message->controlLen = controlLen;
+    if (controlLen)
+    {
+        memcpy(&message->control, control, controlLen);
+    }
+    message->first = index;
+    message->count = 1;
+}
+
+static void CAIPReportBatchResult(const CAIPBatchMessage_t *message, ssize_t len)
+{
+    for (uint32_t i = message->first; i < message->first + message->count; i++)
+    {
+        CAIPBatchData_t *item = &g_sendBatch.data[i];
+        char *secure = (item->endpoint.flags & CA_SECURE) ? "secure " : "";
+        (void)secure;   // eliminates release warning
+        if (-1 == len)
+        {
+            if (g_ipErrorHandler)
+            {
+                g_ipErrorHandler(&item->endpoint, item->data, item->dataLen, CA_SEND_FAILED);
+            }
+            OIC_LOG_V(ERROR, TAG, "%s%s sendmmsg failed: %s", secure, item->endpoint.addr,
+                      strerror(errno));
+        }
+        else
+        {
+            OIC_LOG_V(INFO, TAG, "%s%s sendmmsg is successful: %u bytes", secure,
+                      item->endpoint.addr, item->dataLen);
+        }
+    }
+}
+
+/**
+ * Send the datagrams of a GSO message one by one, after the kernel refused the message.
+ */
+static void CAIPSendSegments(const CAIPBatchMessage_t *message)
+{
+    for (uint32_t i = 0; i < message->count; i++)
+    {
+        CAIPBatchMessage_t single = *message;
+        single.first = message->first + i;
+        single.count = 1;
+
+        ssize_t len = sendto(g_sendBatch.fd, g_sendBatch.data[single.first].data,
+                             g_sendBatch.data[single.first].dataLen, 0,
+                             (struct sockaddr *)&single.addr, single.addrLen);
+        CAIPReportBatchResult(&single, len);
+    }
+}
+
+void CAIPFlushSendData()
+{
+    uint32_t count = g_sendBatch.messageCount;
+    if (!count)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAIPBatchMessage_t *message = &g_sendBatch.messages[i];
+        struct msghdr *hdr = &g_sendBatch.mmsg[i].msg_hdr;
+
+        hdr->msg_name = &message->addr;
+        hdr->msg_namelen = message->addrLen;
+        hdr->msg_iov = &g_sendBatch.iov[message->first];
+        hdr->msg_iovlen = message->count;
+        hdr->msg_control = message->controlLen ? &message->control : NULL;
+        hdr->msg_controllen = message->controlLen;
+        hdr->msg_flags = 0;
+
+        if (message->count > 1)
+        {
+            memset(&message->control, 0, sizeof (message->control));
+            struct cmsghdr *cmsg = &message->control.cmsg;
+            cmsg->cmsg_level = IPPROTO_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof (uint16_t));
+            uint16_t segmentSize = (uint16_t)g_sendBatch.data[message->first].dataLen;
+            memcpy(CMSG_DATA(cmsg), &segmentSize, sizeof (segmentSize));
+            hdr->msg_control = &message->control;
+            hdr->msg_controllen = CMSG_SPACE(sizeof (uint16_t));
+        }
+    }
+
+    uint32_t sent = 0;
+    while (sent < count)
+    {
+        int ret = sendmmsg(g_sendBatch.fd, &g_sendBatch.mmsg[sent], count - sent, 0);
+        if (ret > 0)
+        {
+            for (int i = 0; i < ret; i++)
+            {
+                CAIPReportBatchResult(&g_sendBatch.messages[sent + i], 0);
+            }
+            sent += ret;
+            continue;
+        }
+        if (-1 == ret && EINTR == errno)
+        {
+            continue;
+        }
+
+        // the first message not sent failed, report it and go on with the next one.
+        CAIPBatchMessage_t *message = &g_sendBatch.messages[sent];
+        if (message->count > 1)
+        {
+            OIC_LOG_V(DEBUG, TAG, "UDP GSO send failed: %s", strerror(errno));
+            CAIPSendSegments(message);
+        }
+        else
+        {
+            CAIPReportBatchResult(message, -1);
+        }
+        sent++;
+    }
+
+    g_sendBatch.dataCount = 0;
+    g_sendBatch.messageCount = 0;
+}
+#else
+void CAIPFlushSendData()
+{
+}
+#endif // CA_USE_SENDMMSG
+
 static void sendData(int fd, const CAEndpoint_t *endpoint,
                      const void *data, uint32_t dlen,
-                     const char *cast, const char *fam)
+                     const char *cast, const char *fam, bool batch)
 {
     OIC_LOG(DEBUG, TAG, "IN");
 
@@ -863,6 +1451,16 @@ static void sendData(int fd, const CAEndpoint_t *endpoint,
         socklen = sizeof(struct sockaddr_in);
     }
 
+#ifdef CA_USE_SENDMMSG
+    if (batch)
+    {
+        CAIPBatchAdd(fd, endpoint, &sock, socklen, NULL, 0, data, dlen);
+        return;
+    }
+#else
+    (void)batch;
+#endif
+
     ssize_t len = sendto(fd, data, dlen, 0, (struct sockaddr *)&sock, socklen);
     if (-1 == len)
     {
@@ -881,9 +1479,104 @@ static void sendData(int fd, const CAEndpoint_t *endpoint,
     }
 }
 
-static void sendMulticastData6(const u_arraylist_t *iflist,
-                               CAEndpoint_t *endpoint,
-                               const void *data, uint32_t datalen)
+/**
+ * Send multicast data on one interface. The interface is selected by the packet info control
+ * data of the message, so the socket options of the unicast socket are left untouched and
+ * responses come back to its port.
+ */
+static void sendMulticastInterface(int fd, const CAEndpoint_t *endpoint,
+                                   struct sockaddr_storage *sock,
+                                   const CAIPMulticastInterface_t *ifitem,
+                                   const void *data, uint32_t dlen, bool batch)
+{
+    CAIPControl_t control;
+    memset(&control, 0, sizeof (control));
+
+    struct iovec iov = { (void *)data, dlen };
+    struct msghdr msg = { .msg_name = sock,
+                          .msg_iov = &iov,
+                          .msg_iovlen = 1,
+                          .msg_control = &control };
+    struct cmsghdr *cmsg = &control.cmsg;
+    const char *fam;
+
+    if (AF_INET6 == ifitem->family)
+    {
+        fam = "ipv6";
+        ((struct sockaddr_in6 *)sock)->sin6_scope_id = ifitem->index;
+        msg.msg_namelen = sizeof (struct sockaddr_in6);
+        msg.msg_controllen = CMSG_SPACE(sizeof (struct in6_pktinfo));
+
+        cmsg->cmsg_level = IPPROTO_IPV6;
+        cmsg->cmsg_type = IPV6_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof (struct in6_pktinfo));
+        struct in6_pktinfo *pktinfo = (struct in6_pktinfo *)CMSG_DATA(cmsg);
+        pktinfo->ipi6_ifindex = ifitem->index;
+    }
+    else
+    {
+        fam = "ipv4";
+        msg.msg_namelen = sizeof (struct sockaddr_in);
+        msg.msg_controllen = CMSG_SPACE(sizeof (struct in_pktinfo));
+
+        cmsg->cmsg_level = IPPROTO_IP;
+        cmsg->cmsg_type = IP_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof (struct in_pktinfo));
+        struct in_pktinfo *pktinfo = (struct in_pktinfo *)CMSG_DATA(cmsg);
+        pktinfo->ipi_ifindex = ifitem->index;
+        pktinfo->ipi_spec_dst.s_addr = ifitem->ipv4addr;
+    }
+
+#ifdef CA_USE_SENDMMSG
+    if (batch)
+    {
+        CAIPBatchAdd(fd, endpoint, sock, msg.msg_namelen, &control, msg.msg_controllen,
+                     data, dlen);
+        return;
+    }
+#else
+    (void)batch;
+#endif
+
+    char *secure = (endpoint->flags & CA_SECURE) ? "secure " : "";
+    (void)secure;   // eliminates release warning
+    (void)fam;
+
+    ssize_t len = sendmsg(fd, &msg, 0);
+    if (-1 == len)
+    {
+        if (g_ipErrorHandler)
+        {
+            g_ipErrorHandler(endpoint, data, dlen, CA_SEND_FAILED);
+        }
+        OIC_LOG_V(ERROR, TAG, "%smulticast %s sendTo failed: %s", secure, fam, strerror(errno));
+    }
+    else
+    {
+        OIC_LOG_V(INFO, TAG, "%smulticast %s sendTo is successful: %zd bytes", secure, fam, len);
+    }
+}
+
+static void sendMulticastData(int fd, int family, CAEndpoint_t *endpoint,
+                              const void *data, uint32_t datalen, bool batch)
+{
+    struct sockaddr_storage sock;
+    CAConvertNameToAddr(endpoint->addr, endpoint->port, &sock);
+
+    ca_mutex_lock(g_multicastInterfaceMutex);
+    for (uint32_t i = 0; i < g_multicastInterfaceCount; i++)
+    {
+        if (g_multicastInterfaces[i].family == family)
+        {
+            sendMulticastInterface(fd, endpoint, &sock, &g_multicastInterfaces[i],
+                                   data, datalen, batch);
+        }
+    }
+    ca_mutex_unlock(g_multicastInterfaceMutex);
+}
+
+static void sendMulticastData6(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
+                               bool batch)
 {
     if (!endpoint)
     {
@@ -899,77 +1592,22 @@ static void sendMulticastData6(const u_arraylist_t *iflist,
         return;
     }
     OICStrcpy(endpoint->addr, sizeof(endpoint->addr), ipv6mcname);
-    int fd = caglobals.ip.u6.fd;
-
-    uint32_t len = u_arraylist_length(iflist);
-    for (uint32_t i = 0; i < len; i++)
-    {
-        CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
-        if (!ifitem)
-        {
-            continue;
-        }
-        if ((ifitem->flags & (IFF_UP|IFF_RUNNING)) != (IFF_UP|IFF_RUNNING))
-        {
-            continue;
-        }
-        if (ifitem->family != AF_INET6)
-        {
-            continue;
-        }
 
-        int index = ifitem->index;
-        if (setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, &index, sizeof (index)))
-        {
-            OIC_LOG_V(ERROR, TAG, "setsockopt6 failed: %s", strerror(errno));
-            return;
-        }
-        sendData(fd, endpoint, data, datalen, "multicast", "ipv6");
-    }
+    sendMulticastData(caglobals.ip.u6.fd, AF_INET6, endpoint, data, datalen, batch);
 }
 
-static void sendMulticastData4(const u_arraylist_t *iflist,
-                               CAEndpoint_t *endpoint,
-                               const void *data, uint32_t datalen)
+static void sendMulticastData4(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
+                               bool batch)
 {
     VERIFY_NON_NULL_VOID(endpoint, TAG, "endpoint is NULL");
 
-    struct ip_mreqn mreq = { .imr_multiaddr = IPv4MulticastAddress,
-                             .imr_ifindex = 0 };
     OICStrcpy(endpoint->addr, sizeof(endpoint->addr), IPv4_MULTICAST);
-    int fd = caglobals.ip.u4.fd;
-
-    uint32_t len = u_arraylist_length(iflist);
-    for (uint32_t i = 0; i < len; i++)
-    {
-        CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
-        if (!ifitem)
-        {
-            continue;
-        }
-        if ((ifitem->flags & (IFF_UP|IFF_RUNNING)) != (IFF_UP|IFF_RUNNING))
-        {
-            continue;
-        }
-        if (ifitem->family != AF_INET)
-        {
-            continue;
-        }
 
-        struct in_addr inaddr;
-        inaddr.s_addr = ifitem->ipv4addr;
-        mreq.imr_address = inaddr;
-        if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof (mreq)))
-        {
-            OIC_LOG_V(ERROR, TAG, "send IP_MULTICAST_IF failed: %s (using defualt)",
-                    strerror(errno));
-        }
-        sendData(fd, endpoint, data, datalen, "multicast", "ipv4");
-    }
+    sendMulticastData(caglobals.ip.u4.fd, AF_INET, endpoint, data, datalen, batch);
 }
 
-void CAIPSendData(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
-                  bool isMulticast)
+static void CAIPSendDataInternal(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
+                                 bool isMulticast, bool batch)
 {
     VERIFY_NON_NULL_VOID(endpoint, TAG, "endpoint is NULL");
     VERIFY_NON_NULL_VOID(data, TAG, "data is NULL");
@@ -980,23 +1618,23 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
     {
         endpoint->port = isSecure ? CA_SECURE_COAP : CA_COAP;
 
-        u_arraylist_t *iflist = CAIPGetInterfaceInformation(0);
-        if (!iflist)
+        ca_mutex_lock(g_multicastInterfaceMutex);
+        bool valid = g_multicastInterfacesValid;
+        ca_mutex_unlock(g_multicastInterfaceMutex);
+
+        if (!valid && CA_STATUS_OK != CAIPUpdateMulticastInterfaces())
         {
-            OIC_LOG_V(ERROR, TAG, "get interface info failed: %s", strerror(errno));
             return;
         }
 
         if ((endpoint->flags & CA_IPV6) && caglobals.ip.ipv6enabled)
         {
-            sendMulticastData6(iflist, endpoint, data, datalen);
+            sendMulticastData6(endpoint, data, datalen, batch);
         }
         if ((endpoint->flags & CA_IPV4) && caglobals.ip.ipv4enabled)
         {
-            sendMulticastData4(iflist, endpoint, data, datalen);
+            sendMulticastData4(endpoint, data, datalen, batch);
         }
-
-        u_arraylist_destroy(iflist);
     }
     else
     {
@@ -1012,7 +1650,7 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
 #ifndef __WITH_DTLS__
             fd = caglobals.ip.u6.fd;
 #endif
-            sendData(fd, endpoint, data, datalen, "unicast", "ipv6");
+            sendData(fd, endpoint, data, datalen, "unicast", "ipv6", batch);
         }
         if (caglobals.ip.ipv4enabled && (endpoint->flags & CA_IPV4))
         {
@@ -1020,11 +1658,23 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
 #ifndef __WITH_DTLS__
             fd = caglobals.ip.u4.fd;
 #endif
-            sendData(fd, endpoint, data, datalen, "unicast", "ipv4");
+            sendData(fd, endpoint, data, datalen, "unicast", "ipv4", batch);
         }
     }
 }
 
+void CAIPSendData(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
+                  bool isMulticast)
+{
+    CAIPSendDataInternal(endpoint, data, datalen, isMulticast, false);
+}
+
+void CAIPQueueSendData(CAEndpoint_t *endpoint, const void *data, uint32_t datalen,
+                       bool isMulticast)
+{
+    CAIPSendDataInternal(endpoint, data, datalen, isMulticast, true);
+}
+
 CAResult_t CAGetIPInterfaceInformation(CAEndpoint_t **info, uint32_t *size)
 {
     VERIFY_NON_NULL(info, TAG, "info is NULL");
@@ -60,6 +60,10 @@ typedef struct
 
 #define CA_TCP_SELECT_TIMEOUT 10
 
+#define CA_TCP_SEND_HIGH_WATERMARK (64 * 1024)
+
+#define CA_TCP_SEND_LOW_WATERMARK (16 * 1024)
+
 /**
  * Queue handle for Send Data.
  */
@@ -201,7 +205,8 @@ static void CAInitializeTCPGlobals()
     caglobals.tcp.ipv6.fd = -1;
     caglobals.tcp.selectTimeout = CA_TCP_SELECT_TIMEOUT;
     caglobals.tcp.listenBacklog = CA_TCP_LISTEN_BACKLOG;
-    caglobals.tcp.svrlist = NULL;
+    caglobals.tcp.sendHighWatermark = CA_TCP_SEND_HIGH_WATERMARK;
+    caglobals.tcp.sendLowWatermark = CA_TCP_SEND_LOW_WATERMARK;
 
     CATransportFlags_t flags = 0;
     if (caglobals.client)
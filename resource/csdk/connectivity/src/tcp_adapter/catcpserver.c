@@ -23,6 +23,7 @@
 #include <sys/select.h>
 #include <sys/ioctl.h>
 #include <sys/poll.h>
+#include <sys/uio.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -44,6 +45,10 @@
 #include "oic_malloc.h"
 #include "oic_string.h"
 
+#ifdef CA_USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 /**
  * Logging tag for module name.
  */
@@ -55,10 +60,30 @@
 #define SERVER_PORT 8000
 
 /**
- * Maximum CoAP over TCP header length
- * to know the total data length.
+ * Initial size of the per-session receive buffer.
+ * Several small messages fit; it grows temporarily for larger ones.
+ */
+#define TCP_RECV_BUFFER_SIZE 2048
+
+/**
+ * Maximum number of ready sockets handled per select()/epoll_wait().
+ */
+#define TCP_MAX_READY_EVENTS 64
+
+/**
+ * Maximum number of queued buffers written by one sendmsg().
+ */
+#define TCP_MAX_SEND_IOV 16
+
+/**
+ * Endpoint flags in the session key. The address family is part of the endpoint
+ * key already; a secure and a plain session to the same peer are kept apart.
  */
-#define TCP_MAX_HEADER_LEN  6
+#define CA_TCP_SESSION_KEY_FLAGS CA_SECURE
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
 
 /**
  * Mutex to synchronize device object list.
@@ -85,6 +110,40 @@ static CATCPErrorHandleCallback g_tcpErrorHandler = NULL;
  */
 static CATCPConnectionHandleCallback g_connectionCallback = NULL;
 
+/**
+ * Session table indexed by socket file descriptor.
+ * Guarded by g_mutexObjectList.
+ */
+static CATCPSessionInfo_t *g_sessionsByFd = NULL;
+
+/**
+ * Session table indexed by remote address, port and CA_TCP_SESSION_KEY_FLAGS.
+ * Guarded by g_mutexObjectList.
+ */
+static CATCPSessionInfo_t *g_sessionsByEndpoint = NULL;
+
+/**
+ * Address, port and endpoint key of the last session lookup. Every send looks its
+ * session up, and parsing a scoped address resolves the interface name, so the key
+ * is reused while the same peer is addressed. Cleared whenever a session is added
+ * or removed, since a new interface index comes with new sessions.
+ * Guarded by g_mutexObjectList.
+ */
+static char g_lastLookupAddr[MAX_ADDR_STR_SIZE_CA];
+static uint16_t g_lastLookupPort = 0;
+static CATCPSessionKey_t g_lastLookupKey;
+
+#ifdef CA_USE_EPOLL
+/**
+ * epoll instance watching the accept sockets, pipes and sessions.
+ * -1 if select() is used instead.
+ */
+static int g_epollFd = -1;
+
+static void CAInitializeEpoll();
+static void CAFindReadyMessageEpoll();
+#endif
+
 static CAResult_t CATCPCreateMutex();
 static void CATCPDestroyMutex();
 static CAResult_t CATCPCreateCond();
@@ -92,10 +151,12 @@ static void CATCPDestroyCond();
 static int CACreateAcceptSocket(int family, CASocket_t *sock);
 static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock);
 static void CAFindReadyMessage();
-static void CASelectReturned(fd_set *readFds, int ret);
+static void CASelectReturned(fd_set *readFds, fd_set *writeFds);
 static void CAReceiveMessage(int fd);
 static void CAReceiveHandler(void *data);
 static int CATCPCreateSocket(int family, CATCPSessionInfo_t *tcpServerInfo);
+static void CAHandleWritable(int fd);
+static void CAUpdateWriteInterest(CATCPSessionInfo_t *svritem);
 
 #define CHECKFD(FD) \
     if (FD > caglobals.tcp.maxfd) \
@@ -155,6 +216,13 @@ static void CAReceiveHandler(void *data)
 
     while (!caglobals.tcp.terminate)
     {
+#ifdef CA_USE_EPOLL
+        if (g_epollFd != -1)
+        {
+            CAFindReadyMessageEpoll();
+            continue;
+        }
+#endif
         CAFindReadyMessage();
     }
 
@@ -168,9 +236,11 @@ static void CAReceiveHandler(void *data)
 static void CAFindReadyMessage()
 {
     fd_set readFds;
+    fd_set writeFds;
     struct timeval timeout = { .tv_sec = caglobals.tcp.selectTimeout };
 
     FD_ZERO(&readFds);
+    FD_ZERO(&writeFds);
 
     if (-1 != caglobals.tcp.ipv4.fd)
     {
@@ -189,18 +259,23 @@ static void CAFindReadyMessage()
         FD_SET(caglobals.tcp.connectionFds[0], &readFds);
     }
 
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-    for (size_t i = 0; i < length; i++)
+    ca_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *svritem = NULL;
+    CATCPSessionInfo_t *tmp = NULL;
+    HASH_ITER(fdHh, g_sessionsByFd, svritem, tmp)
     {
-        CATCPSessionInfo_t *svritem =
-                (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-        if (svritem && 0 <= svritem->fd)
+        if (0 <= svritem->fd)
         {
             FD_SET(svritem->fd, &readFds);
+            if (svritem->writeWatched)
+            {
+                FD_SET(svritem->fd, &writeFds);
+            }
         }
     }
+    ca_mutex_unlock(g_mutexObjectList);
 
-    int ret = select(caglobals.tcp.maxfd + 1, &readFds, NULL, NULL, &timeout);
+    int ret = select(caglobals.tcp.maxfd + 1, &readFds, &writeFds, NULL, &timeout);
 
     if (caglobals.tcp.terminate)
     {
@@ -216,12 +291,13 @@ static void CAFindReadyMessage()
         return;
     }
 
-    CASelectReturned(&readFds, ret);
+    CASelectReturned(&readFds, &writeFds);
 }
 
-static void CASelectReturned(fd_set *readFds, int ret)
+static void CASelectReturned(fd_set *readFds, fd_set *writeFds)
 {
     VERIFY_NON_NULL_VOID(readFds, TAG, "readFds is NULL");
+    VERIFY_NON_NULL_VOID(writeFds, TAG, "writeFds is NULL");
 
     if (caglobals.tcp.ipv4.fd != -1 && FD_ISSET(caglobals.tcp.ipv4.fd, readFds))
     {
@@ -248,39 +324,290 @@ static void CASelectReturned(fd_set *readFds, int ret)
         FD_CLR(caglobals.tcp.connectionFds[0], readFds);
         return;
     }
-    else if (-1 != caglobals.tcp.connectionFds[0] &&
-            FD_ISSET(caglobals.tcp.connectionFds[0], readFds))
+    else
     {
-        // new connection was created from remote device.
-        // exit the function to update read file descriptor.
-        char buf[MAX_ADDR_STR_SIZE_CA] = {0};
-        ssize_t len = read(caglobals.tcp.connectionFds[0], buf, sizeof (buf));
-        if (-1 == len)
+        // collect the ready sessions first; receiving may remove sessions.
+        int readyFds[TCP_MAX_READY_EVENTS];
+        int writableFds[TCP_MAX_READY_EVENTS];
+        size_t readyCount = 0;
+        size_t writableCount = 0;
+
+        ca_mutex_lock(g_mutexObjectList);
+        CATCPSessionInfo_t *svritem = NULL;
+        CATCPSessionInfo_t *tmp = NULL;
+        HASH_ITER(fdHh, g_sessionsByFd, svritem, tmp)
         {
-            return;
+            if (svritem->fd < 0)
+            {
+                continue;
+            }
+            if (readyCount < TCP_MAX_READY_EVENTS && FD_ISSET(svritem->fd, readFds))
+            {
+                readyFds[readyCount++] = svritem->fd;
+            }
+            if (writableCount < TCP_MAX_READY_EVENTS && FD_ISSET(svritem->fd, writeFds))
+            {
+                writableFds[writableCount++] = svritem->fd;
+            }
         }
-        OIC_LOG_V(DEBUG, TAG, "Received new connection event with [%s]", buf);
-        FD_CLR(caglobals.tcp.connectionFds[0], readFds);
+        ca_mutex_unlock(g_mutexObjectList);
+
+        for (size_t i = 0; i < readyCount; i++)
+        {
+            CAReceiveMessage(readyFds[i]);
+        }
+        for (size_t i = 0; i < writableCount; i++)
+        {
+            CAHandleWritable(writableFds[i]);
+        }
+    }
+}
+
+#ifdef CA_USE_EPOLL
+static bool CAEpollAdd(int fd)
+{
+    if (-1 == g_epollFd || -1 == fd)
+    {
+        return true;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data = { .fd = fd } };
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl add failed: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void CAEpollModify(int fd, uint32_t events)
+{
+    if (-1 == g_epollFd || -1 == fd)
+    {
         return;
     }
-    else
+
+    struct epoll_event event = { .events = events, .data = { .fd = fd } };
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_MOD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl mod failed: %s", strerror(errno));
+    }
+}
+
+static void CAEpollRemove(int fd)
+{
+    if (-1 == g_epollFd || -1 == fd)
+    {
+        return;
+    }
+
+    struct epoll_event event = { 0 };   // ignored, but required before Linux 2.6.9
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_DEL, fd, &event))
+    {
+        OIC_LOG_V(DEBUG, TAG, "epoll_ctl del failed: %s", strerror(errno));
+    }
+}
+
+static void CAInitializeEpoll()
+{
+    if (g_epollFd != -1)
+    {
+        close(g_epollFd);
+    }
+
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed: %s", strerror(errno));
+        return;
+    }
+
+    if (!CAEpollAdd(caglobals.tcp.ipv4.fd) || !CAEpollAdd(caglobals.tcp.ipv6.fd)
+        || !CAEpollAdd(caglobals.tcp.shutdownFds[0])
+        || !CAEpollAdd(caglobals.tcp.connectionFds[0]))
+    {
+        close(g_epollFd);
+        g_epollFd = -1;     // fall back to select
+        return;
+    }
+
+    // sessions may already exist if a client connected before the server started.
+    CATCPSessionInfo_t *svritem = NULL;
+    CATCPSessionInfo_t *tmp = NULL;
+    ca_mutex_lock(g_mutexObjectList);
+    HASH_ITER(fdHh, g_sessionsByFd, svritem, tmp)
+    {
+        CAEpollAdd(svritem->fd);
+    }
+    ca_mutex_unlock(g_mutexObjectList);
+}
+
+static void CAFindReadyMessageEpoll()
+{
+    struct epoll_event events[TCP_MAX_READY_EVENTS];
+
+    int ret = epoll_wait(g_epollFd, events, TCP_MAX_READY_EVENTS,
+                         caglobals.tcp.selectTimeout * 1000);
+
+    if (caglobals.tcp.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+    if (0 >= ret)
+    {
+        if (0 > ret && EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.tcp.terminate; i++)
     {
-        uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-        for (size_t i = 0; i < length; i++)
+        int fd = events[i].data.fd;
+        if (fd == caglobals.tcp.ipv4.fd)
+        {
+            CAAcceptConnection(CA_IPV4, &caglobals.tcp.ipv4);
+        }
+        else if (fd == caglobals.tcp.ipv6.fd)
         {
-            CATCPSessionInfo_t *svritem =
-                    (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-            if (svritem && svritem->fd >= 0)
+            CAAcceptConnection(CA_IPV6, &caglobals.tcp.ipv6);
+        }
+        else if (fd == caglobals.tcp.connectionFds[0])
+        {
+            // sessions are registered with epoll directly; just drain the pipe.
+            char buf[MAX_ADDR_STR_SIZE_CA] = {0};
+            if (-1 == read(fd, buf, sizeof (buf)))
             {
-                if (FD_ISSET(svritem->fd, readFds))
-                {
-                    CAReceiveMessage(svritem->fd);
-                    FD_CLR(svritem->fd, readFds);
-                }
+                OIC_LOG_V(DEBUG, TAG, "read failed: %s", strerror(errno));
+            }
+        }
+        else if (fd != caglobals.tcp.shutdownFds[0])
+        {
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            {
+                CAReceiveMessage(fd);
+            }
+            if (events[i].events & EPOLLOUT)
+            {
+                CAHandleWritable(fd);
             }
         }
     }
 }
+#endif
+
+static void CASetNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (-1 == flags || -1 == fcntl(fd, F_SETFL, flags | O_NONBLOCK))
+    {
+        OIC_LOG_V(ERROR, TAG, "set O_NONBLOCK failed: %s", strerror(errno));
+    }
+}
+
+/**
+ * Add a session to the session tables.
+ * g_mutexObjectList must be held by the caller.
+ */
+static bool CAAddTCPSession(CATCPSessionInfo_t *svritem)
+{
+    svritem->key.flags = svritem->sep.endpoint.flags & CA_TCP_SESSION_KEY_FLAGS;
+    if (!CAConvertNameToKey(svritem->sep.endpoint.addr, svritem->sep.endpoint.port,
+                            &svritem->key.endpoint))
+    {
+        OIC_LOG_V(ERROR, TAG, "invalid session address %s", svritem->sep.endpoint.addr);
+        return false;
+    }
+
+#ifdef CA_USE_EPOLL
+    if (!CAEpollAdd(svritem->fd))
+    {
+        return false;
+    }
+#endif
+
+    HASH_ADD(fdHh, g_sessionsByFd, fd, sizeof (svritem->fd), svritem);
+    HASH_ADD(epHh, g_sessionsByEndpoint, key, sizeof (svritem->key), svritem);
+    g_lastLookupAddr[0] = '\0';
+    return true;
+}
+
+/**
+ * Remove a session from the session tables.
+ * g_mutexObjectList must be held by the caller.
+ */
+static void CARemoveTCPSession(CATCPSessionInfo_t *svritem)
+{
+#ifdef CA_USE_EPOLL
+    CAEpollRemove(svritem->fd);
+#endif
+
+    HASH_DELETE(fdHh, g_sessionsByFd, svritem);
+    HASH_DELETE(epHh, g_sessionsByEndpoint, svritem);
+    g_lastLookupAddr[0] = '\0';
+}
+
+/**
+ * Detach the send queue of a session.
+ * g_mutexObjectList must be held by the caller, unless the session has
+ * already been removed from the session tables.
+ *
+ * @return  the pending send buffers, to be freed with CAReleaseSendQueue().
+ */
+static CATCPSendBuffer_t *CADetachSendQueue(CATCPSessionInfo_t *svritem)
+{
+    CATCPSendBuffer_t *buf = svritem->sendHead;
+    svritem->sendHead = NULL;
+    svritem->sendTail = NULL;
+    svritem->sendQueueLen = 0;
+    return buf;
+}
+
+/**
+ * Free detached send buffers, reporting each of them as failed if notify is set.
+ * When notifying, g_mutexObjectList must not be held, since the error handler
+ * may call back into the adapter.
+ */
+static void CAReleaseSendQueue(const CAEndpoint_t *endpoint, CATCPSendBuffer_t *buf, bool notify)
+{
+    while (buf)
+    {
+        CATCPSendBuffer_t *next = buf->next;
+        if (notify && g_tcpErrorHandler)
+        {
+            g_tcpErrorHandler(endpoint, buf->data, buf->len, CA_SEND_FAILED);
+        }
+        OICFree(buf);
+        buf = next;
+    }
+}
+
+/**
+ * Close a session already removed from the session tables and free it.
+ * Called without g_mutexObjectList held; the pending sends are reported
+ * as failed and the CA Common Layer is told about the disconnection.
+ */
+static void CACloseTCPSession(CATCPSessionInfo_t *svritem)
+{
+    CATCPSendBuffer_t *pending = CADetachSendQueue(svritem);
+    if (svritem->fd >= 0)
+    {
+        close(svritem->fd);
+    }
+    OICFree(svritem->recvData);
+
+    CAReleaseSendQueue(&svritem->sep.endpoint, pending, true);
+
+    // pass the connection information to CA Common Layer.
+    if (g_connectionCallback)
+    {
+        g_connectionCallback(&(svritem->sep.endpoint), false);
+    }
+
+    OICFree(svritem);
+}
 
 static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
 {
@@ -292,6 +619,8 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
     int sockfd = accept(sock->fd, (struct sockaddr *)&clientaddr, &clientlen);
     if (-1 != sockfd)
     {
+        CASetNonBlocking(sockfd);
+
         CATCPSessionInfo_t *svritem =
                 (CATCPSessionInfo_t *) OICCalloc(1, sizeof (*svritem));
         if (!svritem)
@@ -307,10 +636,10 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
                             (char *) &svritem->sep.endpoint.addr, &svritem->sep.endpoint.port);
 
         ca_mutex_lock(g_mutexObjectList);
-        bool result = u_arraylist_add(caglobals.tcp.svrlist, svritem);
+        bool result = CAAddTCPSession(svritem);
         if (!result)
         {
-            OIC_LOG(ERROR, TAG, "u_arraylist_add failed.");
+            OIC_LOG(ERROR, TAG, "CAAddTCPSession failed.");
             close(sockfd);
             OICFree(svritem);
             ca_mutex_unlock(g_mutexObjectList);
@@ -325,79 +654,92 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
 static void CAReceiveMessage(int fd)
 {
     // #1. get remote device information from file descriptor.
-    size_t index = 0;
-    CATCPSessionInfo_t *svritem = CAGetSessionInfoFromFD(fd, &index);
+    CATCPSessionInfo_t *svritem = CAGetSessionInfoFromFD(fd);
     if (!svritem)
     {
         OIC_LOG(ERROR, TAG, "there is no connection information in list");
         return;
     }
 
-    // #2. get already allocated memory size.
-    size_t bufSize = (svritem->totalDataLen == 0) ? TCP_MAX_HEADER_LEN : svritem->totalDataLen;
+    // #2. allocate the receive buffer once; it is reused for every message.
     if (!svritem->recvData)
     {
-        svritem->recvData = (unsigned char *) OICCalloc(1, bufSize);
+        svritem->recvData = (unsigned char *) OICMalloc(TCP_RECV_BUFFER_SIZE);
         if (!svritem->recvData)
         {
             OIC_LOG(ERROR, TAG, "out of memory");
-            CADisconnectTCPSession(svritem, index);
+            CADisconnectTCPSession(svritem);
             return;
         }
+        svritem->recvBufSize = TCP_RECV_BUFFER_SIZE;
     }
 
-    // #3. receive data from remote device.
-    ssize_t recvLen = recv(fd, svritem->recvData + svritem->recvDataLen,
-                           bufSize - svritem->recvDataLen, 0);
+    // #3. receive as much as fits, possibly several pipelined messages.
+    unsigned char *buf = (unsigned char *) svritem->recvData;
+    ssize_t recvLen = recv(fd, buf + svritem->recvDataLen,
+                           svritem->recvBufSize - svritem->recvDataLen, 0);
     if (recvLen <= 0)
     {
-        if(EWOULDBLOCK != errno)
+        if (0 == recvLen || (EWOULDBLOCK != errno && EAGAIN != errno))
         {
             OIC_LOG_V(ERROR, TAG, "Recvfrom failed %s", strerror(errno));
-            CADisconnectTCPSession(svritem, index);
+            CADisconnectTCPSession(svritem);
         }
         return;
     }
     svritem->recvDataLen += recvLen;
+    svritem->sep.endpoint.adapter = CA_ADAPTER_TCP;
 
-    // #4. get actual data length from coap over tcp header.
-    if (!svritem->totalDataLen)
+    // #4. pass every complete message to upper layer straight from the buffer.
+    size_t offset = 0;
+    size_t totalLen = 0;
+    while (svritem->recvDataLen > offset)
     {
         coap_transport_type transport = coap_get_tcp_header_type_from_initbyte(
-                ((unsigned char *) svritem->recvData)[0] >> 4);
-
+                buf[offset] >> 4);
         size_t headerLen = coap_get_tcp_header_length_for_transport(transport);
-        if (svritem->recvDataLen >= headerLen)
+        if (svritem->recvDataLen - offset < headerLen)
         {
-            svritem->totalDataLen = CAGetTotalLengthFromHeader(
-                    (unsigned char *) svritem->recvData);
-            bufSize = svritem->totalDataLen;
-            unsigned char *newBuf = OICRealloc(svritem->recvData, bufSize);
-            if (!newBuf)
-            {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                CADisconnectTCPSession(svritem, index);
-                return;
-            }
-            svritem->recvData = newBuf;
+            break;
+        }
+
+        totalLen = CAGetTotalLengthFromHeader(buf + offset);
+        if (svritem->recvDataLen - offset < totalLen)
+        {
+            break;
+        }
+
+        if (g_packetReceivedCallback)
+        {
+            g_packetReceivedCallback(&svritem->sep, buf + offset, totalLen);
         }
+        OIC_LOG_V(DEBUG, TAG, "total received data len:%zu", totalLen);
+
+        offset += totalLen;
+        totalLen = 0;
     }
 
-    // #5. pass the received data information to upper layer.
-    if ((svritem->totalDataLen == svritem->recvDataLen) && g_packetReceivedCallback)
+    // #5. move the partial message, if any, to the front of the buffer.
+    svritem->recvDataLen -= offset;
+    if (svritem->recvDataLen && offset)
     {
-        svritem->sep.endpoint.adapter = CA_ADAPTER_TCP;
-        g_packetReceivedCallback(&svritem->sep, svritem->recvData, svritem->recvDataLen);
-        OIC_LOG_V(DEBUG, TAG, "total received data len:%d", svritem->recvDataLen);
-
-        // initialize data info to receive next message.
-        OICFree(svritem->recvData);
-        svritem->recvData = NULL;
-        svritem->recvDataLen = 0;
-        svritem->totalDataLen = 0;
+        memmove(buf, buf + offset, svritem->recvDataLen);
     }
 
-    return;
+    // #6. grow the buffer for a message larger than it, shrink it back afterwards.
+    size_t bufSize = (totalLen > TCP_RECV_BUFFER_SIZE) ? totalLen : TCP_RECV_BUFFER_SIZE;
+    if (bufSize != svritem->recvBufSize && svritem->recvDataLen <= bufSize)
+    {
+        unsigned char *newBuf = (unsigned char *) OICRealloc(svritem->recvData, bufSize);
+        if (!newBuf)
+        {
+            OIC_LOG(ERROR, TAG, "out of memory");
+            CADisconnectTCPSession(svritem);
+            return;
+        }
+        svritem->recvData = newBuf;
+        svritem->recvBufSize = bufSize;
+    }
 }
 
 static void CAWakeUpForReadFdsUpdate(const char *host)
@@ -501,6 +843,7 @@ static int CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
     }
 
     OIC_LOG(DEBUG, TAG, "connect socket success");
+    CASetNonBlocking(fd);
     CAWakeUpForReadFdsUpdate(svritem->sep.endpoint.addr);
     return fd;
 }
@@ -651,13 +994,6 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
         return res;
     }
 
-    ca_mutex_lock(g_mutexObjectList);
-    if (!caglobals.tcp.svrlist)
-    {
-        caglobals.tcp.svrlist = u_arraylist_create();
-    }
-    ca_mutex_unlock(g_mutexObjectList);
-
     if (caglobals.server)
     {
         NEWSOCKET(AF_INET, ipv4);
@@ -678,6 +1014,10 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     CHECKFD(caglobals.tcp.connectionFds[0]);
     CHECKFD(caglobals.tcp.connectionFds[1]);
 
+#ifdef CA_USE_EPOLL
+    CAInitializeEpoll();
+#endif
+
     caglobals.tcp.terminate = false;
     res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
@@ -719,6 +1059,14 @@ void CATCPStopServer()
     // mutex unlock
     ca_mutex_unlock(g_mutexObjectList);
 
+#ifdef CA_USE_EPOLL
+    if (g_epollFd != -1)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+#endif
+
     if (-1 != caglobals.tcp.ipv4.fd)
     {
         close(caglobals.tcp.ipv4.fd);
@@ -782,12 +1130,214 @@ static size_t CACheckPayloadLength(const void *data, size_t dlen)
     return payloadLen;
 }
 
+static void CAUpdateWriteInterest(CATCPSessionInfo_t *svritem)
+{
+    bool watch = (NULL != svritem->sendHead);
+    if (watch == svritem->writeWatched)
+    {
+        return;
+    }
+    svritem->writeWatched = watch;
+
+#ifdef CA_USE_EPOLL
+    if (g_epollFd != -1)
+    {
+        CAEpollModify(svritem->fd, watch ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+        return;
+    }
+#endif
+    if (watch)
+    {
+        // wake up select() to add the socket to the write set.
+        CAWakeUpForReadFdsUpdate(svritem->sep.endpoint.addr);
+    }
+}
+
+/**
+ * Write as much of the send queue as the socket accepts without blocking.
+ * g_mutexObjectList must be held by the caller.
+ *
+ * @param[in]   svritem     TCP session information.
+ * @return  false if the connection failed.
+ */
+static bool CAFlushSendQueue(CATCPSessionInfo_t *svritem)
+{
+    while (svritem->sendHead)
+    {
+        struct iovec iov[TCP_MAX_SEND_IOV];
+        size_t iovcnt = 0;
+        for (CATCPSendBuffer_t *buf = svritem->sendHead;
+             buf && iovcnt < TCP_MAX_SEND_IOV; buf = buf->next)
+        {
+            iov[iovcnt].iov_base = buf->data + buf->offset;
+            iov[iovcnt].iov_len = buf->len - buf->offset;
+            iovcnt++;
+        }
+
+        // gather write like writev(), but without raising SIGPIPE.
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = iovcnt };
+        ssize_t len = sendmsg(svritem->fd, &msg, MSG_NOSIGNAL);
+        if (-1 == len)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+            {
+                break;
+            }
+            OIC_LOG_V(ERROR, TAG, "sendmsg failed: %s", strerror(errno));
+            return false;
+        }
+
+        svritem->sendQueueLen -= len;
+        while (len > 0)
+        {
+            CATCPSendBuffer_t *buf = svritem->sendHead;
+            size_t remain = buf->len - buf->offset;
+            if ((size_t) len < remain)
+            {
+                buf->offset += len;
+                break;
+            }
+            len -= remain;
+            svritem->sendHead = buf->next;
+            OICFree(buf);
+        }
+        if (!svritem->sendHead)
+        {
+            svritem->sendTail = NULL;
+        }
+    }
+
+    if (svritem->sendBlocked && svritem->sendQueueLen <= caglobals.tcp.sendLowWatermark)
+    {
+        OIC_LOG_V(DEBUG, TAG, "send queue of fd %d is below low watermark", svritem->fd);
+        svritem->sendBlocked = false;
+    }
+
+    CAUpdateWriteInterest(svritem);
+    return true;
+}
+
+static void CAHandleWritable(int fd)
+{
+    ca_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *svritem = NULL;
+    HASH_FIND(fdHh, g_sessionsByFd, &fd, sizeof (fd), svritem);
+    bool connected = !svritem || CAFlushSendQueue(svritem);
+    if (!connected)
+    {
+        // unlink while still locked, so no other thread can reach the session
+        CARemoveTCPSession(svritem);
+    }
+    ca_mutex_unlock(g_mutexObjectList);
+
+    if (!connected)
+    {
+        CACloseTCPSession(svritem);
+    }
+}
+
+/**
+ * Send data to the session without blocking.
+ * If the socket does not accept all of it, the rest is queued and written
+ * by the receive thread once the socket becomes writable.
+ *
+ * @param[in]   svritem     TCP session information.
+ * @param[in]   data        data to send.
+ * @param[in]   dlen        data length.
+ * @return  ::CA_STATUS_OK if the data was sent or queued,
+ *          ::CA_SEND_FAILED if the send queue is above the high watermark
+ *          or the connection failed.
+ */
+static CAResult_t CAQueueSendData(CATCPSessionInfo_t *svritem, const void *data, size_t dlen)
+{
+    ca_mutex_lock(g_mutexObjectList);
+
+    size_t sent = 0;
+    if (!svritem->sendHead)
+    {
+        // nothing pending, try to send directly from the caller's buffer.
+        while (sent < dlen)
+        {
+            ssize_t len = send(svritem->fd, (const char *) data + sent, dlen - sent,
+                               MSG_NOSIGNAL);
+            if (-1 == len)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                if (EAGAIN == errno || EWOULDBLOCK == errno)
+                {
+                    break;
+                }
+                OIC_LOG_V(ERROR, TAG, "send failed: %s", strerror(errno));
+                ca_mutex_unlock(g_mutexObjectList);
+                return CA_SEND_FAILED;
+            }
+            sent += len;
+        }
+
+        if (sent == dlen)
+        {
+            ca_mutex_unlock(g_mutexObjectList);
+            return CA_STATUS_OK;
+        }
+    }
+    else if (svritem->sendBlocked
+             || svritem->sendQueueLen + dlen > caglobals.tcp.sendHighWatermark)
+    {
+        // backpressure: the peer is not draining what is already queued.
+        svritem->sendBlocked = true;
+        OIC_LOG_V(ERROR, TAG, "send queue of fd %d is full (%zu bytes)",
+                  svritem->fd, svritem->sendQueueLen);
+        ca_mutex_unlock(g_mutexObjectList);
+        return CA_SEND_FAILED;
+    }
+
+    // keep the whole message so that errors can report it to the upper layer.
+    CATCPSendBuffer_t *buf = (CATCPSendBuffer_t *) OICMalloc(sizeof (*buf) + dlen);
+    if (!buf)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        ca_mutex_unlock(g_mutexObjectList);
+        return CA_SEND_FAILED;
+    }
+    buf->next = NULL;
+    buf->data = (unsigned char *) (buf + 1);
+    memcpy(buf->data, data, dlen);
+    buf->len = dlen;
+    buf->offset = sent;
+
+    if (svritem->sendTail)
+    {
+        svritem->sendTail->next = buf;
+    }
+    else
+    {
+        svritem->sendHead = buf;
+    }
+    svritem->sendTail = buf;
+    svritem->sendQueueLen += dlen - sent;
+
+    if (svritem->sendQueueLen >= caglobals.tcp.sendHighWatermark)
+    {
+        svritem->sendBlocked = true;
+    }
+    CAUpdateWriteInterest(svritem);
+
+    ca_mutex_unlock(g_mutexObjectList);
+    return CA_STATUS_OK;
+}
+
 static void sendData(const CAEndpoint_t *endpoint, const void *data,
                      size_t dlen, const char *fam)
 {
     // #1. get TCP Server object from list
-    size_t index = 0;
-    CATCPSessionInfo_t *svritem = CAGetTCPSessionInfoFromEndpoint(endpoint, &index);
+    CATCPSessionInfo_t *svritem = CAGetTCPSessionInfoFromEndpoint(endpoint);
     if (!svritem)
     {
         // if there is no connection info, connect to TCP Server
@@ -809,7 +1359,7 @@ static void sendData(const CAEndpoint_t *endpoint, const void *data,
     if (!payloadLen)
     {
         OIC_LOG(DEBUG, TAG, "payload length is zero, disconnect from remote device");
-        CADisconnectTCPSession(svritem, index);
+        CADisconnectTCPSession(svritem);
         return;
     }
 
@@ -818,7 +1368,7 @@ static void sendData(const CAEndpoint_t *endpoint, const void *data,
     {
         // if file descriptor value is wrong, remove TCP Server info from list
         OIC_LOG(ERROR, TAG, "Failed to connect to TCP server");
-        CADisconnectTCPSession(svritem, index);
+        CADisconnectTCPSession(svritem);
         if (g_tcpErrorHandler)
         {
             g_tcpErrorHandler(endpoint, data, dlen, CA_SEND_FAILED);
@@ -826,27 +1376,16 @@ static void sendData(const CAEndpoint_t *endpoint, const void *data,
         return;
     }
 
-    // #4. send data to TCP Server
-    ssize_t remainLen = dlen;
-    do
+    // #4. send data to TCP Server, queueing what the socket does not accept now
+    if (CA_STATUS_OK != CAQueueSendData(svritem, data, dlen))
     {
-        ssize_t len = send(svritem->fd, data, remainLen, 0);
-        if (-1 == len)
+        OIC_LOG_V(ERROR, TAG, "unicast %stcp sendTo failed", fam);
+        if (g_tcpErrorHandler)
         {
-            if (EWOULDBLOCK != errno)
-            {
-                OIC_LOG_V(ERROR, TAG, "unicast ipv4tcp sendTo failed: %s", strerror(errno));
-                if (g_tcpErrorHandler)
-                {
-                    g_tcpErrorHandler(endpoint, data, dlen, CA_SEND_FAILED);
-                }
-                return;
-            }
-            continue;
+            g_tcpErrorHandler(endpoint, data, dlen, CA_SEND_FAILED);
         }
-        data += len;
-        remainLen -= len;
-    } while (remainLen > 0);
+        return;
+    }
 
     OIC_LOG_V(INFO, TAG, "unicast %stcp sendTo is successful: %zu bytes", fam, dlen);
 }
@@ -907,17 +1446,14 @@ CATCPSessionInfo_t *CAConnectTCPSession(const CAEndpoint_t *endpoint)
     // #3. add TCP connection info to list
     svritem->fd = fd;
     ca_mutex_lock(g_mutexObjectList);
-    if (caglobals.tcp.svrlist)
+    bool res = CAAddTCPSession(svritem);
+    if (!res)
     {
-        bool res = u_arraylist_add(caglobals.tcp.svrlist, svritem);
-        if (!res)
-        {
-            OIC_LOG(ERROR, TAG, "u_arraylist_add failed.");
-            close(svritem->fd);
-            OICFree(svritem);
-            ca_mutex_unlock(g_mutexObjectList);
-            return NULL;
-        }
+        OIC_LOG(ERROR, TAG, "CAAddTCPSession failed.");
+        close(svritem->fd);
+        OICFree(svritem);
+        ca_mutex_unlock(g_mutexObjectList);
+        return NULL;
     }
     ca_mutex_unlock(g_mutexObjectList);
 
@@ -932,103 +1468,83 @@ CATCPSessionInfo_t *CAConnectTCPSession(const CAEndpoint_t *endpoint)
     return svritem;
 }
 
-CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem, size_t index)
+CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem)
 {
     VERIFY_NON_NULL(svritem, TAG, "svritem is NULL");
 
+    // remove TCP connection info from the session tables, then close the socket
     ca_mutex_lock(g_mutexObjectList);
-
-    // close the socket and remove TCP connection info in list
-    if (svritem->fd >= 0)
-    {
-        close(svritem->fd);
-    }
-    u_arraylist_remove(caglobals.tcp.svrlist, index);
-    OICFree(svritem->recvData);
-
-    // pass the connection information to CA Common Layer.
-    if (g_connectionCallback)
-    {
-        g_connectionCallback(&(svritem->sep.endpoint), false);
-    }
-
-    OICFree(svritem);
+    CARemoveTCPSession(svritem);
     ca_mutex_unlock(g_mutexObjectList);
 
+    CACloseTCPSession(svritem);
+
     return CA_STATUS_OK;
 }
 
 void CATCPDisconnectAll()
 {
     ca_mutex_lock(g_mutexObjectList);
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
 
     CATCPSessionInfo_t *svritem = NULL;
-    for (size_t i = 0; i < length; i++)
+    CATCPSessionInfo_t *tmp = NULL;
+    HASH_ITER(fdHh, g_sessionsByFd, svritem, tmp)
     {
-        svritem = (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-        if (svritem && svritem->fd >= 0)
+        CARemoveTCPSession(svritem);
+        if (svritem->fd >= 0)
         {
             shutdown(svritem->fd, SHUT_RDWR);
             close(svritem->fd);
-            OICFree(svritem->recvData);
         }
+        CAReleaseSendQueue(NULL, CADetachSendQueue(svritem), false);
+        OICFree(svritem->recvData);
+        OICFree(svritem);
     }
-    u_arraylist_destroy(caglobals.tcp.svrlist);
     ca_mutex_unlock(g_mutexObjectList);
 }
 
-CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint, size_t *index)
+CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint)
 {
     VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint is NULL", NULL);
-    VERIFY_NON_NULL_RET(index, TAG, "index is NULL", NULL);
 
-    // get connection info from list
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-    for (size_t i = 0; i < length; i++)
-    {
-        CATCPSessionInfo_t *svritem = (CATCPSessionInfo_t *) u_arraylist_get(
-                caglobals.tcp.svrlist, i);
-        if (!svritem)
-        {
-            continue;
-        }
+    ca_mutex_lock(g_mutexObjectList);
 
-        if (!strncmp(svritem->sep.endpoint.addr, endpoint->addr,
-                     sizeof(svritem->sep.endpoint.addr))
-                && (svritem->sep.endpoint.port == endpoint->port)
-                && (svritem->sep.endpoint.flags & endpoint->flags))
+    // reuse the key of the previous lookup if the same peer is addressed again
+    if (!g_lastLookupAddr[0] || endpoint->port != g_lastLookupPort
+        || strncmp(endpoint->addr, g_lastLookupAddr, sizeof (g_lastLookupAddr)))
+    {
+        if (!CAConvertNameToKey(endpoint->addr, endpoint->port, &g_lastLookupKey.endpoint))
         {
-            *index = i;
-            return svritem;
+            g_lastLookupAddr[0] = '\0';
+            ca_mutex_unlock(g_mutexObjectList);
+            return NULL;
         }
+        OICStrcpy(g_lastLookupAddr, sizeof (g_lastLookupAddr), endpoint->addr);
+        g_lastLookupPort = endpoint->port;
     }
 
-    return NULL;
+    // get connection info from the endpoint index
+    g_lastLookupKey.flags = endpoint->flags & CA_TCP_SESSION_KEY_FLAGS;
+    CATCPSessionInfo_t *svritem = NULL;
+    HASH_FIND(epHh, g_sessionsByEndpoint, &g_lastLookupKey, sizeof (g_lastLookupKey), svritem);
+    ca_mutex_unlock(g_mutexObjectList);
+
+    if (svritem && !(svritem->sep.endpoint.flags & endpoint->flags))
+    {
+        return NULL;
+    }
+    return svritem;
 }
 
-CATCPSessionInfo_t *CAGetSessionInfoFromFD(int fd, size_t *index)
+CATCPSessionInfo_t *CAGetSessionInfoFromFD(int fd)
 {
-    ca_mutex_lock(g_mutexObjectList);
-
-    // check from the last item.
     CATCPSessionInfo_t *svritem = NULL;
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-    for (size_t i = 0; i < length; i++)
-    {
-        svritem = (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-
-        if (svritem && svritem->fd == fd)
-        {
-            *index = i;
-            ca_mutex_unlock(g_mutexObjectList);
-            return svritem;
-        }
-    }
 
+    ca_mutex_lock(g_mutexObjectList);
+    HASH_FIND(fdHh, g_sessionsByFd, &fd, sizeof (fd), svritem);
     ca_mutex_unlock(g_mutexObjectList);
 
-    return NULL;
+    return svritem;
 }
 
 size_t CAGetTotalLengthFromHeader(const unsigned char *recvBuffer)
@@ -22,6 +22,12 @@
 #include "cainterface.h"
 #include "cautilinterface.h"
 #include "cacommon.h"
+#include "caadapterutils.h"
+#include "caipinterface.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #define CA_TRANSPORT_ADAPTER_SCOPE  1000
 
@@ -508,3 +514,167 @@ CAResult_t checkGetNetworkInfo()
         return CA_STATUS_FAILED;
     }
 }
+
+TEST(CAAdapterUtilsTest, EndpointKeyMatchesSockaddr)
+{
+    struct sockaddr_storage ss;
+    CAConvertNameToAddr("fe80::1:2", 5683, &ss);
+    EXPECT_EQ(AF_INET6, ss.ss_family);
+
+    char addr[MAX_ADDR_STR_SIZE_CA] = { 0 };
+    uint16_t port = 0;
+    CAConvertAddrToName(&ss, sizeof (struct sockaddr_in6), addr, &port);
+    EXPECT_STREQ("fe80::1:2", addr);
+    EXPECT_EQ(5683, port);
+
+    CAEndpointKey_t fromAddr;
+    CAEndpointKey_t fromName;
+    CAConvertAddrToKey(&ss, &fromAddr);
+    EXPECT_TRUE(CAConvertNameToKey(addr, port, &fromName));
+    EXPECT_EQ(0, memcmp(&fromAddr, &fromName, sizeof (fromAddr)));
+
+    EXPECT_TRUE(CAConvertNameToKey("192.168.0.1", 5683, &fromName));
+    EXPECT_NE(0, memcmp(&fromAddr, &fromName, sizeof (fromAddr)));
+    CAConvertKeyToName(&fromName, addr, &port);
+    EXPECT_STREQ("192.168.0.1", addr);
+
+    EXPECT_TRUE(CAConvertNameToKey("fe80::1%7", 5683, &fromName));
+    EXPECT_EQ(7u, fromName.scope);
+    EXPECT_FALSE(CAConvertNameToKey("not-an-address", 5683, &fromName));
+}
+
+#ifdef CA_USE_SENDMMSG
+// Datagrams queued with CAIPQueueSendData() are sent on the unicast IPv4 socket of the IP
+// adapter; the tests swap in a loopback socket and read the flushed datagrams back.
+class CAIPSendBatchTest : public testing::Test {
+    protected:
+    virtual void SetUp() {
+        m_savedFd = caglobals.ip.u4.fd;
+        m_savedIpv4 = caglobals.ip.ipv4enabled;
+        m_savedIpv6 = caglobals.ip.ipv6enabled;
+        caglobals.ip.u4.fd = openLoopback(NULL);
+        caglobals.ip.ipv4enabled = true;
+        caglobals.ip.ipv6enabled = false;
+        ASSERT_NE(-1, caglobals.ip.u4.fd);
+    }
+
+    virtual void TearDown() {
+        close(caglobals.ip.u4.fd);
+        caglobals.ip.u4.fd = m_savedFd;
+        caglobals.ip.ipv4enabled = m_savedIpv4;
+        caglobals.ip.ipv6enabled = m_savedIpv6;
+    }
+
+    static int openLoopback(uint16_t *port) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (-1 == fd)
+        {
+            return -1;
+        }
+        struct sockaddr_in sa;
+        memset(&sa, 0, sizeof (sa));
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof (sa);
+        struct timeval tv = { 1, 0 };
+        if (bind(fd, (struct sockaddr *)&sa, sizeof (sa))
+            || getsockname(fd, (struct sockaddr *)&sa, &len)
+            || setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof (tv)))
+        {
+            close(fd);
+            return -1;
+        }
+        if (port)
+        {
+            *port = ntohs(sa.sin_port);
+        }
+        return fd;
+    }
+
+    // Queues datagram number 'seq' of 'len' bytes; every byte carries the number.
+    void queue(CAEndpoint_t *endpoint, uint8_t seq, uint32_t len) {
+        m_data[seq].assign(len, seq);
+        CAIPQueueSendData(endpoint, m_data[seq].data(), len, false);
+    }
+
+    // Expects the next datagram on 'fd' to be exactly datagram number 'seq'.
+    void expectReceived(int fd, uint8_t seq) {
+        uint8_t buf[2048];
+        ssize_t len = recv(fd, buf, sizeof (buf), 0);
+        ASSERT_EQ((ssize_t)m_data[seq].size(), len) << "datagram " << (int)seq;
+        EXPECT_EQ(0, memcmp(buf, m_data[seq].data(), len)) << "datagram " << (int)seq;
+    }
+
+    static void expectNothingLeft(int fd) {
+        uint8_t buf[2048];
+        EXPECT_EQ(-1, recv(fd, buf, sizeof (buf), MSG_DONTWAIT));
+    }
+
+    std::string m_data[64];
+    int m_savedFd;
+    bool m_savedIpv4;
+    bool m_savedIpv6;
+};
+
+// a burst to one peer (GSO segments, last one shorter, more than one sendmmsg batch)
+TEST_F(CAIPSendBatchTest, SameDestinationBurstKeepsBoundariesAndOrder)
+{
+    uint16_t port = 0;
+    int peer = openLoopback(&port);
+    ASSERT_NE(-1, peer);
+
+    CAEndpoint_t endpoint = { CA_ADAPTER_IP, CA_IPV4, port, "127.0.0.1", 0 };
+    const uint8_t count = 40;
+    for (uint8_t i = 0; i < count - 1; i++)
+    {
+        queue(&endpoint, i, 512);
+    }
+    queue(&endpoint, count - 1, 100);
+    CAIPFlushSendData();
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        expectReceived(peer, i);
+    }
+    expectNothingLeft(peer);
+    close(peer);
+}
+
+// interleaved peers and sizes must not be merged into the wrong message
+TEST_F(CAIPSendBatchTest, MixedDestinationBurstKeepsBoundariesAndOrder)
+{
+    uint16_t portA = 0;
+    uint16_t portB = 0;
+    int peerA = openLoopback(&portA);
+    int peerB = openLoopback(&portB);
+    ASSERT_NE(-1, peerA);
+    ASSERT_NE(-1, peerB);
+
+    CAEndpoint_t endpointA = { CA_ADAPTER_IP, CA_IPV4, portA, "127.0.0.1", 0 };
+    CAEndpoint_t endpointB = { CA_ADAPTER_IP, CA_IPV4, portB, "127.0.0.1", 0 };
+    queue(&endpointA, 0, 64);
+    queue(&endpointA, 1, 64);
+    queue(&endpointB, 2, 64);
+    queue(&endpointA, 3, 64);
+    queue(&endpointA, 4, 200);
+    queue(&endpointA, 5, 64);
+    queue(&endpointB, 6, 10);
+    queue(&endpointB, 7, 300);
+    CAIPFlushSendData();
+
+    expectReceived(peerA, 0);
+    expectReceived(peerA, 1);
+    expectReceived(peerA, 3);
+    expectReceived(peerA, 4);
+    expectReceived(peerA, 5);
+    expectNothingLeft(peerA);
+
+    expectReceived(peerB, 2);
+    expectReceived(peerB, 6);
+    expectReceived(peerB, 7);
+    expectNothingLeft(peerB);
+
+    close(peerA);
+    close(peerB);
+}
+#endif // CA_USE_SENDMMSG
@@ -136,6 +136,49 @@ TEST_F(CABlockTransferTests, CAGetBlockDataFromBlockDataListTest)
     free(requestData.payload);
 }
 
+// a transfer with an ID already in use is refused; the existing one stays valid
+TEST_F(CABlockTransferTests, CACreateNewBlockDataDuplicateIdTest)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    coap_list_t *options = NULL;
+    coap_transport_type transport = coap_udp;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_GET, &requestData, tempRep, &options, &transport);
+
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    EXPECT_TRUE(cadata != NULL);
+
+    CABlockData_t *currData = CACreateNewBlockData(cadata);
+    EXPECT_TRUE(currData != NULL);
+
+    if (currData)
+    {
+        EXPECT_TRUE(NULL == CACreateNewBlockData(cadata));
+        EXPECT_EQ(currData, CAGetBlockDataFromBlockDataList(currData->blockDataId));
+
+        CARemoveBlockDataFromList(currData->blockDataId);
+    }
+
+    CADestroyDataSet(cadata);
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
 TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
 {
     CAEndpoint_t* tempRep = NULL;
@@ -540,3 +583,365 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2Test)
     CADestroyEndpoint(tempRep);
     free(requestData.payload);
 }
+
+static size_t g_sinkLength = 0;
+static size_t g_sinkLimit = SIZE_MAX;
+
+static bool blockDataSink(const CAEndpoint_t *, const CAToken_t, uint8_t,
+                          size_t offset, const uint8_t *, size_t dataLength)
+{
+    EXPECT_EQ(g_sinkLength, offset);
+    if (offset >= g_sinkLimit)
+    {
+        return false;
+    }
+    g_sinkLength += dataLength;
+    return true;
+}
+
+TEST_F(CABlockTransferTests, CAUpdatePayloadDataTest)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    coap_list_t *options = NULL;
+    coap_transport_type transport = coap_udp;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_POST, &requestData, tempRep, &options, &transport);
+
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    EXPECT_TRUE(cadata != NULL);
+
+    CABlockData_t *currData = CACreateNewBlockData(cadata);
+    ASSERT_TRUE(currData != NULL);
+
+    char block[LARGE_PAYLOAD_LENGTH];
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+    requestInfo.method = CA_POST;
+    requestInfo.info.payload = (CAPayload_t) block;
+    requestInfo.info.payloadSize = sizeof(block);
+
+    CAData_t receivedData;
+    memset(&receivedData, 0, sizeof(CAData_t));
+    receivedData.requestInfo = &requestInfo;
+    receivedData.dataType = CA_REQUEST_DATA;
+
+    // the size option preallocates the whole payload
+    currData->payloadLength = 3 * sizeof(block);
+    for (int i = 0; i < 3; i++)
+    {
+        memset(block, '0' + i, sizeof(block));
+        EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &receivedData,
+                                                    CA_BLOCK_UNKNOWN, true,
+                                                    COAP_OPTION_BLOCK1));
+        EXPECT_EQ(3 * sizeof(block), currData->payloadCapacity);
+    }
+
+    size_t fullPayload = 0;
+    CAPayload_t payload = CAGetPayloadFromBlockDataList(currData->blockDataId,
+                                                        &fullPayload);
+    ASSERT_TRUE(payload != NULL);
+    EXPECT_EQ(3 * sizeof(block), fullPayload);
+    EXPECT_EQ('0', payload[0]);
+    EXPECT_EQ('1', payload[sizeof(block)]);
+    EXPECT_EQ('2', payload[fullPayload - 1]);
+
+    CARemoveBlockDataFromList(currData->blockDataId);
+
+    // a transfer accepted by the sink isn't buffered
+    CARegisterBlockDataSink(blockDataSink);
+    g_sinkLength = 0;
+
+    currData = CACreateNewBlockData(cadata);
+    ASSERT_TRUE(currData != NULL);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &receivedData,
+                                                    CA_BLOCK_UNKNOWN, false,
+                                                    COAP_OPTION_BLOCK1));
+    }
+    EXPECT_TRUE(currData->streamed);
+    EXPECT_TRUE(currData->payload == NULL);
+    EXPECT_EQ(3 * sizeof(block), g_sinkLength);
+    EXPECT_EQ(3 * sizeof(block), currData->receivedPayloadLen);
+    CARemoveBlockDataFromList(currData->blockDataId);
+
+    // a later block refused by the sink fails the transfer
+    g_sinkLength = 0;
+    g_sinkLimit = sizeof(block);
+
+    currData = CACreateNewBlockData(cadata);
+    ASSERT_TRUE(currData != NULL);
+    EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &receivedData, CA_BLOCK_UNKNOWN,
+                                                false, COAP_OPTION_BLOCK1));
+    EXPECT_NE(CA_STATUS_OK, CAUpdatePayloadData(currData, &receivedData, CA_BLOCK_UNKNOWN,
+                                                false, COAP_OPTION_BLOCK1));
+    EXPECT_EQ(sizeof(block), currData->receivedPayloadLen);
+    g_sinkLimit = SIZE_MAX;
+
+    CARegisterBlockDataSink(NULL);
+    CARemoveBlockDataFromList(currData->blockDataId);
+    CADestroyDataSet(cadata);
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, CASetNextBlockOption1WindowTest)
+{
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CASetBlockWiseWindowSize(0));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CASetBlockWiseWindowSize(CA_MAX_BLOCK_WINDOW_SIZE + 1));
+    EXPECT_EQ(CA_STATUS_OK, CASetBlockWiseWindowSize(4));
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    coap_list_t *options = NULL;
+    coap_transport_type transport = coap_udp;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_POST, &requestData, tempRep, &options, &transport);
+    ASSERT_TRUE(pdu != NULL);
+
+    char block[LARGE_PAYLOAD_LENGTH];
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+    requestInfo.method = CA_POST;
+    requestInfo.info.payload = (CAPayload_t) block;
+
+    CAData_t receivedData;
+    memset(&receivedData, 0, sizeof(CAData_t));
+    receivedData.requestInfo = &requestInfo;
+    receivedData.dataType = CA_REQUEST_DATA;
+
+    // blocks 2 and 3 arrive ahead of block 1 and are kept until it fills the gap
+    const unsigned int order[] = { 0, 2, 2, 3, 1 };
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        unsigned int num = order[i];
+        coap_block_t blockOption = { num, num < 3, CA_BLOCK_SIZE_1024_BYTE };
+        memset(block, '0' + num, sizeof(block));
+        requestInfo.info.payloadSize = (num < 3) ? sizeof(block) : sizeof(block) / 2;
+        EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption1(pdu, tempRep, &receivedData,
+                                                      blockOption, pdu->length));
+    }
+
+    CABlockDataID_t *blockID = CACreateBlockDatablockId(tempToken, CA_MAX_TOKEN_LEN,
+                                                        tempRep->port);
+    ASSERT_TRUE(blockID != NULL);
+
+    CABlockData_t *currData = CAGetBlockDataFromBlockDataList(blockID);
+    ASSERT_TRUE(currData != NULL);
+    EXPECT_EQ(3 * sizeof(block) + sizeof(block) / 2, currData->receivedPayloadLen);
+    EXPECT_EQ(0u, currData->blocksAhead);
+    EXPECT_EQ(3u, currData->block1.num);
+    EXPECT_EQ(0u, currData->block1.m);
+
+    size_t fullPayload = 0;
+    CAPayload_t payload = CAGetPayloadFromBlockDataList(blockID, &fullPayload);
+    ASSERT_TRUE(payload != NULL);
+    EXPECT_EQ('0', payload[0]);
+    EXPECT_EQ('1', payload[sizeof(block)]);
+    EXPECT_EQ('2', payload[2 * sizeof(block)]);
+    EXPECT_EQ('3', payload[fullPayload - 1]);
+
+    CARemoveBlockDataFromList(blockID);
+    CADestroyBlockID(blockID);
+    EXPECT_EQ(CA_STATUS_OK, CASetBlockWiseWindowSize(1));
+
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, CASetNextBlockOption2WindowGapTest)
+{
+    EXPECT_EQ(CA_STATUS_OK, CASetBlockWiseWindowSize(4));
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_list_t *options = NULL;
+    coap_transport_type transport = coap_udp;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t responseData;
+    memset(&responseData, 0, sizeof(CAInfo_t));
+    responseData.token = tempToken;
+    responseData.tokenLength = CA_MAX_TOKEN_LEN;
+    responseData.type = CA_MSG_NONCONFIRM;
+
+    // the first block carries the total size, which the window needs
+    const size_t totalLength = 4 * LARGE_PAYLOAD_LENGTH + LARGE_PAYLOAD_LENGTH / 2;
+    coap_pdu_t *firstPdu = CAGeneratePDU(CA_CONTENT, &responseData, tempRep, &options,
+                                         &transport);
+    ASSERT_TRUE(firstPdu != NULL);
+    unsigned char size2[4];
+    unsigned int size2Len = coap_encode_var_bytes(size2, totalLength);
+    coap_add_option(firstPdu, COAP_OPTION_SIZE2, size2Len, size2, coap_udp);
+    coap_pdu_t *pdu = CAGeneratePDU(CA_CONTENT, &responseData, tempRep, &options, &transport);
+    ASSERT_TRUE(pdu != NULL);
+
+    char block[LARGE_PAYLOAD_LENGTH];
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info.payload = (CAPayload_t) block;
+
+    CAData_t receivedData;
+    memset(&receivedData, 0, sizeof(CAData_t));
+    receivedData.responseInfo = &responseInfo;
+    receivedData.dataType = CA_RESPONSE_DATA;
+
+    CABlockDataID_t *blockID = CACreateBlockDatablockId(tempToken, CA_MAX_TOKEN_LEN,
+                                                        tempRep->port);
+    ASSERT_TRUE(blockID != NULL);
+
+    // block 1 is lost; blocks 2 and 3 overtake it, but it is asked for again only once
+    const unsigned int order[] = { 0, 2, 3 };
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        unsigned int num = order[i];
+        coap_block_t blockOption = { num, 1, CA_BLOCK_SIZE_1024_BYTE };
+        memset(block, '0' + num, sizeof(block));
+        responseInfo.info.payloadSize = sizeof(block);
+        EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(num ? pdu : firstPdu, tempRep,
+                                                      &receivedData, blockOption, 0));
+
+        CABlockData_t *currData = CAGetBlockDataFromBlockDataList(blockID);
+        ASSERT_TRUE(currData != NULL);
+        EXPECT_TRUE(currData->windowed);
+        EXPECT_EQ(1u, currData->windowBase);
+        EXPECT_EQ(5u, currData->nextBlockNum);
+        EXPECT_EQ(num ? 1u : UINT32_MAX, currData->resentBase);
+    }
+
+    // block 1 fills the gap and the window moves past the blocks kept ahead of it
+    coap_block_t blockOption = { 1, 1, CA_BLOCK_SIZE_1024_BYTE };
+    memset(block, '1', sizeof(block));
+    EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(pdu, tempRep, &receivedData,
+                                                  blockOption, 0));
+
+    CABlockData_t *currData = CAGetBlockDataFromBlockDataList(blockID);
+    ASSERT_TRUE(currData != NULL);
+    EXPECT_EQ(4u, currData->windowBase);
+    EXPECT_EQ(0u, currData->blocksAhead);
+    EXPECT_EQ(4 * sizeof(block), currData->receivedPayloadLen);
+
+    size_t fullPayload = 0;
+    CAPayload_t payload = CAGetPayloadFromBlockDataList(blockID, &fullPayload);
+    ASSERT_TRUE(payload != NULL);
+    EXPECT_EQ('0', payload[0]);
+    EXPECT_EQ('1', payload[sizeof(block)]);
+    EXPECT_EQ('2', payload[2 * sizeof(block)]);
+    EXPECT_EQ('3', payload[3 * sizeof(block)]);
+
+    CARemoveBlockDataFromList(blockID);
+    CADestroyBlockID(blockID);
+    EXPECT_EQ(CA_STATUS_OK, CASetBlockWiseWindowSize(1));
+
+    coap_delete_list(options);
+    coap_delete_pdu(firstPdu);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, CASetNextBlockOption1WindowDuplicateTest)
+{
+    EXPECT_EQ(CA_STATUS_OK, CASetBlockWiseWindowSize(4));
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    coap_list_t *options = NULL;
+    coap_transport_type transport = coap_udp;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_POST, &requestData, tempRep, &options, &transport);
+    ASSERT_TRUE(pdu != NULL);
+
+    char block[LARGE_PAYLOAD_LENGTH];
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+    requestInfo.method = CA_POST;
+    requestInfo.info.payload = (CAPayload_t) block;
+    requestInfo.info.payloadSize = sizeof(block);
+
+    CAData_t receivedData;
+    memset(&receivedData, 0, sizeof(CAData_t));
+    receivedData.requestInfo = &requestInfo;
+    receivedData.dataType = CA_REQUEST_DATA;
+
+    // block 1 is resent after its acknowledgement was lost; it is acked again, not appended
+    const unsigned int order[] = { 0, 1, 2, 1 };
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        unsigned int num = order[i];
+        coap_block_t blockOption = { num, 1, CA_BLOCK_SIZE_1024_BYTE };
+        memset(block, '0' + num, sizeof(block));
+        EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption1(pdu, tempRep, &receivedData,
+                                                      blockOption, pdu->length));
+    }
+
+    CABlockDataID_t *blockID = CACreateBlockDatablockId(tempToken, CA_MAX_TOKEN_LEN,
+                                                        tempRep->port);
+    ASSERT_TRUE(blockID != NULL);
+
+    CABlockData_t *currData = CAGetBlockDataFromBlockDataList(blockID);
+    ASSERT_TRUE(currData != NULL);
+    EXPECT_EQ(3 * sizeof(block), currData->receivedPayloadLen);
+    EXPECT_EQ(0u, currData->blocksAhead);
+
+    size_t fullPayload = 0;
+    CAPayload_t payload = CAGetPayloadFromBlockDataList(blockID, &fullPayload);
+    ASSERT_TRUE(payload != NULL);
+    EXPECT_EQ('1', payload[sizeof(block)]);
+    EXPECT_EQ('2', payload[fullPayload - 1]);
+
+    CARemoveBlockDataFromList(blockID);
+    CADestroyBlockID(blockID);
+    EXPECT_EQ(CA_STATUS_OK, CASetBlockWiseWindowSize(1));
+
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
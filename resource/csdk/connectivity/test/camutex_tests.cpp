@@ -37,6 +37,8 @@
 
 #include <camutex.h>
 #include <cathreadpool.h>
+#include <caqueueingthread.h>
+#include <oic_malloc.h>
 
 #include <time.h>
 #include <sys/time.h>
@@ -528,3 +530,135 @@ TEST(ConditionTests, TC_07_WAITDURATION)
 
     ca_cond_free(sharedCond);
 }
+
+static bool queueingMatchOdd(void *data, uint32_t /*size*/, void * /*context*/)
+{
+    return (*(int *) data) % 2;
+}
+
+TEST(QueueingThreadTests, TC_01_ORDER_AND_REMOVE)
+{
+    // more data than ring slots, part of it goes to the overflow list.
+    const int DATA_COUNT = 1000;
+
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+    CAQueueingThread_t thread;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitialize(&thread, pool, NULL, NULL));
+
+    for (int i = 0; i < DATA_COUNT; i++)
+    {
+        int *data = (int *) OICMalloc(sizeof(int));
+        ASSERT_TRUE(NULL != data);
+        *data = i;
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&thread, data, sizeof(int)));
+    }
+    EXPECT_EQ((uint32_t) DATA_COUNT, CAQueueingThreadGetSize(&thread));
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadRemoveData(&thread, queueingMatchOdd, NULL));
+    EXPECT_EQ((uint32_t) DATA_COUNT / 2, CAQueueingThreadGetSize(&thread));
+
+    void *data = NULL;
+    uint32_t size = 0;
+    for (int i = 0; i < DATA_COUNT; i += 2)
+    {
+        ASSERT_TRUE(CAQueueingThreadGetData(&thread, &data, &size));
+        EXPECT_EQ(sizeof(int), size);
+        EXPECT_EQ(i, *(int *) data);
+        OICFree(data);
+    }
+    EXPECT_FALSE(CAQueueingThreadGetData(&thread, &data, &size));
+
+    CAQueueingThreadStats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&thread, &stats));
+    EXPECT_EQ((uint64_t) DATA_COUNT, stats.enqueued);
+    EXPECT_EQ((uint64_t) DATA_COUNT, stats.dequeued);
+    EXPECT_EQ(0u, stats.depth);
+    EXPECT_EQ((uint32_t) DATA_COUNT, stats.maxDepth);
+    EXPECT_LT(0u, stats.overflowed);
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&thread));
+    ca_thread_pool_free(pool);
+}
+
+TEST(QueueingThreadTests, TC_02_WAIT_AND_WAKEUP)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+    CAQueueingThread_t thread;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitialize(&thread, pool, NULL, NULL));
+
+    // empty queue, the wait times out.
+    uint64_t beg = getAbsTime();
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWaitData(&thread, 100 * USECS_PER_MSEC));
+    EXPECT_LE(90 * USECS_PER_MSEC, getAbsTime() - beg);
+
+    // a pending wakeup or queued data return at once.
+    CAQueueingThreadWakeup(&thread);
+    beg = getAbsTime();
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWaitData(&thread, USECS_PER_SEC));
+    EXPECT_GT(500 * USECS_PER_MSEC, getAbsTime() - beg);
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&thread, OICMalloc(1), 1));
+    beg = getAbsTime();
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadWaitData(&thread, USECS_PER_SEC));
+    EXPECT_GT(500 * USECS_PER_MSEC, getAbsTime() - beg);
+
+    // remaining data is released by destroy.
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&thread));
+    ca_thread_pool_free(pool);
+}
+
+static int queueingProcessed = 0;
+static int queueingBatchEnds = 0;
+static int queueingPending = 0;
+
+static void queueingTask(void *data)
+{
+    (void)data;
+    queueingProcessed++;
+    queueingPending++;
+}
+
+static void queueingBatchEnd()
+{
+    // the data of the batch is still queued for destroy.
+    queueingBatchEnds++;
+    queueingPending = 0;
+}
+
+TEST(QueueingThreadTests, TC_03_BATCH_END)
+{
+    const int DATA_COUNT = 100;
+
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+    CAQueueingThread_t thread;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitialize(&thread, pool, queueingTask, NULL));
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadSetBatchEndTask(&thread, queueingBatchEnd));
+
+    for (int i = 0; i < DATA_COUNT; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&thread, OICMalloc(1), 1));
+    }
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&thread));
+
+    for (int i = 0; i < 100 && CAQueueingThreadGetSize(&thread) > 0; i++)
+    {
+        usleep(MINIMAL_LOOP_SLEEP * USECS_PER_MSEC);
+    }
+    usleep(MINIMAL_EXTRA_SLEEP * USECS_PER_MSEC);
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadStop(&thread));
+    EXPECT_EQ(DATA_COUNT, queueingProcessed);
+    EXPECT_EQ(0, queueingPending);
+    // data queued before the start is handled in batches.
+    EXPECT_GT(DATA_COUNT, queueingBatchEnds);
+    EXPECT_LT(0, queueingBatchEnds);
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&thread));
+    ca_thread_pool_free(pool);
+}
@@ -19,10 +19,15 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "gtest/gtest.h"
 
 #include "caprotocolmessage.h"
+#include "caretransmission.h"
+#include "oic_malloc.h"
 
 namespace {
 
@@ -186,3 +191,84 @@ TEST(CAProtocolMessage, CAParseURILongPath)
     verifyParsedOptions(cases, numCases, optlist);
     coap_delete_list(optlist);
 }
+
+// CON GET with message id 0x1234, and the matching empty ACK.
+static const uint8_t RETRANSMISSION_CON_PDU[] = { 0x40, 0x01, 0x12, 0x34 };
+static const uint8_t RETRANSMISSION_ACK_PDU[] = { 0x60, 0x00, 0x12, 0x34 };
+
+TEST(CARetransmission, AckRemovesSentData)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+    CARetransmission_t context;
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, pool, NULL, NULL, NULL));
+
+    CAEndpoint_t endpoint = { CA_ADAPTER_IP, CA_IPV4, 5683, "127.0.0.1", 0 };
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionSentData(&context, &endpoint,
+              RETRANSMISSION_CON_PDU, sizeof (RETRANSMISSION_CON_PDU)));
+    EXPECT_EQ(1u, context.dataCount);
+
+    // the same message id is refused while it is outstanding.
+    EXPECT_EQ(CA_STATUS_FAILED, CARetransmissionSentData(&context, &endpoint,
+              RETRANSMISSION_CON_PDU, sizeof (RETRANSMISSION_CON_PDU)));
+    EXPECT_EQ(1u, context.dataCount);
+
+    void *retransmissionPdu = NULL;
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionReceivedData(&context, &endpoint,
+              RETRANSMISSION_ACK_PDU, sizeof (RETRANSMISSION_ACK_PDU), &retransmissionPdu));
+    EXPECT_EQ(0u, context.dataCount);
+    ASSERT_TRUE(retransmissionPdu != NULL);
+    EXPECT_EQ(0, memcmp(retransmissionPdu, RETRANSMISSION_CON_PDU,
+                        sizeof (RETRANSMISSION_CON_PDU)));
+    OICFree(retransmissionPdu);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+    ca_thread_pool_free(pool);
+}
+
+static int g_retransmissionSendCount = 0;
+static int g_retransmissionTimeoutCount = 0;
+
+static CAResult_t retransmissionSend(const CAEndpoint_t *, const void *, uint32_t)
+{
+    g_retransmissionSendCount++;
+    return CA_STATUS_OK;
+}
+
+static void retransmissionTimeout(const CAEndpoint_t *, const void *, uint32_t)
+{
+    g_retransmissionTimeoutCount++;
+}
+
+TEST(CARetransmission, RetransmitsAtTimeout)
+{
+    ca_thread_pool_t pool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+    g_retransmissionSendCount = 0;
+    g_retransmissionTimeoutCount = 0;
+
+    CARetransmission_t context;
+    CARetransmissionConfig_t config = { CA_ADAPTER_IP, 1 };
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, pool, retransmissionSend,
+                                                       retransmissionTimeout, &config));
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionStart(&context));
+
+    CAEndpoint_t endpoint = { CA_ADAPTER_IP, CA_IPV4, 5683, "127.0.0.1", 0 };
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionSentData(&context, &endpoint,
+              RETRANSMISSION_CON_PDU, sizeof (RETRANSMISSION_CON_PDU)));
+
+    // the first timeout is between DEFAULT_ACK_TIMEOUT_SEC and 1.5 times that.
+    for (int i = 0; i < 40 && 0 == g_retransmissionTimeoutCount; i++)
+    {
+        usleep(100 * 1000);
+    }
+    EXPECT_EQ(1, g_retransmissionSendCount);
+    EXPECT_EQ(1, g_retransmissionTimeoutCount);
+    EXPECT_EQ(0u, context.dataCount);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionStop(&context));
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+    ca_thread_pool_free(pool);
+}
@@ -35,6 +35,7 @@
 
 #include "ocresource.h"
 #include "cacommon.h"
+#include "uthash.h"
 
 /**
  * Data structure For presence Discovery.
@@ -128,10 +129,31 @@ typedef struct ClientCB {
 
     /** next node in this list.*/
     struct ClientCB    *next;
+
+    /** previous node in this list.*/
+    struct ClientCB    *prev;
+
+    /** address of this node, key of the node table.*/
+    struct ClientCB    *self;
+
+    /** position in the timeout heap, valid while TTL is not 0.*/
+    size_t timeoutIndex;
+
+    /** handle in the token table.*/
+    UT_hash_handle tokenHh;
+
+    /** handle in the invocation handle table.*/
+    UT_hash_handle handleHh;
+
+    /** handle in the request uri table.*/
+    UT_hash_handle uriHh;
+
+    /** handle in the node table.*/
+    UT_hash_handle nodeHh;
 } ClientCB;
 
 /**
- * Linked list of ClientCB node.
+ * Doubly linked list of ClientCB node.
  */
 extern struct ClientCB *cbList;
 
@@ -180,6 +202,7 @@ void DeleteClientCB(ClientCB *cbNode);
  * @param[in] requestUri   Uri to search for.
  *
  * @brief You can search by token OR by handle, but not both.
+ * If several callbacks share the request uri, the most recently added one is returned.
  *
  * @return address of the node if found, otherwise NULL
  */
@@ -202,6 +225,29 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
 OCStackResult InsertResourceTypeFilter(ClientCB * cbNode, char * resourceTypeName);
 #endif // WITH_PRESENCE
 
+/** @ingroup ocstack
+ *
+ * This method is used to change the time to live of a cb node.
+ *
+ * @param[in] cbNode    Address to client callback node.
+ * @param[in] ttl       time to live in coap_ticks for the callback, 0 if it never times out.
+ */
+void SetClientCBTimeout(ClientCB *cbNode, uint32_t ttl);
+
+/** @ingroup ocstack
+ *
+ * This method is used to delete the cb nodes whose time to live has passed.
+ */
+void DeleteTimedOutClientCBs();
+
+/** @ingroup ocstack
+ *
+ * This method is used to get the earliest time to live of the cb nodes.
+ *
+ * @return time to live in coap_ticks, 0 if no cb node times out.
+ */
+uint32_t GetNextClientCBTimeout();
+
 /** @ingroup ocstack
  *
  * This method is used to clear the cbList.
@@ -29,6 +29,8 @@
 #ifndef OC_OBSERVE_H
 #define OC_OBSERVE_H
 
+#include "uthash.h"
+
 /** Sequence number is a 24 bit field, per https://tools.ietf.org/html/draft-ietf-core-observe-16.*/
 #define MAX_SEQUENCE_NUMBER              (0xFFFFFF)
 
@@ -77,9 +79,18 @@ typedef struct ResourceObserver
     /** force the qos value to CON.*/
     uint8_t forceHighQos;
 
-    /** next node in this list.*/
+    /** next observer of the same resource.*/
     struct ResourceObserver *next;
 
+    /** previous observer of the same resource.*/
+    struct ResourceObserver *prev;
+
+    /** handle in the token table.*/
+    UT_hash_handle tokenHh;
+
+    /** handle in the observation id table.*/
+    UT_hash_handle idHh;
+
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
@@ -131,11 +142,29 @@ OCStackResult SendListObserverNotification (OCResource * resource,
         const OCRepPayload *payload, uint32_t maxAge,
         OCQualityOfService qos);
 
+/**
+ * Decide the quality of service of the next notification sent to an observer.
+ *
+ * @param observer        Observer to notify.
+ * @param qos             Quality of service requested for the notification.
+ *
+ * @return The quality of service of the notification.
+ */
+OCQualityOfService GetObserverNotificationQoS (ResourceObserver *observer,
+        OCQualityOfService qos);
+
 /**
  * Delete all observers in the observe list.
  */
 void DeleteObserverList();
 
+/**
+ * Delete all observers of a resource.
+ *
+ * @param resource        Resource whose observers are removed.
+ */
+void DeleteObserversUsingResource (OCResource *resource);
+
 /**
  * Create a unique observation ID.
  *
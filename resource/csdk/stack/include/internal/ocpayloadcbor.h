@@ -30,8 +30,37 @@ extern "C"
 OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType type,
         const uint8_t* payload, size_t payloadSize);
 
+/**
+ * Same as OCParsePayload, except that representation values are left in a copy of the
+ * CBOR buffer and decoded when first looked up.  Other payload types are parsed eagerly.
+ */
+OCStackResult OCParsePayloadLazy(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize);
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size);
 
+/**
+ * Decodes the value called name from the lazy part of the payload and caches it in
+ * payload->values.
+ *
+ * @return The decoded value, or NULL if the CBOR does not hold one by that name.
+ */
+OCRepPayloadValue* OCRepPayloadLazyFindValue(OCRepPayload* payload, const char* name);
+
+/**
+ * Points value at the text or byte string called name inside the CBOR buffer, without
+ * decoding or copying it.
+ *
+ * @return false if there is no such string, or it is not stored contiguously.
+ */
+bool OCRepPayloadLazyGetStringView(const OCRepPayload* payload, const char* name,
+        OCRepPayloadPropType type, const uint8_t** value, size_t* len);
+
+/** Shares the CBOR buffer of lazy with a clone of its payload.*/
+OCRepPayloadLazyValues* OCRepPayloadLazyClone(const OCRepPayloadLazyValues* lazy);
+
+void OCRepPayloadLazyDestroy(OCRepPayloadLazyValues* lazy);
+
 #ifdef __cplusplus
 }
 #endif
@@ -240,6 +240,9 @@ typedef struct OCResource {
 
     /** Pointer of ActionSet which to support group action.*/
     OCActionSet *actionsetHead;
+
+    /** Observers of this resource; doubly linked list.*/
+    struct ResourceObserver *observersHead;
 } OCResource;
 
 
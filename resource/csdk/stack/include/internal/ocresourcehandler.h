@@ -116,6 +116,30 @@ OCEntityHandlerResult defaultResourceEHandler(OCEntityHandlerFlag flag,
  */
 OCResource *FindResourceByUri(const char* resourceUri);
 
+/**
+ * Check a resource handle still refers to a registered resource.
+ * @return pointer to found resource, NULL if it has been deleted
+ */
+OCResource *FindResourceByHandle(OCResourceHandle handle);
+
+/**
+ * Find the resources bound to a resource type.
+ *
+ * @param resourceTypeName Resource type name.
+ * @param numResources Number of resources found.
+ * @return Resources in binding order, owned by the stack, or NULL if none are bound.
+ */
+OCResource **FindResourcesByType(const char *resourceTypeName, size_t *numResources);
+
+/**
+ * Find the resources bound to a resource interface.
+ *
+ * @param interfaceName Resource interface name.
+ * @param numResources Number of resources found.
+ * @return Resources in binding order, owned by the stack, or NULL if none are bound.
+ */
+OCResource **FindResourcesByInterface(const char *interfaceName, size_t *numResources);
+
 /**
  * This function checks whether the specified resource URI aligns with a pre-existing
  * virtual resource; returns false otherwise.
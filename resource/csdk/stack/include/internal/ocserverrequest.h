@@ -31,6 +31,7 @@
 
 #include "cacommon.h"
 #include "cainterface.h"
+#include "oic_malloc.h"
 
 /**
  * The signature of the internal call back functions to handle responses from entity handler
@@ -103,6 +104,21 @@ typedef struct OCServerRequest
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
+    /** Other observers that receive this notification (::OC_SHARED_NOTIFICATION).*/
+    OCObservationId *sharedObserverIds;
+
+    /** Number of observers in sharedObserverIds.*/
+    size_t numSharedObservers;
+
+    /** Quality of service requested for the shared notification.*/
+    OCQualityOfService sharedQos;
+
+    /** Arena holding this request and everything allocated for its lifetime.*/
+    OICArena *arena;
+
+    /** Flag indicating the request was queued to a request dispatch worker.*/
+    uint8_t dispatched;
+
     /** Payload Size.*/
     size_t payloadSize;
 
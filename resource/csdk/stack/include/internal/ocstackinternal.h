@@ -189,6 +189,40 @@ typedef uint8_t ServerID[16];
 OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t status);
 
 
+/**
+ * Takes the recursive stack lock guarding resources, observers, server requests and client
+ * callbacks.  Does nothing unless OCSetRequestDispatchThreads() started dispatch workers.
+ */
+void OCStackLock();
+
+/**
+ * Releases one level of the stack lock taken with OCStackLock().
+ */
+void OCStackUnlock();
+
+/**
+ * Releases the stack lock completely, however many levels the calling thread holds.
+ * Used around application callbacks, which must not run with the lock held.
+ *
+ * @return The recursion depth released, to be passed to OCStackRelock().
+ */
+uint32_t OCStackUnlockAll();
+
+/**
+ * Takes the stack lock back after OCStackUnlockAll().
+ *
+ * @param depth Recursion depth returned by OCStackUnlockAll().
+ */
+void OCStackRelock(uint32_t depth);
+
+/**
+ * Parses a received payload, lazily if OCSetLazyPayloadParsing enabled it.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCParseReceivedPayload(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize);
+
 /**
  * Handler function to execute stack requests
  *
@@ -71,6 +71,12 @@ OCStackResult TerminateKeepAlive(OCMode mode);
  */
 void ProcessKeepAlive();
 
+/**
+ * Get the time at which ::ProcessKeepAlive has to run next.
+ * @return  Time in microseconds, 0 if there is no KeepAlive entry.
+ */
+uint64_t GetNextKeepAliveTime();
+
 /**
  * This API will be called from RI layer whenever there is a request for KeepAlive.
  * Virtual Resource.
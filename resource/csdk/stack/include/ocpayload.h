@@ -125,10 +125,39 @@ bool OCRepPayloadSetPropByteStringAsOwner(OCRepPayload* payload, const char* nam
 bool OCRepPayloadGetPropByteString(const OCRepPayload* payload, const char* name,
         OCByteString* value);
 
+/**
+ * This function gets the byte string from the payload without copying it.
+ *
+ * @param payload      Pointer to the payload from which byte string needs to be retrieved.
+ * @param name         Name of the byte string.
+ * @param value        Byte string and it's length.
+ *
+ * @note: value.bytes points into the payload and is only valid as long as the payload is.
+ *
+ * @return true on success, false upon failure.
+ */
+bool OCRepPayloadGetPropByteStringView(const OCRepPayload* payload, const char* name,
+        OCByteString* value);
+
 bool OCRepPayloadSetPropString(OCRepPayload* payload, const char* name, const char* value);
 bool OCRepPayloadSetPropStringAsOwner(OCRepPayload* payload, const char* name, char* value);
 bool OCRepPayloadGetPropString(const OCRepPayload* payload, const char* name, char** value);
 
+/**
+ * This function gets the string from the payload without copying it.
+ *
+ * @param payload      Pointer to the payload from which string needs to be retrieved.
+ * @param name         Name of the string.
+ * @param value        Start of the string, which is not null terminated.
+ * @param len          Length of the string.
+ *
+ * @note: value points into the payload and is only valid as long as the payload is.
+ *
+ * @return true on success, false upon failure.
+ */
+bool OCRepPayloadGetPropStringView(const OCRepPayload* payload, const char* name,
+        const char** value, size_t* len);
+
 bool OCRepPayloadSetPropBool(OCRepPayload* payload, const char* name, bool value);
 bool OCRepPayloadGetPropBool(const OCRepPayload* payload, const char* name, bool* value);
 
@@ -214,6 +243,16 @@ bool OCRepPayloadSetPropObjectArray(OCRepPayload* payload, const char* name,
 bool OCRepPayloadGetPropObjectArray(const OCRepPayload* payload, const char* name,
         OCRepPayload*** array, size_t dimensions[MAX_REP_ARRAY_DEPTH]);
 
+/**
+ * This function decodes the values a lazily parsed payload has not decoded yet, so that
+ * payload->values holds all of them.  Nested objects stay lazy until decoded themselves.
+ *
+ * @param payload      Pointer to the payload.
+ *
+ * @return true on success, false upon failure.
+ */
+bool OCRepPayloadDecodeLazyValues(OCRepPayload* payload);
+
 void OCRepPayloadDestroy(OCRepPayload* payload);
 
 // Discovery Payload
@@ -222,6 +261,18 @@ OCDiscoveryPayload* OCDiscoveryPayloadCreate();
 OCSecurityPayload* OCSecurityPayloadCreate(const uint8_t* securityData, size_t size);
 void OCSecurityPayloadDestroy(OCSecurityPayload* payload);
 
+/**
+ * Wraps an already CBOR encoded representation in a payload.
+ *
+ * @param data         Encoded representation, allocated with OICMalloc. On success
+ *                     the payload takes ownership of it.
+ * @param size         Size of data.
+ *
+ * @return The payload, or NULL if it could not be allocated.
+ */
+OCEncodedPayload* OCEncodedPayloadCreateAsOwner(uint8_t* data, size_t size);
+void OCEncodedPayloadDestroy(OCEncodedPayload* payload);
+
 #ifndef TCP_ADAPTER
 void OCDiscoveryPayloadAddResource(OCDiscoveryPayload* payload, const OCResource* res,
                                    uint16_t securePort);
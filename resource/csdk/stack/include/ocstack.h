@@ -114,6 +114,25 @@ OCStackResult OCStopMulticastServer();
  */
 OCStackResult OCProcess();
 
+/**
+ * This function blocks the calling thread until OCProcess() has work to do: a message was
+ * received, one of the stack timers (e.g. presence, KeepAlive) expired or OCProcessWakeup()
+ * was called. It lets an event loop call OCProcess() only when needed instead of polling.
+ *
+ * @note: Do not hold a lock which is also taken around OCProcess() while waiting.
+ *
+ * @param maxWaitMs         Upper bound of the wait in milliseconds. 0 waits without bound.
+ *
+ * @return ::OC_STACK_OK when OCProcess() should be called, some other value upon failure
+ *         (e.g. ::OC_STACK_NOTIMPL if the connectivity layer cannot wait).
+ */
+OCStackResult OCProcessWait(uint32_t maxWaitMs);
+
+/**
+ * This function wakes up a thread blocked in OCProcessWait().
+ */
+void OCProcessWakeup();
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -228,6 +247,37 @@ OCStackResult OCStopPresence();
  */
 OCStackResult OCSetDefaultDeviceEntityHandler(OCDeviceEntityHandler entityHandler, void* callbackParameter);
 
+/**
+ * This function selects how representation payloads of incoming requests and responses
+ * are parsed.  When enabled, the values stay in the received CBOR and are decoded the first
+ * time they are read through the OCRepPayloadGet* functions.  Code walking
+ * OCRepPayload::values directly must call OCRepPayloadDecodeLazyValues first.
+ * As reading a lazily parsed payload decodes into it, even the getters taking a const
+ * payload must not run on the same payload from several threads at once; clone it,
+ * or call OCRepPayloadDecodeLazyValues before sharing it.
+ *
+ * @param enable       true to parse lazily, false (the default) to decode everything up front.
+ */
+void OCSetLazyPayloadParsing(bool enable);
+
+/**
+ * This function moves entity handler invocations off the thread calling OCProcess() onto a
+ * pool of worker threads, so that one slow entity handler no longer delays requests for other
+ * resources.  Requests for the same resource are still handled one at a time unless the
+ * resource was created with ::OC_REENTRANT.  The stack serializes its own bookkeeping with an
+ * internal lock that is released while entity handlers run.
+ *
+ * @note: Must be called before OCInit().  Deleting a resource from another thread while its
+ *        entity handler runs remains the application's responsibility.
+ *
+ * @param numThreads       Number of worker threads. 0 (the default) calls entity handlers
+ *                         from OCProcess().
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_ERROR if the stack is already initialized or
+ *         ::OC_STACK_NOTIMPL on platforms without threads.
+ */
+OCStackResult OCSetRequestDispatchThreads(uint8_t numThreads);
+
 /**
  * This function sets device information.
  *
@@ -676,7 +676,17 @@ typedef enum
     /** When this bit is set, the resource is allowed to be discovered only
      *  if discovery request contains an explicit querystring.
      *  Ex: GET /oic/res?rt=oic.sec.acl */
-    OC_EXPLICIT_DISCOVERABLE   = (1 << 5)
+    OC_EXPLICIT_DISCOVERABLE   = (1 << 5),
+
+    /** When this bit is set, an observe notification is built and encoded once for all
+     *  observers that share the same query and accept format. The entity handler is
+     *  called for the first observer of each such group only.*/
+    OC_SHARED_NOTIFICATION     = (1 << 6),
+
+    /** When this bit is set and requests are dispatched to worker threads (see
+     *  OCSetRequestDispatchThreads), the entity handler may run for several requests
+     *  at the same time.*/
+    OC_REENTRANT               = (1 << 7)
 } OCResourceProperty;
 
 /**
@@ -995,7 +1005,9 @@ typedef enum
     /** The payload is an OCPresencePayload */
     PAYLOAD_TYPE_PRESENCE,
     /** The payload is an OCRDPayload */
-    PAYLOAD_TYPE_RD
+    PAYLOAD_TYPE_RD,
+    /** The payload is an OCEncodedPayload */
+    PAYLOAD_TYPE_ENCODED
 } OCPayloadType;
 
 /**
@@ -1073,6 +1085,9 @@ typedef struct OCRepPayloadValue
 
 } OCRepPayloadValue;
 
+/** Received CBOR that values of a lazily parsed representation are decoded from.*/
+typedef struct OCRepPayloadLazyValues OCRepPayloadLazyValues;
+
 // used for get/set/put/observe/etc representations
 typedef struct OCRepPayload
 {
@@ -1082,6 +1097,9 @@ typedef struct OCRepPayload
     OCStringLL* interfaces;
     OCRepPayloadValue* values;
     struct OCRepPayload* next;
+
+    /** Values not decoded yet, NULL unless the payload was parsed lazily.*/
+    OCRepPayloadLazyValues* lazy;
 } OCRepPayload;
 
 // used inside a discovery payload
@@ -1260,6 +1278,18 @@ typedef struct
     size_t payloadSize;
 } OCSecurityPayload;
 
+/**
+ * Representation payload that is already CBOR encoded. It is sent as is, and
+ * carries exactly the bytes OCConvertPayload would produce for the equivalent
+ * OCRepPayload.
+ */
+typedef struct
+{
+    OCPayload base;
+    uint8_t* data;
+    size_t size;
+} OCEncodedPayload;
+
 #ifdef WITH_PRESENCE
 typedef struct
 {
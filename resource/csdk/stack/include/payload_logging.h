@@ -301,6 +301,12 @@ static inline void OCPayloadLogSecurity(LogLevel level, OCSecurityPayload* paylo
     OIC_LOG_V(level, PL_TAG, "\tSecurity Data: %s", payload->securityData);
 }
 
+static inline void OCPayloadLogEncoded(LogLevel level, OCEncodedPayload* payload)
+{
+    OIC_LOG(level, PL_TAG, "Payload Type: Encoded Representation");
+    OIC_LOG_BUFFER(level, PL_TAG, payload->data, payload->size);
+}
+
 static inline void OCRDPayloadLog(const LogLevel level, const OCRDPayload *payload)
 {
     if (!payload)
@@ -354,6 +360,9 @@ static inline void OCPayloadLog(LogLevel level, OCPayload* payload)
         case PAYLOAD_TYPE_RD:
             OCRDPayloadLog(level, (OCRDPayload*)payload);
             break;
+        case PAYLOAD_TYPE_ENCODED:
+            OCPayloadLogEncoded(level, (OCEncodedPayload*)payload);
+            break;
         default:
             OIC_LOG_V(level, PL_TAG, "Unknown Payload Type: %d", payload->type);
             break;
@@ -1021,6 +1021,9 @@ int main(int argc, char* argv[])
 
     OIC_LOG(DEBUG, TAG, "OCServer is starting...");
 
+    // The light handler only reads a couple of properties through the getters
+    OCSetLazyPayloadParsing(true);
+
     if (OCInit(NULL, 0, OC_SERVER) != OC_STACK_OK)
     {
         OIC_LOG(ERROR, TAG, "OCStack init error");
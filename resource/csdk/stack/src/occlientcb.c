@@ -38,9 +38,111 @@
 /// Module Name
 #define TAG "OIC_RI_CLIENTCB"
 
+/** initial size of the timeout heap.*/
+#define CB_TIMEOUT_HEAP_INITIAL_SIZE 16
+
 struct ClientCB *cbList = NULL;
 static OCMulticastNode * mcPresenceNodes = NULL;
 
+/** Callbacks indexed by token, invocation handle, request uri and node address.*/
+static ClientCB *cbTokenTable = NULL;
+static ClientCB *cbHandleTable = NULL;
+static ClientCB *cbUriTable = NULL;
+static ClientCB *cbNodeTable = NULL;
+
+/** Callbacks with a TTL, in a min-heap ordered by TTL.*/
+static ClientCB **cbTimeoutHeap = NULL;
+static size_t cbTimeoutCount = 0;
+static size_t cbTimeoutCapacity = 0;
+
+static void SwapTimeoutCB(size_t i, size_t j)
+{
+    ClientCB *tmp = cbTimeoutHeap[i];
+    cbTimeoutHeap[i] = cbTimeoutHeap[j];
+    cbTimeoutHeap[j] = tmp;
+    cbTimeoutHeap[i]->timeoutIndex = i;
+    cbTimeoutHeap[j]->timeoutIndex = j;
+}
+
+static void SiftUpTimeoutCB(size_t index)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if (cbTimeoutHeap[parent]->TTL <= cbTimeoutHeap[index]->TTL)
+        {
+            break;
+        }
+        SwapTimeoutCB(parent, index);
+        index = parent;
+    }
+}
+
+static void SiftDownTimeoutCB(size_t index)
+{
+    while (true)
+    {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+
+        if (left < cbTimeoutCount && cbTimeoutHeap[left]->TTL < cbTimeoutHeap[smallest]->TTL)
+        {
+            smallest = left;
+        }
+        if (right < cbTimeoutCount && cbTimeoutHeap[right]->TTL < cbTimeoutHeap[smallest]->TTL)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        SwapTimeoutCB(index, smallest);
+        index = smallest;
+    }
+}
+
+/*
+ * Add a node with a non zero TTL to the timeout heap.
+ */
+static OCStackResult AddTimeoutCB(ClientCB *cbNode)
+{
+    if (cbTimeoutCount == cbTimeoutCapacity)
+    {
+        size_t capacity = cbTimeoutCapacity ?
+                cbTimeoutCapacity * 2 : CB_TIMEOUT_HEAP_INITIAL_SIZE;
+        ClientCB **heap = (ClientCB **) OICRealloc(cbTimeoutHeap, capacity * sizeof(*heap));
+        if (!heap)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+        cbTimeoutHeap = heap;
+        cbTimeoutCapacity = capacity;
+    }
+
+    cbNode->timeoutIndex = cbTimeoutCount++;
+    cbTimeoutHeap[cbNode->timeoutIndex] = cbNode;
+    SiftUpTimeoutCB(cbNode->timeoutIndex);
+    return OC_STACK_OK;
+}
+
+/*
+ * Remove a node with a non zero TTL from the timeout heap.
+ */
+static void RemoveTimeoutCB(ClientCB *cbNode)
+{
+    size_t index = cbNode->timeoutIndex;
+    size_t last = --cbTimeoutCount;
+    if (index != last)
+    {
+        SwapTimeoutCB(index, last);
+        SiftDownTimeoutCB(index);
+        SiftUpTimeoutCB(index);
+    }
+    cbTimeoutHeap[last] = NULL;
+}
+
 OCStackResult
 AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
              CAToken_t token, uint8_t tokenLength,
@@ -99,10 +201,21 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
             {
                 cbNode->TTL = ttl;
             }
+            if (cbNode->TTL && AddTimeoutCB(cbNode) != OC_STACK_OK)
+            {
+                OICFree(cbNode);
+                *clientCB = NULL;
+                goto exit;
+            }
             cbNode->requestUri = requestUri;    // I own it now
             cbNode->devAddr = devAddr;          // I own it now
+            cbNode->self = cbNode;
             OIC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
-            LL_APPEND(cbList, cbNode);
+            DL_APPEND(cbList, cbNode);
+            HASH_ADD_KEYPTR(tokenHh, cbTokenTable, cbNode->token, tokenLength, cbNode);
+            HASH_ADD(handleHh, cbHandleTable, handle, sizeof(OCDoHandle), cbNode);
+            HASH_ADD_KEYPTR(uriHh, cbUriTable, requestUri, strlen(requestUri), cbNode);
+            HASH_ADD(nodeHh, cbNodeTable, self, sizeof(ClientCB *), cbNode);
             *clientCB = cbNode;
         }
     }
@@ -149,7 +262,15 @@ void DeleteClientCB(ClientCB * cbNode)
 {
     if (cbNode)
     {
-        LL_DELETE(cbList, cbNode);
+        DL_DELETE(cbList, cbNode);
+        HASH_DELETE(tokenHh, cbTokenTable, cbNode);
+        HASH_DELETE(handleHh, cbHandleTable, cbNode);
+        HASH_DELETE(uriHh, cbUriTable, cbNode);
+        HASH_DELETE(nodeHh, cbNodeTable, cbNode);
+        if (cbNode->TTL)
+        {
+            RemoveTimeoutCB(cbNode);
+        }
         OIC_LOG (INFO, TAG, "Deleting token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
         CADestroyToken (cbNode->token);
@@ -186,33 +307,57 @@ void DeleteClientCB(ClientCB * cbNode)
     }
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence or observe
- * callback with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckAndDeleteTimedOutCB(ClientCB* cbNode)
+void SetClientCBTimeout(ClientCB *cbNode, uint32_t ttl)
 {
-    if (!cbNode)
+    if (!cbNode || cbNode->TTL == ttl)
     {
         return;
     }
-    if (cbNode->TTL == 0)
+
+    if (!cbNode->TTL)
     {
-        return;
+        cbNode->TTL = ttl;
+        if (AddTimeoutCB(cbNode) != OC_STACK_OK)
+        {
+            OIC_LOG(ERROR, TAG, "Callback will not time out, out of memory");
+            cbNode->TTL = 0;
+        }
+    }
+    else if (!ttl)
+    {
+        RemoveTimeoutCB(cbNode);
+        cbNode->TTL = 0;
     }
+    else
+    {
+        cbNode->TTL = ttl;
+        SiftDownTimeoutCB(cbNode->timeoutIndex);
+        SiftUpTimeoutCB(cbNode->timeoutIndex);
+    }
+}
+
+/*
+ * Presence and observe callbacks have a TTL of 0 and are not in the timeout heap,
+ * presence nodes have their own mechanisms for timeouts and observes can be
+ * explicitly cancelled.
+ */
+void DeleteTimedOutClientCBs()
+{
     coap_tick_t now;
     coap_ticks(&now);
 
-    if (cbNode->TTL < now)
+    while (cbTimeoutCount && cbTimeoutHeap[0]->TTL < now)
     {
         OIC_LOG(INFO, TAG, "Deleting timed-out callback");
-        DeleteClientCB(cbNode);
+        DeleteClientCB(cbTimeoutHeap[0]);
     }
 }
 
+uint32_t GetNextClientCBTimeout()
+{
+    return cbTimeoutCount ? cbTimeoutHeap[0]->TTL : 0;
+}
+
 ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
                       OCDoHandle handle, const char * requestUri)
 {
@@ -222,41 +367,22 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
     {
         OIC_LOG (INFO, TAG,  "Looking for token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        OIC_LOG(INFO, TAG, "\tFound in callback list");
-        LL_FOREACH(cbList, out)
-        {
-            OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-
-            if (memcmp(out->token, token, tokenLength) == 0)
-            {
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        HASH_FIND(tokenHh, cbTokenTable, token, tokenLength, out);
     }
     else if (handle)
     {
-        LL_FOREACH(cbList, out)
-        {
-            if (out->handle == handle)
-            {
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        HASH_FIND(handleHh, cbHandleTable, &handle, sizeof(OCDoHandle), out);
     }
     else if (requestUri)
     {
         OIC_LOG_V(INFO, TAG, "Looking for uri %s", requestUri);
-        LL_FOREACH(cbList, out)
-        {
-            OIC_LOG_V(INFO, TAG, "\tFound %s", out->requestUri);
-            if (out->requestUri && strcmp(out->requestUri, requestUri ) == 0)
-            {
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        HASH_FIND(uriHh, cbUriTable, requestUri, strlen(requestUri), out);
+    }
+
+    if (out)
+    {
+        OIC_LOG(INFO, TAG, "\tFound in callback list");
+        return out;
     }
     OIC_LOG(INFO, TAG, "Callback Not found !!");
     return NULL;
@@ -289,25 +415,27 @@ void DeleteClientCBList()
 {
     ClientCB* out;
     ClientCB* tmp;
-    LL_FOREACH_SAFE(cbList, out, tmp)
+    DL_FOREACH_SAFE(cbList, out, tmp)
     {
         DeleteClientCB(out);
     }
     cbList = NULL;
+
+    OICFree(cbTimeoutHeap);
+    cbTimeoutHeap = NULL;
+    cbTimeoutCapacity = 0;
 }
 
 void FindAndDeleteClientCB(ClientCB * cbNode)
 {
-    ClientCB* tmp;
+    ClientCB* tmp = NULL;
     if (cbNode)
     {
-        LL_FOREACH(cbList, tmp)
+        // The node may already be deleted, look it up by address only.
+        HASH_FIND(nodeHh, cbNodeTable, &cbNode, sizeof(ClientCB *), tmp);
+        if (tmp)
         {
-            if (cbNode == tmp)
-            {
-                DeleteClientCB(tmp);
-                break;
-            }
+            DeleteClientCB(tmp);
         }
     }
 }
@@ -307,46 +307,76 @@ HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
     response.resourceHandle = (OCResourceHandle) collResource;
     OCStackResult stackRet = OCDoResponse(&response);
 
-    if (stackRet == OC_STACK_OK)
+    if (stackRet == OC_STACK_OK && collResource)
     {
-        OCChildResource *tempChildResource = (collResource) ? collResource->rsrcChildResourcesHead
-                                                              : NULL;
-        while(tempChildResource)
+        // Child entity handlers run without the stack lock, so work on a snapshot of
+        // the children and check each one is still bound before calling it.
+        uint8_t numChildren = GetNumOfResourcesInCollection(collResource);
+        OCResource **children = numChildren ?
+                (OCResource **) OICMalloc(numChildren * sizeof(OCResource *)) : NULL;
+        if (numChildren && !children)
         {
-            OCResource* tempRsrcResource = tempChildResource->rsrcResource;
-
-            if (tempRsrcResource)
-            {
-                // Note that all entity handlers called through a collection
-                // will get the same pointer to ehRequest, the only difference
-                // is ehRequest->resource
-                ehRequest->resource = (OCResourceHandle) tempRsrcResource;
+            return OC_STACK_NO_MEMORY;
+        }
+        uint8_t count = 0;
+        OCChildResource *tempChildResource = collResource->rsrcChildResourcesHead;
+        while (tempChildResource && tempChildResource->rsrcResource && count < numChildren)
+        {
+            children[count++] = tempChildResource->rsrcResource;
+            tempChildResource = tempChildResource->next;
+        }
 
-                OCEntityHandlerResult ehResult = tempRsrcResource->entityHandler(OC_REQUEST_FLAG,
-                                           ehRequest, tempRsrcResource->entityHandlerCallbackParam);
+        for (uint8_t i = 0; i < count; i++)
+        {
+            OCResource* tempRsrcResource = children[i];
 
-                // The default collection handler is returning as OK
-                if (stackRet != OC_STACK_SLOW_RESOURCE)
-                {
-                    stackRet = OC_STACK_OK;
-                }
-                // if a single resource is slow, then entire response will be treated
-                // as slow response
-                if (ehResult == OC_EH_SLOW)
+            for (tempChildResource = collResource->rsrcChildResourcesHead; tempChildResource;
+                 tempChildResource = tempChildResource->next)
+            {
+                if (tempChildResource->rsrcResource == tempRsrcResource)
                 {
-                    OIC_LOG(INFO, TAG, "This is a slow resource");
-                    ((OCServerRequest *)ehRequest->requestHandle)->slowFlag = 1;
-                    stackRet = EntityHandlerCodeToOCStackCode(ehResult);
+                    break;
                 }
             }
-            else
+            if (!tempChildResource)
             {
-                break;
+                // Unbound while an earlier child's entity handler ran
+                continue;
             }
 
-            tempChildResource = tempChildResource->next;
-
+            // Note that all entity handlers called through a collection
+            // will get the same pointer to ehRequest, the only difference
+            // is ehRequest->resource
+            ehRequest->resource = (OCResourceHandle) tempRsrcResource;
+
+            // The stack lock is not held while application code runs
+            OCEntityHandler entityHandler = tempRsrcResource->entityHandler;
+            void *entityHandlerCallbackParam = tempRsrcResource->entityHandlerCallbackParam;
+            uint32_t lockDepth = OCStackUnlockAll();
+            OCEntityHandlerResult ehResult = entityHandler(OC_REQUEST_FLAG,
+                                       ehRequest, entityHandlerCallbackParam);
+            OCStackRelock(lockDepth);
+
+            // The default collection handler is returning as OK
+            if (stackRet != OC_STACK_SLOW_RESOURCE)
+            {
+                stackRet = OC_STACK_OK;
+            }
+            // if a single resource is slow, then entire response will be treated
+            // as slow response
+            if (ehResult == OC_EH_SLOW)
+            {
+                OIC_LOG(INFO, TAG, "This is a slow resource");
+                OCServerRequest *request =
+                    GetServerRequestUsingHandle((OCServerRequest *)ehRequest->requestHandle);
+                if (request)
+                {
+                    request->slowFlag = 1;
+                }
+                stackRet = EntityHandlerCodeToOCStackCode(ehResult);
+            }
         }
+        OICFree(children);
 
         ehRequest->resource = (OCResourceHandle) collResource;
     }
@@ -32,6 +32,7 @@
 #include "logger.h"
 
 #include "utlist.h"
+#include "uthash.h"
 #include "pdu.h"
 
 
@@ -42,7 +43,12 @@
 
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
-static struct ResourceObserver * g_serverObsList = NULL;
+/** Observers indexed by the token of their observe request.*/
+static struct ResourceObserver * g_serverObsByToken = NULL;
+
+/** Observers indexed by observation id.*/
+static struct ResourceObserver * g_serverObsById = NULL;
+
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -96,6 +102,116 @@ static OCQualityOfService DetermineObserverQoS(OCMethod method,
     return decidedQoS;
 }
 
+OCQualityOfService GetObserverNotificationQoS (ResourceObserver *observer,
+        OCQualityOfService qos)
+{
+    return DetermineObserverQoS(OC_REST_GET, observer, qos);
+}
+
+/**
+ * Check if an observer can share the notification built for another observer.
+ *
+ * @param first First observer of the group.
+ * @param observer Observer to check.
+ * @return true if both use the same query and accept format.
+ */
+static bool IsSharedObserver(const ResourceObserver *first, const ResourceObserver *observer)
+{
+    if (observer->acceptFormat != first->acceptFormat)
+    {
+        return false;
+    }
+    if (!observer->query || !first->query)
+    {
+        return observer->query == first->query;
+    }
+    return 0 == strcmp(observer->query, first->query);
+}
+
+/**
+ * Attach to a notification request the observers that will receive the same
+ * encoded notification as the observer the request was created for.
+ *
+ * @param request Notification request for the first observer of the group.
+ * @param first First observer of the group.
+ * @param observeIds Observation ids of the observers still to be notified.
+ * @param covered Per id, whether the pass already notified it along with a group.
+ * @param numIds Number of ids in observeIds.
+ * @param sharedIndexes Filled with the positions in observeIds of the group members.
+ * @param qos Quality of service requested for the notification.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult AddSharedObservers(OCServerRequest *request, ResourceObserver *first,
+        const OCObservationId *observeIds, const bool *covered, size_t numIds,
+        size_t *sharedIndexes, OCQualityOfService qos)
+{
+    size_t numShared = 0;
+    for (size_t i = 0; i < numIds; i++)
+    {
+        ResourceObserver *observer = covered[i] ? NULL : GetObserverUsingId(observeIds[i]);
+        if (observer && observer->resource == first->resource
+            && IsSharedObserver(first, observer))
+        {
+            sharedIndexes[numShared++] = i;
+        }
+    }
+    if (!numShared)
+    {
+        return OC_STACK_OK;
+    }
+
+    request->sharedObserverIds = (OCObservationId *) OICArenaAlloc(request->arena,
+            numShared * sizeof(OCObservationId));
+    if (!request->sharedObserverIds)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    for (size_t i = 0; i < numShared; i++)
+    {
+        request->sharedObserverIds[i] = observeIds[sharedIndexes[i]];
+    }
+    request->numSharedObservers = numShared;
+    request->sharedQos = qos;
+
+    OIC_LOG_V(INFO, TAG, "Notification shared with %zu other observers", numShared);
+    return OC_STACK_OK;
+}
+
+/**
+ * Settle the observers a notification request was shared with once the entity
+ * handler has returned.
+ *
+ * When the handler succeeded the group members are covered for the rest of the
+ * pass, as they get the response for the first observer. Otherwise they are left
+ * to get their own notification, and a response still owed for the request goes
+ * to the first observer only.
+ *
+ * @param request Notification request for the first observer of the group.
+ * @param covered Per observer still to be notified in the pass, whether it is covered.
+ * @param sharedIndexes Positions in covered of the group members.
+ * @param numShared Number of entries in sharedIndexes.
+ * @param ehResult Result returned by the entity handler.
+ */
+static void SettleSharedObservers(OCServerRequest *request, bool *covered,
+        const size_t *sharedIndexes, size_t numShared, OCEntityHandlerResult ehResult)
+{
+    if (OC_EH_OK == ehResult)
+    {
+        for (size_t i = 0; i < numShared; i++)
+        {
+            covered[sharedIndexes[i]] = true;
+        }
+        return;
+    }
+
+    request = GetServerRequestUsingHandle(request);
+    if (request)
+    {
+        request->numSharedObservers = 0;
+    }
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr, uint32_t maxAge,
         OCPresenceTrigger trigger, OCResourceType *resourceType, OCQualityOfService qos)
@@ -111,17 +227,62 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     }
 
     OCStackResult result = OC_STACK_ERROR;
-    ResourceObserver * resourceObserver = g_serverObsList;
+    ResourceObserver * resourceObserver = NULL;
     uint8_t numObs = 0;
     OCServerRequest * request = NULL;
     OCEntityHandlerRequest ehRequest = {0};
     OCEntityHandlerResult ehResult = OC_EH_ERROR;
     bool observeErrorFlag = false;
+    const OCQualityOfService requestedQos = qos;
+
+    // The entity handler runs without the stack lock, so observers may come and go
+    // meanwhile. Walk a snapshot of the observation ids instead of the list itself.
+    size_t numIds = 0;
+    DL_FOREACH(resPtr->observersHead, resourceObserver)
+    {
+        numIds++;
+    }
+    if (!numIds)
+    {
+        OIC_LOG(INFO, TAG, "Resource has no observers");
+        return OC_STACK_NO_OBSERVERS;
+    }
+
+    // Which observers the pass already notified along with their group, and room for
+    // the members of the group being built. Both stay local to the pass, as another
+    // pass may run on the same resource while an entity handler runs.
+    OCObservationId *observeIds = (OCObservationId *) OICMalloc(numIds * sizeof(OCObservationId));
+    bool *covered = (bool *) OICCalloc(numIds, sizeof(bool));
+    size_t *sharedIndexes = (size_t *) OICMalloc(numIds * sizeof(size_t));
+    if (!observeIds || !covered || !sharedIndexes)
+    {
+        OICFree(observeIds);
+        OICFree(covered);
+        OICFree(sharedIndexes);
+        return OC_STACK_NO_MEMORY;
+    }
+    numIds = 0;
+    DL_FOREACH(resPtr->observersHead, resourceObserver)
+    {
+        observeIds[numIds++] = resourceObserver->observeId;
+    }
 
-    // Find clients that are observing this resource
-    while (resourceObserver)
+    // Notify clients that are observing this resource
+    for (size_t i = 0; i < numIds; i++)
     {
-        if (resourceObserver->resource == resPtr)
+        resourceObserver = GetObserverUsingId(observeIds[i]);
+        if (!resourceObserver || resourceObserver->resource != resPtr)
+        {
+            // The observer has deregistered while an entity handler ran.
+            continue;
+        }
+
+        if (covered[i])
+        {
+            // Already notified along with an earlier observer of its group.
+            numObs++;
+        }
+        else
         {
             numObs++;
 #ifdef WITH_PRESENCE
@@ -140,6 +301,13 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
                 if (request)
                 {
                     request->observeResult = OC_STACK_OK;
+                    if (result == OC_STACK_OK
+                        && (resPtr->resourceProperties & OC_SHARED_NOTIFICATION))
+                    {
+                        result = AddSharedObservers(request, resourceObserver,
+                                observeIds + i + 1, covered + i + 1, numIds - i - 1,
+                                sharedIndexes, requestedQos);
+                    }
                     if (result == OC_STACK_OK)
                     {
                         result = FormOCEntityHandlerRequest(
@@ -157,10 +325,31 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
                                     OC_OBSERVE_NO_OPTION,
                                     0,
                                     request->coapID);
+                        // The request may be gone once the handler responded
+                        size_t numShared = request->numSharedObservers;
                         if (result == OC_STACK_OK)
                         {
-                            ehResult = resPtr->entityHandler(OC_REQUEST_FLAG, &ehRequest,
-                                                resPtr->entityHandlerCallbackParam);
+                            // The stack lock is not held while application code runs
+                            OCEntityHandler entityHandler = resPtr->entityHandler;
+                            void *entityHandlerCallbackParam = resPtr->entityHandlerCallbackParam;
+                            uint32_t lockDepth = OCStackUnlockAll();
+                            ehResult = entityHandler(OC_REQUEST_FLAG, &ehRequest,
+                                                     entityHandlerCallbackParam);
+                            OCStackRelock(lockDepth);
+
+                            // The resource and its observers may have gone meanwhile.
+                            // The observer is looked up again by id for the next one.
+                            resourceObserver = NULL;
+                            if (FindResourceByHandle((OCResourceHandle) resPtr) != resPtr)
+                            {
+                                OIC_LOG(INFO, TAG, "Resource deleted during notification");
+                                resPtr = NULL;
+                            }
+                            if (numShared)
+                            {
+                                SettleSharedObservers(request, covered + i + 1, sharedIndexes,
+                                                      numShared, ehResult);
+                            }
                             if (ehResult == OC_EH_ERROR)
                             {
                                 FindAndDeleteServerRequest(request);
@@ -192,6 +381,9 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
 
                     if (!presenceResBuf)
                     {
+                        OICFree(observeIds);
+                        OICFree(covered);
+                        OICFree(sharedIndexes);
                         return OC_STACK_NO_MEMORY;
                     }
 
@@ -217,9 +409,15 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
             {
                 observeErrorFlag = true;
             }
+            if (!resPtr)
+            {
+                break;
+            }
         }
-        resourceObserver = resourceObserver->next;
     }
+    OICFree(observeIds);
+    OICFree(covered);
+    OICFree(sharedIndexes);
 
     if (numObs == 0)
     {
@@ -410,7 +608,9 @@ OCStackResult AddObserver (const char         *resUri,
         obsNode->devAddr = *devAddr;
         obsNode->resource = resHandle;
 
-        LL_APPEND (g_serverObsList, obsNode);
+        DL_APPEND (resHandle->observersHead, obsNode);
+        HASH_ADD_KEYPTR (tokenHh, g_serverObsByToken, obsNode->token, tokenLength, obsNode);
+        HASH_ADD (idHh, g_serverObsById, observeId, sizeof(OCObservationId), obsNode);
 
         return OC_STACK_OK;
     }
@@ -431,12 +631,10 @@ ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
 
     if (observeId)
     {
-        LL_FOREACH (g_serverObsList, out)
+        HASH_FIND (idHh, g_serverObsById, &observeId, sizeof(OCObservationId), out);
+        if (out)
         {
-            if (out->observeId == observeId)
-            {
-                return out;
-            }
+            return out;
         }
     }
     OIC_LOG(INFO, TAG, "Observer node not found!!");
@@ -451,15 +649,11 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
     {
         OIC_LOG(INFO, TAG, "Looking for token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        OIC_LOG(INFO, TAG, "\tFound token:");
 
-        LL_FOREACH (g_serverObsList, out)
+        HASH_FIND (tokenHh, g_serverObsByToken, token, tokenLength, out);
+        if (out)
         {
-            OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if ((memcmp(out->token, token, tokenLength) == 0))
-            {
-                return out;
-            }
+            return out;
         }
     }
     else
@@ -471,6 +665,22 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
     return NULL;
 }
 
+/**
+ * Unlink an observer from its resource and the lookup tables and free it.
+ *
+ * @param observer Observer to delete.
+ */
+static void FreeObserver(ResourceObserver *observer)
+{
+    DL_DELETE (observer->resource->observersHead, observer);
+    HASH_DELETE (tokenHh, g_serverObsByToken, observer);
+    HASH_DELETE (idHh, g_serverObsById, observer);
+    OICFree(observer->resUri);
+    OICFree(observer->query);
+    OICFree(observer->token);
+    OICFree(observer);
+}
+
 OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
 {
     if (!token)
@@ -483,28 +693,38 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
     {
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
-        LL_DELETE (g_serverObsList, obsNode);
-        OICFree(obsNode->resUri);
-        OICFree(obsNode->query);
-        OICFree(obsNode->token);
-        OICFree(obsNode);
+        FreeObserver(obsNode);
     }
     // it is ok if we did not find the observer...
     return OC_STACK_OK;
 }
 
+void DeleteObserversUsingResource (OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    ResourceObserver *out = NULL;
+    ResourceObserver *tmp = NULL;
+    DL_FOREACH_SAFE (resource->observersHead, out, tmp)
+    {
+        OIC_LOG_V(INFO, TAG, "deleting observer id  %u of %s", out->observeId, resource->uri);
+        FreeObserver(out);
+    }
+}
+
 void DeleteObserverList()
 {
     ResourceObserver *out = NULL;
     ResourceObserver *tmp = NULL;
-    LL_FOREACH_SAFE (g_serverObsList, out, tmp)
+    HASH_ITER (tokenHh, g_serverObsByToken, out, tmp)
     {
-        if (out)
-        {
-            DeleteObserverUsingToken ((out->token), out->tokenLength);
-        }
+        FreeObserver(out);
     }
-    g_serverObsList = NULL;
+    g_serverObsByToken = NULL;
+    g_serverObsById = NULL;
 }
 
 /*
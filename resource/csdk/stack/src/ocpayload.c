@@ -28,6 +28,7 @@
 #include "ocresource.h"
 #include "logger.h"
 #include "rdpayload.h"
+#include "ocpayloadcbor.h"
 
 #define TAG "OIC_RI_PAYLOAD"
 
@@ -60,6 +61,9 @@ void OCPayloadDestroy(OCPayload* payload)
         case PAYLOAD_TYPE_SECURITY:
             OCSecurityPayloadDestroy((OCSecurityPayload*)payload);
             break;
+        case PAYLOAD_TYPE_ENCODED:
+            OCEncodedPayloadDestroy((OCEncodedPayload*)payload);
+            break;
         case PAYLOAD_TYPE_RD:
            OCRDPayloadDestroy((OCRDPayload*)payload);
            break;
@@ -99,7 +103,8 @@ void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     child->next = NULL;
 }
 
-static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
+static OCRepPayloadValue* OCRepPayloadFindDecodedValue(const OCRepPayload* payload,
+        const char* name)
 {
     if (!payload || !name)
     {
@@ -119,6 +124,18 @@ static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, con
     return NULL;
 }
 
+static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
+{
+    OCRepPayloadValue* val = OCRepPayloadFindDecodedValue(payload, name);
+    if (!val && payload && payload->lazy)
+    {
+        // Decoding on demand only fills in values the payload already logically holds,
+        // but it does write to it: lazy payloads must not be read from two threads at once
+        val = OCRepPayloadLazyFindValue((OCRepPayload*)payload, name);
+    }
+    return val;
+}
+
 static void OCCopyPropertyValueArray(OCRepPayloadValue* dest, OCRepPayloadValue* source)
 {
     if (!dest || !source)
@@ -606,6 +623,35 @@ bool OCRepPayloadGetPropString(const OCRepPayload* payload, const char* name, ch
     return *value != NULL;
 }
 
+bool OCRepPayloadGetPropStringView(const OCRepPayload* payload, const char* name,
+        const char** value, size_t* len)
+{
+    if (!value || !len)
+    {
+        return false;
+    }
+
+    OCRepPayloadValue* val = OCRepPayloadFindDecodedValue(payload, name);
+    if (!val && OCRepPayloadLazyGetStringView(payload, name, OCREP_PROP_STRING,
+                (const uint8_t**)value, len))
+    {
+        return true;
+    }
+    if (!val)
+    {
+        val = OCRepPayloadFindValue(payload, name);
+    }
+
+    if (!val || val->type != OCREP_PROP_STRING)
+    {
+        return false;
+    }
+
+    *value = val->str;
+    *len = strlen(val->str);
+    return true;
+}
+
 bool OCRepPayloadSetPropByteString(OCRepPayload* payload, const char* name, OCByteString value)
 {
     if (!value.bytes || !value.len)
@@ -662,6 +708,36 @@ bool OCRepPayloadGetPropByteString(const OCRepPayload* payload, const char* name
     return true;
 }
 
+bool OCRepPayloadGetPropByteStringView(const OCRepPayload* payload, const char* name,
+        OCByteString* value)
+{
+    if (!value)
+    {
+        return false;
+    }
+
+    OCRepPayloadValue* val = OCRepPayloadFindDecodedValue(payload, name);
+    const uint8_t* bytes = NULL;
+    if (!val && OCRepPayloadLazyGetStringView(payload, name, OCREP_PROP_BYTE_STRING,
+                &bytes, &value->len))
+    {
+        value->bytes = (uint8_t*)bytes;
+        return true;
+    }
+    if (!val)
+    {
+        val = OCRepPayloadFindValue(payload, name);
+    }
+
+    if (!val || val->type != OCREP_PROP_BYTE_STRING)
+    {
+        return false;
+    }
+
+    *value = val->ocByteStr;
+    return true;
+}
+
 bool OCRepPayloadSetPropBool(OCRepPayload* payload,
                              const char* name, bool value)
 {
@@ -1299,6 +1375,12 @@ OCRepPayload* OCRepPayloadClone (const OCRepPayload* payload)
     clone->types = CloneOCStringLL (payload->types);
     clone->interfaces = CloneOCStringLL (payload->interfaces);
     clone->values = OCRepPayloadValueClone (payload->values);
+    clone->lazy = OCRepPayloadLazyClone (payload->lazy);
+    if (payload->lazy && !clone->lazy)
+    {
+        OCRepPayloadDestroy (clone);
+        return NULL;
+    }
 
     return clone;
 }
@@ -1315,6 +1397,7 @@ void OCRepPayloadDestroy(OCRepPayload* payload)
     OCFreeOCStringLL(payload->types);
     OCFreeOCStringLL(payload->interfaces);
     OCFreeRepPayloadValue(payload->values);
+    OCRepPayloadLazyDestroy(payload->lazy);
     OCRepPayloadDestroy(payload->next);
     OICFree(payload);
 }
@@ -1366,6 +1449,33 @@ void OCSecurityPayloadDestroy(OCSecurityPayload* payload)
     OICFree(payload);
 }
 
+OCEncodedPayload* OCEncodedPayloadCreateAsOwner(uint8_t* data, size_t size)
+{
+    OCEncodedPayload* payload = (OCEncodedPayload*)OICCalloc(1, sizeof(OCEncodedPayload));
+
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    payload->base.type = PAYLOAD_TYPE_ENCODED;
+    payload->data = data;
+    payload->size = size;
+
+    return payload;
+}
+
+void OCEncodedPayloadDestroy(OCEncodedPayload* payload)
+{
+    if (!payload)
+    {
+        return;
+    }
+
+    OICFree(payload->data);
+    OICFree(payload);
+}
+
 size_t OCDiscoveryPayloadGetResourceCount(OCDiscoveryPayload* payload)
 {
     size_t i = 0;
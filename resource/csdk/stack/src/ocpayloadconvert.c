@@ -52,6 +52,8 @@ static int64_t OCConvertPresencePayload(OCPresencePayload *payload, uint8_t *out
         size_t *size);
 static int64_t OCConvertSecurityPayload(OCSecurityPayload *payload, uint8_t *outPayload,
         size_t *size);
+static int64_t OCConvertEncodedPayload(OCEncodedPayload *payload, uint8_t *outPayload,
+        size_t *size);
 static int64_t OCConvertSingleRepPayload(CborEncoder *parent, const OCRepPayload *payload);
 static int64_t OCConvertArray(CborEncoder *parent, const OCRepPayloadValueArray *valArray);
 
@@ -73,6 +75,7 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
     int64_t err;
     uint8_t *out = NULL;
     size_t curSize = INIT_SIZE;
+    size_t allocSize;
 
     VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
@@ -84,37 +87,54 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
         size_t securityPayloadSize = ((OCSecurityPayload *)payload)->payloadSize;
         if (securityPayloadSize > 0)
         {
-            out = (uint8_t *)OICCalloc(1, ((OCSecurityPayload *)payload)->payloadSize);
-            VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate security payload");
+            curSize = securityPayloadSize;
         }
     }
-    if (out == NULL)
+    else if (PAYLOAD_TYPE_ENCODED == payload->type)
     {
-        out = (uint8_t *)OICCalloc(1, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+        size_t encodedPayloadSize = ((OCEncodedPayload *)payload)->size;
+        if (encodedPayloadSize > 0)
+        {
+            curSize = encodedPayloadSize;
+        }
     }
+    else if (PAYLOAD_TYPE_RD != payload->type)
+    {
+        // Measuring pass: tinycbor keeps counting past the end of the buffer, so encoding
+        // into an empty one yields the exact size without writing anything.
+        curSize = 0;
+        err = OCConvertPayloadHelper(payload, NULL, &curSize);
+        if (err != CborErrorOutOfMemory && err != CborNoError)
+        {
+            ret = (OCStackResult)-err;
+            goto exit;
+        }
+        if (curSize == 0)
+        {
+            curSize = INIT_SIZE;
+        }
+    }
+
+    allocSize = curSize;
+    out = (uint8_t *)OICCalloc(1, allocSize);
+    VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+
     err = OCConvertPayloadHelper(payload, out, &curSize);
     ret = OC_STACK_NO_MEMORY;
 
-    if (err == CborErrorOutOfMemory)
+    // Only reached if the measuring pass was skipped or came up short
+    while (err == CborErrorOutOfMemory)
     {
-        // reallocate "out" and try again!
         uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
         VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
         out = out2;
+        allocSize = curSize;
         err = OCConvertPayloadHelper(payload, out, &curSize);
-        while (err == CborErrorOutOfMemory)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-            err = OCConvertPayloadHelper(payload, out, &curSize);
-        }
     }
 
     if (err == CborNoError)
     {
-        if (curSize < INIT_SIZE && PAYLOAD_TYPE_SECURITY != payload->type)
+        if (curSize < allocSize && PAYLOAD_TYPE_RD == payload->type)
         {
             uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
             VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
@@ -152,6 +172,8 @@ static int64_t OCConvertPayloadHelper(OCPayload* payload, uint8_t* outPayload, s
             return OCConvertPresencePayload((OCPresencePayload*)payload, outPayload, size);
         case PAYLOAD_TYPE_SECURITY:
             return OCConvertSecurityPayload((OCSecurityPayload*)payload, outPayload, size);
+        case PAYLOAD_TYPE_ENCODED:
+            return OCConvertEncodedPayload((OCEncodedPayload*)payload, outPayload, size);
         case PAYLOAD_TYPE_RD:
             return OCRDPayloadToCbor((OCRDPayload*)payload, outPayload, size);
         default:
@@ -188,6 +210,15 @@ static int64_t OCConvertSecurityPayload(OCSecurityPayload* payload, uint8_t* out
     return CborNoError;
 }
 
+static int64_t OCConvertEncodedPayload(OCEncodedPayload* payload, uint8_t* outPayload,
+        size_t* size)
+{
+    memcpy(outPayload, payload->data, payload->size);
+    *size = payload->size;
+
+    return CborNoError;
+}
+
 static int64_t OCStringLLJoin(CborEncoder *map, char *type, OCStringLL *val)
 {
     uint16_t count = 0;
@@ -660,6 +691,10 @@ exit:
 static int64_t OCConvertSingleRepPayload(CborEncoder *repMap, const OCRepPayload *payload)
 {
     int64_t err = CborNoError;
+    if (!OCRepPayloadDecodeLazyValues((OCRepPayload *)payload))
+    {
+        return CborErrorIO;
+    }
     OCRepPayloadValue *value = payload->values;
     while (value)
     {
@@ -723,7 +758,7 @@ static int64_t OCConvertRepPayload(OCRepPayload *payload, uint8_t *outPayload, s
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed adding rep root map");
     }
 
-    while (payload != NULL && (err == CborNoError))
+    while (payload != NULL)
     {
         CborEncoder rootMap;
         err |= cbor_encoder_create_map(((arrayCount == 1)? &encoder: &rootArray),
@@ -820,11 +855,12 @@ static int64_t AddTextStringToMap(CborEncoder* map, const char* key, size_t keyl
         const char* value)
 {
     int64_t err = cbor_encode_text_string(map, key, keylen);
-    if (CborNoError != err)
+    if (CborNoError != err && CborErrorOutOfMemory != err)
     {
         return err;
     }
-    return cbor_encode_text_string(map, value, strlen(value));
+    // Out of memory, keep encoding so the size needed is counted in full
+    return err | cbor_encode_text_string(map, value, strlen(value));
 }
 
 static int64_t ConditionalAddTextStringToMap(CborEncoder* map, const char* key, size_t keylen,
@@ -41,8 +41,29 @@
 static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseDevicePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParsePlatformPayload(OCPayload **outPayload, CborValue *arrayVal);
+/**
+ * Copy of a received payload shared by the representations decoded from it lazily.
+ * Clones may be released on different threads, so the count is updated atomically.
+ */
+typedef struct OCCborBuffer
+{
+    uint32_t refCount;
+    size_t size;
+    uint8_t data[];
+} OCCborBuffer;
+
+struct OCRepPayloadLazyValues
+{
+    OCCborBuffer *buffer;
+    /** Position of the representation's map in buffer.*/
+    size_t offset;
+    /** Root maps also carry href, rt and if, which are not values.*/
+    bool isRoot;
+};
+
 static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent, bool isRoot);
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal);
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal,
+        OCCborBuffer *lazyBuffer);
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseSecurityPayload(OCPayload **outPayload, const uint8_t *payload, size_t size);
 
@@ -77,7 +98,7 @@ OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
             result = OCParsePlatformPayload(outPayload, &rootValue);
             break;
         case PAYLOAD_TYPE_REPRESENTATION:
-            result = OCParseRepPayload(outPayload, &rootValue);
+            result = OCParseRepPayload(outPayload, &rootValue, NULL);
             break;
         case PAYLOAD_TYPE_PRESENCE:
             result = OCParsePresencePayload(outPayload, &rootValue);
@@ -100,6 +121,69 @@ exit:
     return result;
 }
 
+static OCCborBuffer *OCCborBufferCreate(const uint8_t *payload, size_t size)
+{
+    OCCborBuffer *buffer = (OCCborBuffer *)OICMalloc(sizeof(OCCborBuffer) + size);
+    if (buffer)
+    {
+        buffer->refCount = 1;
+        buffer->size = size;
+        memcpy(buffer->data, payload, size);
+    }
+    return buffer;
+}
+
+static void OCCborBufferRetain(OCCborBuffer *buffer)
+{
+    __atomic_add_fetch(&buffer->refCount, 1, __ATOMIC_RELAXED);
+}
+
+static void OCCborBufferRelease(OCCborBuffer *buffer)
+{
+    if (buffer && 0 == __atomic_sub_fetch(&buffer->refCount, 1, __ATOMIC_ACQ_REL))
+    {
+        OICFree(buffer);
+    }
+}
+
+OCStackResult OCParsePayloadLazy(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize)
+{
+    if (PAYLOAD_TYPE_REPRESENTATION != payloadType)
+    {
+        return OCParsePayload(outPayload, payloadType, payload, payloadSize);
+    }
+
+    OCStackResult result = OC_STACK_INVALID_PARAM;
+    OCCborBuffer *buffer = NULL;
+    CborError err;
+
+    VERIFY_PARAM_NON_NULL(TAG, outPayload, "Conversion of outPayload failed");
+    VERIFY_PARAM_NON_NULL(TAG, payload, "Invalid cbor payload value");
+
+    OIC_LOG_V(INFO, TAG, "Lazy CBOR Parsing size: %zu", payloadSize);
+    OIC_LOG_BUFFER(DEBUG, TAG, payload, payloadSize);
+
+    // One copy of the whole buffer instead of one allocation per value
+    result = OC_STACK_NO_MEMORY;
+    buffer = OCCborBufferCreate(payload, payloadSize);
+    VERIFY_PARAM_NON_NULL(TAG, buffer, "Failed allocating lazy payload buffer");
+
+    CborParser parser;
+    CborValue rootValue;
+
+    result = OC_STACK_MALFORMED_RESPONSE;
+    err = cbor_parser_init(buffer->data, buffer->size, 0, &parser, &rootValue);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed initializing init value")
+
+    result = OCParseRepPayload(outPayload, &rootValue, buffer);
+
+exit:
+    // Every lazy representation holds its own reference
+    OCCborBufferRelease(buffer);
+    return result;
+}
+
 void OCFreeOCStringLL(OCStringLL* ll);
 
 static OCStackResult OCParseSecurityPayload(OCPayload** outPayload, const uint8_t *payload,
@@ -937,11 +1021,132 @@ exit:
     return err;
 }
 
+static bool OCIsRootOnlyName(const char *name)
+{
+    return (0 == strcmp(OC_RSRVD_HREF, name)) ||
+           (0 == strcmp(OC_RSRVD_RESOURCE_TYPE, name)) ||
+           (0 == strcmp(OC_RSRVD_INTERFACE, name));
+}
+
+static OCRepPayloadLazyValues *OCRepPayloadLazyCreate(OCCborBuffer *buffer,
+        const CborValue *map, bool isRoot)
+{
+    OCRepPayloadLazyValues *lazy =
+        (OCRepPayloadLazyValues *)OICCalloc(1, sizeof(OCRepPayloadLazyValues));
+    if (lazy)
+    {
+        OCCborBufferRetain(buffer);
+        lazy->buffer = buffer;
+        // tinycbor keeps the position of the current item in CborValue::ptr
+        lazy->offset = map->ptr - buffer->data;
+        lazy->isRoot = isRoot;
+    }
+    return lazy;
+}
+
+/**
+ * Decodes the value at repMap and sets it on curPayload under name.  With a lazyBuffer,
+ * nested objects are not decoded but point back into it; repMap is then left after them.
+ */
+static CborError OCParseRepValue(OCRepPayload *curPayload, const char *name, CborValue *repMap,
+        OCCborBuffer *lazyBuffer)
+{
+    CborError err = CborNoError;
+    bool res = false;
+    size_t len = 0;
+
+    CborType type = cbor_value_get_type(repMap);
+    switch (type)
+    {
+        case CborNullType:
+            res = OCRepPayloadSetNull(curPayload, name);
+            break;
+        case CborIntegerType:
+            {
+                int64_t intval = 0;
+                err = cbor_value_get_int64(repMap, &intval);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
+                res = OCRepPayloadSetPropInt(curPayload, name, intval);
+            }
+            break;
+        case CborDoubleType:
+            {
+                double doubleval = 0;
+                err = cbor_value_get_double(repMap, &doubleval);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
+                res = OCRepPayloadSetPropDouble(curPayload, name, doubleval);
+            }
+            break;
+        case CborBooleanType:
+            {
+                bool boolval = false;
+                err = cbor_value_get_boolean(repMap, &boolval);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
+                res = OCRepPayloadSetPropBool(curPayload, name, boolval);
+            }
+            break;
+        case CborTextStringType:
+            {
+                char *strval = NULL;
+                err = cbor_value_dup_text_string(repMap, &strval, &len, NULL);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
+                res = OCRepPayloadSetPropStringAsOwner(curPayload, name, strval);
+            }
+            break;
+        case CborByteStringType:
+            {
+                uint8_t* bytestrval = NULL;
+                err = cbor_value_dup_byte_string(repMap, &bytestrval, &len, NULL);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
+                OCByteString tmp = {.bytes = bytestrval, .len = len};
+                res = OCRepPayloadSetPropByteStringAsOwner(curPayload, name, &tmp);
+            }
+            break;
+        case CborMapType:
+            {
+                OCRepPayload *pl = NULL;
+                if (lazyBuffer)
+                {
+                    pl = OCRepPayloadCreate();
+                    if (pl)
+                    {
+                        pl->lazy = OCRepPayloadLazyCreate(lazyBuffer, repMap, false);
+                    }
+                    err = (pl && pl->lazy) ? cbor_value_advance(repMap) : CborErrorOutOfMemory;
+                    if (CborNoError != err)
+                    {
+                        OCRepPayloadDestroy(pl);
+                        return err;
+                    }
+                }
+                else
+                {
+                    err = OCParseSingleRepPayload(&pl, repMap, false);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
+                }
+                res = OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
+            }
+            break;
+        case CborArrayType:
+            err = OCParseArray(curPayload, name, repMap);
+            break;
+        default:
+            OIC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", repMap->type);
+            res = false;
+    }
+    if (type != CborArrayType)
+    {
+        err = (CborError) !res;
+    }
+
+exit:
+    return err;
+}
+
 static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap, bool isRoot)
 {
     CborError err = CborUnknownError;
     char *name = NULL;
-    bool res = false;
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "Invalid Parameter outPayload");
     VERIFY_PARAM_NON_NULL(TAG, objMap, "Invalid Parameter objMap");
 
@@ -971,11 +1176,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed finding tag name in the map");
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing rootMap");
-                if (name &&
-                    isRoot &&
-                    ((0 == strcmp(OC_RSRVD_HREF, name)) ||
-                     (0 == strcmp(OC_RSRVD_RESOURCE_TYPE, name)) ||
-                    (0 == strcmp(OC_RSRVD_INTERFACE, name))))
+                if (name && isRoot && OCIsRootOnlyName(name))
                 {
                     err = cbor_value_advance(&repMap);
                     OICFree(name);
@@ -983,71 +1184,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 }
             }
             CborType type = cbor_value_get_type(&repMap);
-            switch (type)
-            {
-                case CborNullType:
-                    res = OCRepPayloadSetNull(curPayload, name);
-                    break;
-                case CborIntegerType:
-                    {
-                        int64_t intval = 0;
-                        err = cbor_value_get_int64(&repMap, &intval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
-                        res = OCRepPayloadSetPropInt(curPayload, name, intval);
-                    }
-                    break;
-                case CborDoubleType:
-                    {
-                        double doubleval = 0;
-                        err = cbor_value_get_double(&repMap, &doubleval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
-                        res = OCRepPayloadSetPropDouble(curPayload, name, doubleval);
-                    }
-                    break;
-                case CborBooleanType:
-                    {
-                        bool boolval = false;
-                        err = cbor_value_get_boolean(&repMap, &boolval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
-                        res = OCRepPayloadSetPropBool(curPayload, name, boolval);
-                    }
-                    break;
-                case CborTextStringType:
-                    {
-                        char *strval = NULL;
-                        err = cbor_value_dup_text_string(&repMap, &strval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
-                        res = OCRepPayloadSetPropStringAsOwner(curPayload, name, strval);
-                    }
-                    break;
-                case CborByteStringType:
-                    {
-                        uint8_t* bytestrval = NULL;
-                        err = cbor_value_dup_byte_string(&repMap, &bytestrval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
-                        OCByteString tmp = {.bytes = bytestrval, .len = len};
-                        res = OCRepPayloadSetPropByteStringAsOwner(curPayload, name, &tmp);
-                    }
-                    break;
-                case CborMapType:
-                    {
-                        OCRepPayload *pl = NULL;
-                        err = OCParseSingleRepPayload(&pl, &repMap, false);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
-                        res = OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
-                    }
-                    break;
-                case CborArrayType:
-                    err = OCParseArray(curPayload, name, &repMap);
-                    break;
-                default:
-                    OIC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", repMap.type);
-                    res = false;
-            }
-            if (type != CborArrayType)
-            {
-                err = (CborError) !res;
-            }
+            err = OCParseRepValue(curPayload, name, &repMap, NULL);
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting value");
 
             if (type != CborMapType && cbor_value_is_valid(&repMap))
@@ -1073,7 +1210,8 @@ exit:
     return err;
 }
 
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root,
+        OCCborBuffer *lazyBuffer)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     CborError err;
@@ -1136,7 +1274,16 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
             }
         }
 
-        if (cbor_value_is_map(&rootMap))
+        if (cbor_value_is_map(&rootMap) && lazyBuffer)
+        {
+            ret = OC_STACK_NO_MEMORY;
+            temp->lazy = OCRepPayloadLazyCreate(lazyBuffer, &rootMap, true);
+            VERIFY_PARAM_NON_NULL(TAG, temp->lazy, "Failed allocating lazy values");
+            ret = OC_STACK_MALFORMED_RESPONSE;
+            err = cbor_value_advance(&rootMap);
+            VERIFY_CBOR_SUCCESS(TAG, err, "Failed to skip single rep payload");
+        }
+        else if (cbor_value_is_map(&rootMap))
         {
             err = OCParseSingleRepPayload(&temp, &rootMap, true);
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed to parse single rep payload");
@@ -1169,6 +1316,184 @@ exit:
     return ret;
 }
 
+static CborError OCRepPayloadLazyEnter(const OCRepPayloadLazyValues *lazy, CborParser *parser,
+        CborValue *map)
+{
+    CborError err = cbor_parser_init(lazy->buffer->data + lazy->offset,
+            lazy->buffer->size - lazy->offset, 0, parser, map);
+    if (CborNoError == err && !cbor_value_is_map(map))
+    {
+        err = CborErrorIllegalType;
+    }
+    return err;
+}
+
+static CborError OCRepPayloadLazyFind(const OCRepPayload *payload, const char *name,
+        CborParser *parser, CborValue *value)
+{
+    CborValue map;
+    CborError err = OCRepPayloadLazyEnter(payload->lazy, parser, &map);
+    if (CborNoError == err)
+    {
+        err = cbor_value_map_find_value(&map, name, value);
+    }
+    return err;
+}
+
+OCRepPayloadValue* OCRepPayloadLazyFindValue(OCRepPayload* payload, const char* name)
+{
+    if (!payload || !payload->lazy || !name ||
+        (payload->lazy->isRoot && OCIsRootOnlyName(name)))
+    {
+        return NULL;
+    }
+
+    CborParser parser;
+    CborValue value;
+    CborError err = OCRepPayloadLazyFind(payload, name, &parser, &value);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed looking up lazy value");
+    if (!cbor_value_is_valid(&value))
+    {
+        return NULL;
+    }
+
+    err = OCParseRepValue(payload, name, &value, payload->lazy->buffer);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed decoding lazy value");
+
+    for (OCRepPayloadValue *val = payload->values; val; val = val->next)
+    {
+        if (0 == strcmp(val->name, name))
+        {
+            return val;
+        }
+    }
+
+exit:
+    return NULL;
+}
+
+bool OCRepPayloadLazyGetStringView(const OCRepPayload* payload, const char* name,
+        OCRepPayloadPropType type, const uint8_t** value, size_t* len)
+{
+    if (!payload || !payload->lazy || !name || !value || !len ||
+        (payload->lazy->isRoot && OCIsRootOnlyName(name)))
+    {
+        return false;
+    }
+
+    CborParser parser;
+    CborValue str;
+    size_t strLen = 0;
+    CborError err = OCRepPayloadLazyFind(payload, name, &parser, &str);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed looking up lazy string");
+
+    if ((OCREP_PROP_STRING == type && !cbor_value_is_text_string(&str)) ||
+        (OCREP_PROP_BYTE_STRING == type && !cbor_value_is_byte_string(&str)) ||
+        !cbor_value_is_length_known(&str))
+    {
+        return false;
+    }
+
+    err = cbor_value_calculate_string_length(&str, &strLen);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting lazy string length");
+
+    // A definite length string ends where the next item starts
+    CborValue next = str;
+    err = cbor_value_advance(&next);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed skipping lazy string");
+
+    *value = next.ptr - strLen;
+    *len = strLen;
+    return true;
+
+exit:
+    return false;
+}
+
+bool OCRepPayloadDecodeLazyValues(OCRepPayload* payload)
+{
+    if (!payload)
+    {
+        return false;
+    }
+    if (!payload->lazy)
+    {
+        return true;
+    }
+
+    CborParser parser;
+    CborValue map;
+    CborValue repMap;
+    char *name = NULL;
+    size_t len = 0;
+
+    CborError err = OCRepPayloadLazyEnter(payload->lazy, &parser, &map);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed entering lazy map");
+    err = cbor_value_enter_container(&map, &repMap);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed entering lazy map");
+
+    while (cbor_value_is_valid(&repMap))
+    {
+        err = cbor_value_is_text_string(&repMap) ?
+            cbor_value_dup_text_string(&repMap, &name, &len, NULL) : CborErrorIllegalType;
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed finding tag name in the map");
+        err = cbor_value_advance(&repMap);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing lazy map");
+
+        // Values already looked up or set by the application win over the CBOR
+        bool decoded = false;
+        for (OCRepPayloadValue *val = payload->values; val && !decoded; val = val->next)
+        {
+            decoded = (0 == strcmp(val->name, name));
+        }
+        if (!decoded && !(payload->lazy->isRoot && OCIsRootOnlyName(name)))
+        {
+            CborValue value = repMap;
+            err = OCParseRepValue(payload, name, &value, NULL);
+            VERIFY_CBOR_SUCCESS(TAG, err, "Failed decoding lazy value");
+        }
+        OICFree(name);
+        name = NULL;
+
+        err = cbor_value_advance(&repMap);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing lazy map");
+    }
+
+    OCRepPayloadLazyDestroy(payload->lazy);
+    payload->lazy = NULL;
+    return true;
+
+exit:
+    OICFree(name);
+    return false;
+}
+
+OCRepPayloadLazyValues* OCRepPayloadLazyClone(const OCRepPayloadLazyValues* lazy)
+{
+    if (!lazy)
+    {
+        return NULL;
+    }
+
+    OCRepPayloadLazyValues *clone =
+        (OCRepPayloadLazyValues *)OICMalloc(sizeof(OCRepPayloadLazyValues));
+    if (clone)
+    {
+        *clone = *lazy;
+        OCCborBufferRetain(clone->buffer);
+    }
+    return clone;
+}
+
+void OCRepPayloadLazyDestroy(OCRepPayloadLazyValues* lazy)
+{
+    if (lazy)
+    {
+        OCCborBufferRelease(lazy->buffer);
+        OICFree(lazy);
+    }
+}
+
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *rootValue)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
@@ -357,27 +357,6 @@ uint8_t IsCollectionResource (OCResource *resource)
     return 0;
 }
 
-OCResource *FindResourceByUri(const char* resourceUri)
-{
-    if(!resourceUri)
-    {
-        return NULL;
-    }
-
-    OCResource * pointer = headResource;
-    while (pointer)
-    {
-        if (strcmp(resourceUri, pointer->uri) == 0)
-        {
-            return pointer;
-        }
-        pointer = pointer->next;
-    }
-    OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
-    return NULL;
-}
-
-
 OCStackResult DetermineResourceHandling (const OCServerRequest *request,
                                          ResourceHandling *handling,
                                          OCResource **resource)
@@ -584,6 +563,33 @@ static bool includeThisResourceInResponse(OCResource *resource,
 
 }
 
+/*
+ * Look up in the resource type or interface index the resources that can match
+ * the discovery filters. Returns false if every resource has to be checked.
+ */
+static bool findDiscoveryCandidates(char *interfaceFilter, char *resourceTypeFilter,
+                                    OCResource ***candidates, size_t *numCandidates)
+{
+#ifdef WITH_RD
+    // The resource directory answers filtered queries for the resources it hosts.
+    if (FindResourceByUri(OC_RSRVD_RD_URI))
+    {
+        return false;
+    }
+#endif
+    if (resourceTypeFilter && *resourceTypeFilter)
+    {
+        *candidates = FindResourcesByType(resourceTypeFilter, numCandidates);
+        return true;
+    }
+    if (interfaceFilter && *interfaceFilter)
+    {
+        *candidates = FindResourcesByInterface(interfaceFilter, numCandidates);
+        return true;
+    }
+    return false;
+}
+
 OCStackResult SendNonPersistantDiscoveryResponse(OCServerRequest *request, OCResource *resource,
                                 OCPayload *discoveryPayload, OCEntityHandlerResult ehResult)
 {
@@ -782,48 +788,67 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
                         VERIFY_NON_NULL(discPayload->interface, ERROR, OC_STACK_NO_MEMORY);
                     }
                     bool foundResourceAtRD = false;
-                    for (;resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+                    OCResource **candidates = NULL;
+                    size_t numCandidates = 0;
+                    if (findDiscoveryCandidates(interfaceQuery, resourceTypeQuery,
+                                                &candidates, &numCandidates))
                     {
-#ifdef WITH_RD
-                        if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
+                        for (size_t i = 0;
+                             i < numCandidates && discoveryResult == OC_STACK_OK; i++)
                         {
-                            OCResource *resource1 = NULL;
-                            OCDevAddr devAddr;
-                            discoveryResult = checkResourceExistsAtRD(interfaceQuery,
-                                resourceTypeQuery, &resource1, &devAddr);
-                            if (discoveryResult != OC_STACK_OK)
-                            {
-                                 break;
-                            }
-                            discoveryResult = BuildVirtualResourceResponse(resource1,
-                                discPayload, &devAddr, true);
-                            if (payload)
+                            if (includeThisResourceInResponse(candidates[i], interfaceQuery,
+                                                              resourceTypeQuery))
                             {
-                                discPayload->baseURI = OICStrdup(devAddr.addr);
+                                discoveryResult = BuildVirtualResourceResponse(candidates[i],
+                                    discPayload, &request->devAddr, false);
                             }
-                            OICFree(resource1->uri);
-                            for (OCResourceType *rsrcRt = resource1->rsrcType, *rsrcRtNext = NULL; rsrcRt; )
+                        }
+                    }
+                    else
+                    {
+                        for (;resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+                        {
+#ifdef WITH_RD
+                            if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
                             {
-                                rsrcRtNext = rsrcRt->next;
-                                OICFree(rsrcRt->resourcetypename);
-                                OICFree(rsrcRt);
-                                rsrcRt = rsrcRtNext;
+                                OCResource *resource1 = NULL;
+                                OCDevAddr devAddr;
+                                discoveryResult = checkResourceExistsAtRD(interfaceQuery,
+                                    resourceTypeQuery, &resource1, &devAddr);
+                                if (discoveryResult != OC_STACK_OK)
+                                {
+                                     break;
+                                }
+                                discoveryResult = BuildVirtualResourceResponse(resource1,
+                                    discPayload, &devAddr, true);
+                                if (payload)
+                                {
+                                    discPayload->baseURI = OICStrdup(devAddr.addr);
+                                }
+                                OICFree(resource1->uri);
+                                for (OCResourceType *rsrcRt = resource1->rsrcType, *rsrcRtNext = NULL; rsrcRt; )
+                                {
+                                    rsrcRtNext = rsrcRt->next;
+                                    OICFree(rsrcRt->resourcetypename);
+                                    OICFree(rsrcRt);
+                                    rsrcRt = rsrcRtNext;
+                                }
+
+                                for (OCResourceInterface *rsrcPtr = resource1->rsrcInterface, *rsrcNext = NULL; rsrcPtr; )
+                                {
+                                    rsrcNext = rsrcPtr->next;
+                                    OICFree(rsrcPtr->name);
+                                    OICFree(rsrcPtr);
+                                    rsrcPtr = rsrcNext;
+                                }
+                                foundResourceAtRD = true;
                             }
-
-                            for (OCResourceInterface *rsrcPtr = resource1->rsrcInterface, *rsrcNext = NULL; rsrcPtr; )
+#endif
+                            if (!foundResourceAtRD && includeThisResourceInResponse(resource, interfaceQuery, resourceTypeQuery))
                             {
-                                rsrcNext = rsrcPtr->next;
-                                OICFree(rsrcPtr->name);
-                                OICFree(rsrcPtr);
-                                rsrcPtr = rsrcNext;
+                                discoveryResult = BuildVirtualResourceResponse(resource,
+                                    discPayload, &request->devAddr, false);
                             }
-                            foundResourceAtRD = true;
-                        }
-#endif
-                        if (!foundResourceAtRD && includeThisResourceInResponse(resource, interfaceQuery, resourceTypeQuery))
-                        {
-                            discoveryResult = BuildVirtualResourceResponse(resource,
-                                discPayload, &request->devAddr, false);
                         }
                     }
                     // Set discoveryResult appropriately if no 'valid' resources are available
@@ -924,7 +949,7 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
         SendPresenceNotification(resource->rsrcType, OC_PRESENCE_TRIGGER_CHANGE);
     }
     else
-    #endif
+#endif
 #ifdef ROUTING_GATEWAY
     // Gateway uses the RMHandleGatewayRequest to respond to the request.
     if (OC_GATEWAY_URI != virtualUriInRequest)
@@ -984,8 +1009,11 @@ HandleDefaultDeviceEntityHandler (OCServerRequest *request)
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
     // At this point we know for sure that defaultDeviceHandler exists
+    // The stack lock is not held while application code runs
+    uint32_t lockDepth = OCStackUnlockAll();
     ehResult = defaultDeviceHandler(OC_REQUEST_FLAG, &ehRequest,
                                   (char*) request->resourceUrl, defaultDeviceHandlerCallbackParameter);
+    OCStackRelock(lockDepth);
     if(ehResult == OC_EH_SLOW)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
@@ -1140,7 +1168,12 @@ HandleResourceWithEntityHandler (OCServerRequest *request,
         goto exit;
     }
 
-    ehResult = resource->entityHandler(ehFlag, &ehRequest, resource->entityHandlerCallbackParam);
+    // The stack lock is not held while application code runs
+    OCEntityHandler entityHandler = resource->entityHandler;
+    void *entityHandlerCallbackParam = resource->entityHandlerCallbackParam;
+    uint32_t lockDepth = OCStackUnlockAll();
+    ehResult = entityHandler(ehFlag, &ehRequest, entityHandlerCallbackParam);
+    OCStackRelock(lockDepth);
     if(ehResult == OC_EH_SLOW)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
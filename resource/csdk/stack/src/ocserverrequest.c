@@ -22,6 +22,7 @@
 #include "ocstack.h"
 #include "ocserverrequest.h"
 #include "ocresourcehandler.h"
+#include "ocobserve.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "ocpayload.h"
@@ -43,6 +44,9 @@
 
 #define TAG  "OIC_RI_SERVERREQUEST"
 
+/** Arena room reserved past the request itself for its token and response options. */
+#define SERVER_REQUEST_ARENA_EXTRA (CA_MAX_TOKEN_LEN + 2 * sizeof(CAHeaderOption_t))
+
 static struct OCServerRequest * serverRequestList = NULL;
 static struct OCServerResponse * serverResponseList = NULL;
 
@@ -100,8 +104,8 @@ static void DeleteServerRequest(OCServerRequest * serverRequest)
     if(serverRequest)
     {
         LL_DELETE(serverRequestList, serverRequest);
-        OICFree(serverRequest->requestToken);
-        OICFree(serverRequest);
+        // The token, shared observer ids and the request itself all live in the arena
+        OICArenaDestroy(serverRequest->arena);
         serverRequest = NULL;
         OIC_LOG(INFO, TAG, "Server Request Removed!!");
     }
@@ -176,6 +180,48 @@ static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t
     return OC_STACK_OK;
 }
 
+/**
+ * Send a notification that was encoded for the observer of a request to the other
+ * observers sharing it. Only the destination, the token and the message type change.
+ *
+ * @param serverRequest Notification request of the first observer.
+ * @param responseInfo Response sent to the first observer.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendSharedNotification(const OCServerRequest *serverRequest,
+                                            CAResponseInfo_t *responseInfo)
+{
+    OCStackResult result = OC_STACK_OK;
+    CAResponseInfo_t sharedInfo = *responseInfo;
+
+    for (size_t i = 0; i < serverRequest->numSharedObservers; i++)
+    {
+        ResourceObserver *observer = GetObserverUsingId(serverRequest->sharedObserverIds[i]);
+        if (!observer || strcmp(observer->resUri, serverRequest->resourceUrl) != 0)
+        {
+            // The observer has deregistered meanwhile.
+            continue;
+        }
+
+        OCQualityOfService qos = GetObserverNotificationQoS(observer, serverRequest->sharedQos);
+        sharedInfo.info.type = (OC_HIGH_QOS == qos) ? CA_MSG_CONFIRM : CA_MSG_NONCONFIRM;
+        sharedInfo.info.token = observer->token;
+        sharedInfo.info.tokenLength = observer->tokenLength;
+
+        CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
+        CopyDevAddrToEndpoint(&observer->devAddr, &endpoint);
+
+        OCStackResult tempResult = OCSendResponse(&endpoint, &sharedInfo);
+        if (OC_STACK_OK != tempResult)
+        {
+            result = tempResult;
+        }
+    }
+
+    return result;
+}
+
 //-------------------------------------------------------------------------------------------------
 // Internal APIs
 //-------------------------------------------------------------------------------------------------
@@ -272,13 +318,20 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
     }
 
     OCServerRequest * serverRequest = NULL;
+    OICArena * arena = NULL;
 
+    VERIFY_NON_NULL(devAddr);
     OIC_LOG_V(INFO, TAG, "addserverrequest entry!! [%s:%u]", devAddr->addr, devAddr->port);
 
-    serverRequest = (OCServerRequest *) OICCalloc(1, sizeof(OCServerRequest) +
-        (reqTotalSize ? reqTotalSize : 1) - 1);
-    VERIFY_NON_NULL(devAddr);
+    // One allocation serves the request, its token and the per-response scratch
+    // data; everything is released together in DeleteServerRequest.
+    size_t requestSize = sizeof(OCServerRequest) + (reqTotalSize ? reqTotalSize : 1) - 1;
+    arena = OICArenaCreate(requestSize + SERVER_REQUEST_ARENA_EXTRA);
+    VERIFY_NON_NULL(arena);
+
+    serverRequest = (OCServerRequest *) OICArenaCalloc(arena, 1, requestSize);
     VERIFY_NON_NULL(serverRequest);
+    serverRequest->arena = arena;
 
     serverRequest->coapID = coapID;
     serverRequest->delayedResNeeded = delayedResNeeded;
@@ -318,7 +371,7 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
         // particular library implementation (it may or may not be a null pointer).
         if (tokenLength)
         {
-            serverRequest->requestToken = (CAToken_t) OICMalloc(tokenLength);
+            serverRequest->requestToken = (CAToken_t) OICArenaAlloc(arena, tokenLength);
             VERIFY_NON_NULL(serverRequest->requestToken);
             memcpy(serverRequest->requestToken, requestToken, tokenLength);
         }
@@ -340,11 +393,7 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
     return OC_STACK_OK;
 
 exit:
-    if (serverRequest)
-    {
-        OICFree(serverRequest);
-        serverRequest = NULL;
-    }
+    OICArenaDestroy(arena);
     *request = NULL;
     return OC_STACK_NO_MEMORY;
 }
@@ -378,7 +427,7 @@ OCStackResult FormOCEntityHandlerRequest(
 
         if(payload && payloadSize)
         {
-            if(OCParsePayload(&entityHandlerRequest->payload, payloadType,
+            if(OCParseReceivedPayload(&entityHandlerRequest->payload, payloadType,
                         payload, payloadSize) != OC_STACK_OK)
             {
                 return OC_STACK_ERROR;
@@ -547,7 +596,8 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     if(responseInfo.info.numOptions > 0)
     {
         responseInfo.info.options = (CAHeaderOption_t *)
-                                      OICCalloc(responseInfo.info.numOptions,
+                                      OICArenaCalloc(serverRequest->arena,
+                                              responseInfo.info.numOptions,
                                               sizeof(CAHeaderOption_t));
 
         if(!responseInfo.info.options)
@@ -617,7 +667,6 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
                         != OC_STACK_OK)
                 {
                     OIC_LOG(ERROR, TAG, "Error converting payload");
-                    OICFree(responseInfo.info.options);
                     return result;
                 }
                 responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
@@ -686,9 +735,17 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     result = OCSendResponse(&responseEndpoint, &responseInfo);
 #endif
 
+    if (serverRequest->numSharedObservers)
+    {
+        OCStackResult sharedResult = SendSharedNotification(serverRequest, &responseInfo);
+        if (OC_STACK_OK == result)
+        {
+            result = sharedResult;
+        }
+    }
+
     OICFree(responseInfo.info.payload);
-    OICFree(responseInfo.info.options);
-    //Delete the request
+    //Delete the request; this also releases the options allocated from its arena
     FindAndDeleteServerRequest(serverRequest);
     return result;
 }
@@ -735,15 +792,33 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
             VERIFY_NON_NULL(serverResponse);
         }
 
-        if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
+        OCRepPayload *newPayload = NULL;
+        if(ehResponse->payload->type == PAYLOAD_TYPE_ENCODED)
+        {
+            // The aggregate is re-encoded as one array, where each map also carries
+            // its href, so pre-encoded fragments are parsed back to be merged.
+            OCEncodedPayload *encoded = (OCEncodedPayload *)ehResponse->payload;
+            OCPayload *parsed = NULL;
+            stackRet = OCParsePayload(&parsed, PAYLOAD_TYPE_REPRESENTATION,
+                    encoded->data, encoded->size);
+            if (OC_STACK_OK != stackRet)
+            {
+                OIC_LOG(ERROR, TAG, "Error parsing encoded payload fragment");
+                goto exit;
+            }
+            newPayload = (OCRepPayload *)parsed;
+        }
+        else if(ehResponse->payload->type == PAYLOAD_TYPE_REPRESENTATION)
+        {
+            newPayload = OCRepPayloadClone((OCRepPayload *)ehResponse->payload);
+        }
+        else
         {
             stackRet = OC_STACK_ERROR;
             OIC_LOG(ERROR, TAG, "Error adding payload, as it was the incorrect type");
             goto exit;
         }
 
-        OCRepPayload *newPayload = OCRepPayloadClone((OCRepPayload *)ehResponse->payload);
-
         if(!serverResponse->payload)
         {
             serverResponse->payload = (OCPayload *)newPayload;
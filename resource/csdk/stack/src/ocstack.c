@@ -56,6 +56,7 @@
 #include "cainterface.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
+#include "oic_time.h"
 
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
 #include "routingutility.h"
@@ -79,12 +80,17 @@
 #endif
 #include "coap_time.h"
 #include "utlist.h"
+#include "uthash.h"
 #include "pdu.h"
 
 #ifndef ARDUINO
 #include <arpa/inet.h>
 #endif
 
+#ifdef WITH_POSIX
+#include <pthread.h>
+#endif
+
 #ifndef UINT32_MAX
 #define UINT32_MAX   (0xFFFFFFFFUL)
 #endif
@@ -107,6 +113,42 @@ typedef enum
 } OCPresenceState;
 #endif
 
+/**
+ * Node of the handle and URI lookup tables of a resource.
+ */
+typedef struct ResourceLookupNode
+{
+    /** Resource, also the key of the handle table.*/
+    OCResource *resource;
+
+    /** handle in the handle table.*/
+    UT_hash_handle handleHh;
+
+    /** handle in the URI table, keyed by the resource URI.*/
+    UT_hash_handle uriHh;
+} ResourceLookupNode;
+
+/**
+ * Resources bound to a resource type or interface name, in binding order.
+ */
+typedef struct ResourceIndexEntry
+{
+    /** Resource type or interface name.*/
+    char *name;
+
+    /** Resources bound to the name.*/
+    OCResource **resources;
+
+    /** Number of resources bound to the name.*/
+    size_t numResources;
+
+    /** Number of slots allocated in resources.*/
+    size_t capacity;
+
+    /** handle in the index.*/
+    UT_hash_handle hh;
+} ResourceIndexEntry;
+
 //-----------------------------------------------------------------------------
 // Private variables
 //-----------------------------------------------------------------------------
@@ -114,6 +156,10 @@ static OCStackState stackState = OC_STACK_UNINITIALIZED;
 
 OCResource *headResource = NULL;
 static OCResource *tailResource = NULL;
+static ResourceLookupNode *resourceHandleTable = NULL;
+static ResourceLookupNode *resourceUriTable = NULL;
+static ResourceIndexEntry *resourceTypeIndex = NULL;
+static ResourceIndexEntry *resourceInterfaceIndex = NULL;
 static OCResourceHandle platformResource = {0};
 static OCResourceHandle deviceResource = {0};
 #ifdef WITH_PRESENCE
@@ -130,9 +176,65 @@ static bool gRASetInfo = false;
 #endif
 OCDeviceEntityHandler defaultDeviceHandler;
 void* defaultDeviceHandlerCallbackParameter = NULL;
+static bool lazyPayloadParsing = false;
 static const char COAP_TCP[] = "coap+tcp:";
 static const char CORESPEC[] = "core";
 
+/**
+ * Time in microseconds at which OCProcess() has to run again for the stack timers,
+ * 0 if there is no pending timer. Updated at the end of every OCProcess() call.
+ * Accessed atomically: OCProcessWait() reads it without the stack lock, which is
+ * not even taken when no request dispatch threads are configured.
+ */
+static uint64_t g_nextProcessTime = 0;
+
+#ifdef WITH_POSIX
+/** Number of stripes requests are serialized on; a resource's URI selects its stripe. */
+#define REQUEST_DISPATCH_STRIPES (16)
+
+/**
+ * Complete server request waiting for a dispatch worker, together with what is needed to
+ * answer it should it fail after the request itself has been deleted.
+ */
+typedef struct RequestDispatchJob
+{
+    OCServerRequest *request;
+    bool reentrant;
+    size_t stripe;
+    OCMethod method;
+    CAEndpoint_t endpoint;
+    uint16_t messageId;
+    CAMessageType_t type;
+    uint8_t numOptions;
+    CAHeaderOption_t options[MAX_HEADER_OPTIONS];
+    char token[CA_MAX_TOKEN_LEN];
+    uint8_t tokenLength;
+    char resourceUri[MAX_URI_LENGTH];
+    struct RequestDispatchJob *prev;
+    struct RequestDispatchJob *next;
+} RequestDispatchJob;
+
+/** Number of dispatch workers requested through OCSetRequestDispatchThreads(). */
+static uint8_t g_requestDispatchThreads = 0;
+static pthread_t *g_requestDispatchWorkers = NULL;
+static RequestDispatchJob *g_requestDispatchQueue = NULL;
+static pthread_mutex_t g_requestDispatchMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_requestDispatchCond = PTHREAD_COND_INITIALIZER;
+static bool g_requestDispatchStop = false;
+static pthread_mutex_t g_resourceStripes[REQUEST_DISPATCH_STRIPES];
+
+/**
+ * Recursive lock over the stack's shared tables (resources, observers, server requests,
+ * client callbacks).  Only taken while dispatch workers are running.  Built on a plain
+ * mutex since recursive mutexes are not part of the POSIX.1-2001 base this file targets.
+ */
+static pthread_mutex_t g_stackLockMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_stackLockCond = PTHREAD_COND_INITIALIZER;
+static pthread_t g_stackLockOwner;
+static uint32_t g_stackLockDepth = 0;
+static bool g_stackLockEnabled = false;
+#endif
+
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
@@ -150,6 +252,8 @@ static const char CORESPEC[] = "core";
 #define MAX_OBSERVE_AGE (0x2FFFFUL)
 
 #define MILLISECONDS_PER_SECOND   (1000)
+#define USECS_PER_MSEC            (1000)
+#define USECS_PER_SEC             (1000000)
 
 //-----------------------------------------------------------------------------
 // Private internal function prototypes
@@ -162,6 +266,66 @@ static const char CORESPEC[] = "core";
  */
 static OCDoHandle GenerateInvocationHandle();
 
+#ifdef WITH_POSIX
+/**
+ * Start the request dispatch workers requested with OCSetRequestDispatchThreads().
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult StartRequestDispatch();
+
+/**
+ * Stop the request dispatch workers, dropping requests that are still queued.
+ */
+static void StopRequestDispatch();
+
+/**
+ * Queue a complete server request for a dispatch worker.
+ *
+ * @param request   Server request; must have an entity handler to run.
+ * @param resource  Resource the request was resolved to, NULL for the default device handler.
+ *
+ * @return ::OC_STACK_OK if the request was queued, some other value upon failure.
+ */
+static OCStackResult DispatchServerRequest(OCServerRequest *request, const OCResource *resource);
+#endif
+
+/*
+ * Bodies of the public entry points that touch shared stack tables. The public functions
+ * wrap them in OCStackLock()/OCStackUnlock().
+ */
+static OCStackResult DoResourceLocked(OCDoHandle *handle, OCMethod method,
+        const char *requestUri, const OCDevAddr *destination, OCPayload* payload,
+        OCConnectivityType connectivityType, OCQualityOfService qos, OCCallbackData *cbData,
+        OCHeaderOption *options, uint8_t numOptions);
+static OCStackResult CancelLocked(OCDoHandle handle, OCQualityOfService qos,
+        OCHeaderOption * options, uint8_t numOptions);
+static OCStackResult CreateResourceLocked(OCResourceHandle *handle,
+        const char *resourceTypeName, const char *resourceInterfaceName,
+        const char *uri, OCEntityHandler entityHandler, void* callbackParam,
+        uint8_t resourceProperties);
+static OCStackResult DeleteResourceLocked(OCResourceHandle handle);
+static OCStackResult BindResourceLocked(
+        OCResourceHandle collectionHandle, OCResourceHandle resourceHandle);
+static OCStackResult UnBindResourceLocked(
+        OCResourceHandle collectionHandle, OCResourceHandle resourceHandle);
+static OCStackResult BindResourceTypeToResourceLocked(OCResourceHandle handle,
+        const char *resourceTypeName);
+static OCStackResult BindResourceInterfaceToResourceLocked(OCResourceHandle handle,
+        const char *resourceInterfaceName);
+static OCStackResult BindResourceHandlerLocked(OCResourceHandle handle,
+        OCEntityHandler entityHandler,
+        void* callbackParam);
+
+/**
+ * Sends the direct stack response owed when handling a request did not produce a response:
+ * an empty ACK ahead of a slow response, or an error response.
+ */
+static void SendRequestResult(OCStackResult requestResult, OCMethod method,
+        const CAEndpoint_t *endPoint, uint16_t messageId, CAMessageType_t type,
+        uint8_t numOptions, const CAHeaderOption_t *options,
+        CAToken_t token, uint8_t tokenLength, const char *resourceUri);
+
 /**
  * Initialize resource data structures, variables, etc.
  *
@@ -185,6 +349,50 @@ static void insertResource(OCResource *resource);
  */
 static OCResource *findResource(OCResource *resource);
 
+/**
+ * Add a resource to the handle and URI lookup tables.
+ * The URI of the resource must be set.
+ *
+ * @param resource Resource to be added.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult insertResourceLookup(OCResource *resource);
+
+/**
+ * Remove a resource from the handle and URI lookup tables.
+ *
+ * @param resource Resource to be removed.
+ */
+static void deleteResourceLookup(OCResource *resource);
+
+/**
+ * Add a resource to the resources bound to a resource type or interface name.
+ *
+ * @param index Resource type or interface index.
+ * @param name Resource type or interface name.
+ * @param resource Resource bound to the name.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult insertResourceIndex(ResourceIndexEntry **index, const char *name,
+        OCResource *resource);
+
+/**
+ * Remove a resource from the resources bound to a resource type or interface name.
+ *
+ * @param index Resource type or interface index.
+ * @param name Resource type or interface name.
+ * @param resource Resource bound to the name.
+ */
+static void deleteResourceIndex(ResourceIndexEntry **index, const char *name,
+        OCResource *resource);
+
+/**
+ * Remove a resource from the index of each resource type bound to it.
+ *
+ * @param resource Resource whose resource types are unbound.
+ */
+static void deleteResourceTypeIndex(OCResource *resource);
+
 /**
  * Insert a resource type into a resource's resource type linked list.
  * If resource type already exists, it will not be inserted and the
@@ -194,8 +402,11 @@ static OCResource *findResource(OCResource *resource);
  *
  * @param resource Resource where resource type is to be inserted.
  * @param resourceType Resource type to be inserted.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_NO_MEMORY if the type could not be
+ *         indexed; the resource type is free'd and not inserted in that case.
  */
-static void insertResourceType(OCResource *resource,
+static OCStackResult insertResourceType(OCResource *resource,
         OCResourceType *resourceType);
 
 /**
@@ -217,8 +428,11 @@ static OCResourceType *findResourceTypeAtIndex(OCResourceHandle handle,
  *
  * @param resource Resource where resource interface is to be inserted.
  * @param resourceInterface Resource interface to be inserted.
+ *
+ * @return ::OC_STACK_OK on success, otherwise the error of indexing the interface or of
+ *         binding the default interface; the resource interface is free'd in that case.
  */
-static void insertResourceInterface(OCResource *resource,
+static OCStackResult insertResourceInterface(OCResource *resource,
         OCResourceInterface *resourceInterface);
 
 /**
@@ -407,6 +621,13 @@ static OCStackResult ResetPresenceTTL(ClientCB *cbNode, uint32_t maxAgeSeconds);
  */
 static OCStackResult OCSendRequest(const CAEndpoint_t *object, CARequestInfo_t *requestInfo);
 
+/**
+ * Get the earliest time at which one of the stack timers served by OCProcess() expires.
+ *
+ * @return Time in microseconds, 0 if there is no pending timer.
+ */
+static uint64_t GetNextProcessTime();
+
 //-----------------------------------------------------------------------------
 // Internal functions
 //-----------------------------------------------------------------------------
@@ -524,8 +745,13 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
             {
                 return result;
             }
-            observer->resource->entityHandler(OC_OBSERVE_FLAG, &ehRequest,
-                            observer->resource->entityHandlerCallbackParam);
+            // The stack lock is not held while application code runs;
+            // the observer is only looked up again by token afterwards.
+            OCEntityHandler entityHandler = observer->resource->entityHandler;
+            void *entityHandlerCallbackParam = observer->resource->entityHandlerCallbackParam;
+            uint32_t lockDepth = OCStackUnlockAll();
+            entityHandler(OC_OBSERVE_FLAG, &ehRequest, entityHandlerCallbackParam);
+            OCStackRelock(lockDepth);
         }
 
         result = DeleteObserverUsingToken (token, tokenLength);
@@ -576,8 +802,11 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
                 {
                     return OC_STACK_ERROR;
                 }
-                observer->resource->entityHandler(OC_OBSERVE_FLAG, &ehRequest,
-                                    observer->resource->entityHandlerCallbackParam);
+                OCEntityHandler entityHandler = observer->resource->entityHandler;
+                void *entityHandlerCallbackParam = observer->resource->entityHandlerCallbackParam;
+                uint32_t lockDepth = OCStackUnlockAll();
+                entityHandler(OC_OBSERVE_FLAG, &ehRequest, entityHandlerCallbackParam);
+                OCStackRelock(lockDepth);
 
                 result = DeleteObserverUsingToken (token, tokenLength);
                 if(result == OC_STACK_OK)
@@ -796,6 +1025,9 @@ static OCStackResult ResetPresenceTTL(ClientCB *cbNode, uint32_t maxAgeSeconds)
     cbNode->presence->TTLlevel = 0;
 
     OIC_LOG_V(DEBUG, TAG, "this TTL level %d", cbNode->presence->TTLlevel);
+
+    // The presence timeouts changed, let a thread blocked in OCProcessWait() pick them up.
+    OCProcessWakeup();
     return OC_STACK_OK;
 }
 
@@ -1244,7 +1476,7 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                     return;
                 }
 
-                if(OC_STACK_OK != OCParsePayload(&response.payload,
+                if(OC_STACK_OK != OCParseReceivedPayload(&response.payload,
                             type,
                             responseInfo->info.payload,
                             responseInfo->info.payloadSize))
@@ -1317,8 +1549,8 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                 else
                 {
                     // To keep discovery callbacks active.
-                    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
-                                            MILLISECONDS_PER_SECOND);
+                    SetClientCBTimeout(cbNode, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                        MILLISECONDS_PER_SECOND));
                 }
             }
 
@@ -1628,12 +1860,29 @@ OCStackResult HandleStackRequests(OCServerProtocolRequest * protocolRequest)
         OIC_LOG(INFO, TAG, "This is either a repeated or blocked Server Request");
     }
 
-    if(request->requestComplete)
+    if(request->dispatched)
+    {
+        OIC_LOG(INFO, TAG, "This Server Request is already queued to a dispatch worker");
+        result = OC_STACK_OK;
+    }
+    else if(request->requestComplete)
     {
         OIC_LOG(INFO, TAG, "This Server Request is complete");
         ResourceHandling resHandling = OC_RESOURCE_VIRTUAL;
         OCResource *resource = NULL;
         result = DetermineResourceHandling (request, &resHandling, &resource);
+#ifdef WITH_POSIX
+        // Requests that end up in an application entity handler go to the dispatch
+        // workers; stack internal resources are quick and still handled here.
+        if (result == OC_STACK_OK && g_requestDispatchWorkers &&
+            (resHandling == OC_RESOURCE_NOT_COLLECTION_WITH_ENTITYHANDLER ||
+             resHandling == OC_RESOURCE_COLLECTION_WITH_ENTITYHANDLER ||
+             resHandling == OC_RESOURCE_DEFAULT_DEVICE_ENTITYHANDLER) &&
+            DispatchServerRequest(request, resource) == OC_STACK_OK)
+        {
+            return OC_STACK_OK;
+        }
+#endif
         if (result == OC_STACK_OK)
         {
             result = ProcessRequest(resHandling, resource, request);
@@ -1647,6 +1896,276 @@ OCStackResult HandleStackRequests(OCServerProtocolRequest * protocolRequest)
     return result;
 }
 
+static void SendRequestResult(OCStackResult requestResult, OCMethod method,
+        const CAEndpoint_t *endPoint, uint16_t messageId, CAMessageType_t type,
+        uint8_t numOptions, const CAHeaderOption_t *options,
+        CAToken_t token, uint8_t tokenLength, const char *resourceUri)
+{
+    // Send ACK to client as precursor to slow response
+    if (requestResult == OC_STACK_SLOW_RESOURCE)
+    {
+        if (type == CA_MSG_CONFIRM)
+        {
+            SendDirectStackResponse(endPoint, messageId, CA_EMPTY,
+                                    CA_MSG_ACKNOWLEDGE,0, NULL, NULL, 0, NULL);
+        }
+    }
+    else if(requestResult != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "HandleStackRequests failed. error: %d", requestResult);
+
+        CAResponseResult_t stackResponse = OCToCAStackResult(requestResult, method);
+
+        SendDirectStackResponse(endPoint, messageId, stackResponse, type, numOptions,
+                options, token, tokenLength, resourceUri);
+    }
+}
+
+#ifdef WITH_POSIX
+static void ProcessDispatchedRequest(RequestDispatchJob *job)
+{
+    // Lock order: resource stripe first, then the stack lock
+    if (!job->reentrant)
+    {
+        pthread_mutex_lock(&g_resourceStripes[job->stripe]);
+    }
+    OCStackLock();
+
+    // The resource may have gone away while the request was queued
+    ResourceHandling resHandling = OC_RESOURCE_VIRTUAL;
+    OCResource *resource = NULL;
+    OCStackResult result = DetermineResourceHandling(job->request, &resHandling, &resource);
+    if (result == OC_STACK_OK)
+    {
+        result = ProcessRequest(resHandling, resource, job->request);
+    }
+
+    SendRequestResult(result, job->method, &job->endpoint, job->messageId, job->type,
+            job->numOptions, job->options, (CAToken_t)job->token, job->tokenLength,
+            job->resourceUri);
+
+    OCStackUnlock();
+    if (!job->reentrant)
+    {
+        pthread_mutex_unlock(&g_resourceStripes[job->stripe]);
+    }
+}
+
+static void *RequestDispatchWorker(void *context)
+{
+    (void)context;
+
+    pthread_mutex_lock(&g_requestDispatchMutex);
+    while (!g_requestDispatchStop)
+    {
+        RequestDispatchJob *job = g_requestDispatchQueue;
+        if (!job)
+        {
+            pthread_cond_wait(&g_requestDispatchCond, &g_requestDispatchMutex);
+            continue;
+        }
+        DL_DELETE(g_requestDispatchQueue, job);
+        pthread_mutex_unlock(&g_requestDispatchMutex);
+
+        ProcessDispatchedRequest(job);
+        OICFree(job);
+
+        pthread_mutex_lock(&g_requestDispatchMutex);
+    }
+    pthread_mutex_unlock(&g_requestDispatchMutex);
+    return NULL;
+}
+
+static OCStackResult DispatchServerRequest(OCServerRequest *request, const OCResource *resource)
+{
+    RequestDispatchJob *job = (RequestDispatchJob *) OICCalloc(1, sizeof(RequestDispatchJob));
+    if (!job)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory, handling request on the calling thread");
+        return OC_STACK_NO_MEMORY;
+    }
+
+    uint32_t hash = 5381;
+    for (const char *c = request->resourceUrl; *c; c++)
+    {
+        hash = hash * 33 + (uint8_t)*c;
+    }
+
+    job->request = request;
+    job->reentrant = resource && (resource->resourceProperties & OC_REENTRANT);
+    job->stripe = hash % REQUEST_DISPATCH_STRIPES;
+    job->method = request->method;
+    CopyDevAddrToEndpoint(&request->devAddr, &job->endpoint);
+    job->messageId = request->coapID;
+    job->type = (request->qos == OC_HIGH_QOS) ? CA_MSG_CONFIRM : CA_MSG_NONCONFIRM;
+    job->numOptions = request->numRcvdVendorSpecificHeaderOptions;
+    memcpy(job->options, request->rcvdVendorSpecificHeaderOptions,
+           sizeof(CAHeaderOption_t) * job->numOptions);
+    memcpy(job->token, request->requestToken, request->tokenLength);
+    job->tokenLength = request->tokenLength;
+    OICStrcpy(job->resourceUri, sizeof(job->resourceUri), request->resourceUrl);
+
+    request->dispatched = 1;
+
+    pthread_mutex_lock(&g_requestDispatchMutex);
+    DL_APPEND(g_requestDispatchQueue, job);
+    pthread_cond_signal(&g_requestDispatchCond);
+    pthread_mutex_unlock(&g_requestDispatchMutex);
+    return OC_STACK_OK;
+}
+
+static OCStackResult StartRequestDispatch()
+{
+    for (size_t i = 0; i < REQUEST_DISPATCH_STRIPES; i++)
+    {
+        pthread_mutex_init(&g_resourceStripes[i], NULL);
+    }
+
+    g_requestDispatchWorkers = (pthread_t *) OICCalloc(g_requestDispatchThreads,
+                                                       sizeof(pthread_t));
+    if (!g_requestDispatchWorkers)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    g_stackLockEnabled = true;
+    g_requestDispatchStop = false;
+    for (uint8_t i = 0; i < g_requestDispatchThreads; i++)
+    {
+        if (pthread_create(&g_requestDispatchWorkers[i], NULL, RequestDispatchWorker, NULL))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to start request dispatch worker");
+            g_requestDispatchThreads = i;
+            StopRequestDispatch();
+            return OC_STACK_ERROR;
+        }
+    }
+    OIC_LOG_V(INFO, TAG, "Started %u request dispatch workers", g_requestDispatchThreads);
+    return OC_STACK_OK;
+}
+
+static void StopRequestDispatch()
+{
+    if (!g_requestDispatchWorkers)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&g_requestDispatchMutex);
+    g_requestDispatchStop = true;
+    pthread_cond_broadcast(&g_requestDispatchCond);
+    pthread_mutex_unlock(&g_requestDispatchMutex);
+
+    for (uint8_t i = 0; i < g_requestDispatchThreads; i++)
+    {
+        pthread_join(g_requestDispatchWorkers[i], NULL);
+    }
+    OICFree(g_requestDispatchWorkers);
+    g_requestDispatchWorkers = NULL;
+
+    RequestDispatchJob *job = NULL;
+    RequestDispatchJob *tmp = NULL;
+    DL_FOREACH_SAFE(g_requestDispatchQueue, job, tmp)
+    {
+        DL_DELETE(g_requestDispatchQueue, job);
+        OICFree(job);
+    }
+
+    g_stackLockEnabled = false;
+    for (size_t i = 0; i < REQUEST_DISPATCH_STRIPES; i++)
+    {
+        pthread_mutex_destroy(&g_resourceStripes[i]);
+    }
+}
+#endif
+
+void OCStackLock()
+{
+#ifdef WITH_POSIX
+    if (!g_stackLockEnabled)
+    {
+        return;
+    }
+
+    pthread_t self = pthread_self();
+    pthread_mutex_lock(&g_stackLockMutex);
+    if (g_stackLockDepth && pthread_equal(g_stackLockOwner, self))
+    {
+        g_stackLockDepth++;
+    }
+    else
+    {
+        while (g_stackLockDepth)
+        {
+            pthread_cond_wait(&g_stackLockCond, &g_stackLockMutex);
+        }
+        g_stackLockOwner = self;
+        g_stackLockDepth = 1;
+    }
+    pthread_mutex_unlock(&g_stackLockMutex);
+#endif
+}
+
+void OCStackUnlock()
+{
+#ifdef WITH_POSIX
+    if (!g_stackLockEnabled)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&g_stackLockMutex);
+    if (g_stackLockDepth && --g_stackLockDepth == 0)
+    {
+        pthread_cond_signal(&g_stackLockCond);
+    }
+    pthread_mutex_unlock(&g_stackLockMutex);
+#endif
+}
+
+uint32_t OCStackUnlockAll()
+{
+    uint32_t depth = 0;
+#ifdef WITH_POSIX
+    if (!g_stackLockEnabled)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&g_stackLockMutex);
+    if (g_stackLockDepth && pthread_equal(g_stackLockOwner, pthread_self()))
+    {
+        depth = g_stackLockDepth;
+        g_stackLockDepth = 0;
+        pthread_cond_signal(&g_stackLockCond);
+    }
+    pthread_mutex_unlock(&g_stackLockMutex);
+#endif
+    return depth;
+}
+
+void OCStackRelock(uint32_t depth)
+{
+#ifdef WITH_POSIX
+    if (!depth)
+    {
+        return;
+    }
+
+    pthread_t self = pthread_self();
+    pthread_mutex_lock(&g_stackLockMutex);
+    while (g_stackLockDepth)
+    {
+        pthread_cond_wait(&g_stackLockCond, &g_stackLockMutex);
+    }
+    g_stackLockOwner = self;
+    g_stackLockDepth = depth;
+    pthread_mutex_unlock(&g_stackLockMutex);
+#else
+    (void) depth;
+#endif
+}
+
 void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* requestInfo)
 {
     OIC_LOG(DEBUG, TAG, "Enter OCHandleRequests");
@@ -1833,27 +2352,11 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
 
     requestResult = HandleStackRequests (&serverRequest);
 
-    // Send ACK to client as precursor to slow response
-    if (requestResult == OC_STACK_SLOW_RESOURCE)
-    {
-        if (requestInfo->info.type == CA_MSG_CONFIRM)
-        {
-            SendDirectStackResponse(endPoint, requestInfo->info.messageId, CA_EMPTY,
-                                    CA_MSG_ACKNOWLEDGE,0, NULL, NULL, 0, NULL);
-        }
-    }
-    else if(requestResult != OC_STACK_OK)
-    {
-        OIC_LOG_V(ERROR, TAG, "HandleStackRequests failed. error: %d", requestResult);
-
-        CAResponseResult_t stackResponse =
-            OCToCAStackResult(requestResult, serverRequest.method);
-
-        SendDirectStackResponse(endPoint, requestInfo->info.messageId, stackResponse,
-                requestInfo->info.type, requestInfo->info.numOptions,
-                requestInfo->info.options, requestInfo->info.token,
-                requestInfo->info.tokenLength, requestInfo->info.resourceUri);
-    }
+    SendRequestResult(requestResult, serverRequest.method, endPoint,
+            requestInfo->info.messageId, requestInfo->info.type,
+            requestInfo->info.numOptions, requestInfo->info.options,
+            requestInfo->info.token, requestInfo->info.tokenLength,
+            requestInfo->info.resourceUri);
     // requestToken is fed to HandleStackRequests, which then goes to AddServerRequest.
     // The token is copied in there, and is thus still owned by this function.
     OICFree(serverRequest.payload);
@@ -2124,6 +2627,13 @@ OCStackResult OCInit1(OCMode mode, OCTransportFlags serverFlags, OCTransportFlag
     }
 #endif
 
+#ifdef WITH_POSIX
+    if (result == OC_STACK_OK && g_requestDispatchThreads && myStackMode != OC_CLIENT)
+    {
+        result = StartRequestDispatch();
+    }
+#endif
+
 exit:
     if(result != OC_STACK_OK)
     {
@@ -2169,6 +2679,11 @@ OCStackResult OCStop()
     TerminateKeepAlive(myStackMode);
 #endif
 
+#ifdef WITH_POSIX
+    // Let running entity handlers finish before the tables they use go away
+    StopRequestDispatch();
+#endif
+
     // Free memory dynamically allocated for resources
     deleteAllResources();
     DeleteDeviceInfo();
@@ -2478,6 +2993,24 @@ OCStackResult OCDoResource(OCDoHandle *handle,
                             OCCallbackData *cbData,
                             OCHeaderOption *options,
                             uint8_t numOptions)
+{
+    OCStackLock();
+    OCStackResult result = DoResourceLocked(handle, method, requestUri, destination, payload,
+            connectivityType, qos, cbData, options, numOptions);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult DoResourceLocked(OCDoHandle *handle,
+                            OCMethod method,
+                            const char *requestUri,
+                            const OCDevAddr *destination,
+                            OCPayload* payload,
+                            OCConnectivityType connectivityType,
+                            OCQualityOfService qos,
+                            OCCallbackData *cbData,
+                            OCHeaderOption *options,
+                            uint8_t numOptions)
 {
     OIC_LOG(INFO, TAG, "Entering OCDoResource");
 
@@ -2624,7 +3157,17 @@ OCStackResult OCDoResource(OCDoHandle *handle,
 
     CopyDevAddrToEndpoint(devAddr, &endpoint);
 
-    if(payload)
+    if(payload && PAYLOAD_TYPE_ENCODED == payload->type)
+    {
+        // Already encoded, and owned by this call: hand the bytes over as they are
+        OCEncodedPayload *encoded = (OCEncodedPayload *)payload;
+        requestInfo.info.payload = encoded->data;
+        requestInfo.info.payloadSize = encoded->size;
+        requestInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+        encoded->data = NULL;
+        encoded->size = 0;
+    }
+    else if(payload)
     {
         if((result =
             OCConvertPayload(payload, &requestInfo.info.payload, &requestInfo.info.payloadSize))
@@ -2715,6 +3258,15 @@ exit:
 
 OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption * options,
         uint8_t numOptions)
+{
+    OCStackLock();
+    OCStackResult result = CancelLocked(handle, qos, options, numOptions);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult CancelLocked(OCDoHandle handle, OCQualityOfService qos,
+        OCHeaderOption * options, uint8_t numOptions)
 {
     /*
      * This ftn is implemented one of two ways in the case of observation:
@@ -2941,10 +3493,12 @@ exit:
 
 OCStackResult OCProcess()
 {
+    OCStackLock();
 #ifdef WITH_PRESENCE
     OCProcessPresence();
 #endif
     CAHandleRequestResponse();
+    DeleteTimedOutClientCBs();
 
 #ifdef ROUTING_GATEWAY
     RMProcess();
@@ -2953,9 +3507,114 @@ OCStackResult OCProcess()
 #ifdef TCP_ADAPTER
     ProcessKeepAlive();
 #endif
+
+    __atomic_store_n(&g_nextProcessTime, GetNextProcessTime(), __ATOMIC_RELAXED);
+    OCStackUnlock();
     return OC_STACK_OK;
 }
 
+OCStackResult OCProcessWait(uint32_t maxWaitMs)
+{
+    if (stackState != OC_STACK_INITIALIZED)
+    {
+        OIC_LOG(ERROR, TAG, "OCStack is not initalized. Cannot wait for process.");
+        return OC_STACK_ERROR;
+    }
+
+    uint64_t timeout = (uint64_t)maxWaitMs * USECS_PER_MSEC;
+    uint64_t nextProcessTime = __atomic_load_n(&g_nextProcessTime, __ATOMIC_RELAXED);
+    if (nextProcessTime)
+    {
+        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+        if (nextProcessTime <= currentTime)
+        {
+            return OC_STACK_OK;
+        }
+
+        uint64_t timerTimeout = nextProcessTime - currentTime;
+        if (!timeout || timerTimeout < timeout)
+        {
+            timeout = timerTimeout;
+        }
+    }
+
+    return CAResultToOCResult(CAWaitForRequestResponse(timeout));
+}
+
+void OCProcessWakeup()
+{
+    CAWakeupRequestResponse();
+}
+
+static uint64_t GetNextProcessTime()
+{
+    uint64_t nextTime = 0;
+
+    uint32_t cbTimeout = GetNextClientCBTimeout();
+    if (cbTimeout)
+    {
+        uint32_t now = GetTicks(0);
+        nextTime = OICGetCurrentTime(TIME_IN_US);
+        // Callbacks are deleted once their TTL is in the past.
+        if (cbTimeout >= now)
+        {
+            nextTime += ((uint64_t)(cbTimeout - now + 1) * USECS_PER_SEC) /
+                        COAP_TICKS_PER_SECOND;
+        }
+    }
+
+#ifdef WITH_PRESENCE
+    ClientCB* cbNode = NULL;
+    uint32_t now = GetTicks(0);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+
+    LL_FOREACH(cbList, cbNode)
+    {
+        if (OC_REST_PRESENCE != cbNode->method || !cbNode->presence ||
+            !cbNode->presence->timeOut || cbNode->presence->TTLlevel > PresenceTimeOutSize)
+        {
+            continue;
+        }
+
+        // The last TTL level reports the presence timeout on the next OCProcess().
+        uint64_t presenceTime = currentTime;
+        if (cbNode->presence->TTLlevel < PresenceTimeOutSize)
+        {
+            uint32_t timeOut = cbNode->presence->timeOut[cbNode->presence->TTLlevel];
+            if (timeOut > now)
+            {
+                presenceTime += ((uint64_t)(timeOut - now) * USECS_PER_SEC) /
+                                COAP_TICKS_PER_SECOND;
+            }
+        }
+
+        if (!nextTime || presenceTime < nextTime)
+        {
+            nextTime = presenceTime;
+        }
+    }
+#endif
+
+#ifdef TCP_ADAPTER
+    uint64_t keepAliveTime = GetNextKeepAliveTime();
+    if (keepAliveTime && (!nextTime || keepAliveTime < nextTime))
+    {
+        nextTime = keepAliveTime;
+    }
+#endif
+
+#ifdef ROUTING_GATEWAY
+    // Routing manager timers have a resolution of seconds.
+    uint64_t routingTime = OICGetCurrentTime(TIME_IN_US) + USECS_PER_SEC;
+    if (!nextTime || routingTime < nextTime)
+    {
+        nextTime = routingTime;
+    }
+#endif
+
+    return nextTime;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OCStartPresence(const uint32_t ttl)
 {
@@ -3042,6 +3701,37 @@ OCStackResult OCSetDefaultDeviceEntityHandler(OCDeviceEntityHandler entityHandle
     return OC_STACK_OK;
 }
 
+void OCSetLazyPayloadParsing(bool enable)
+{
+    lazyPayloadParsing = enable;
+}
+
+OCStackResult OCSetRequestDispatchThreads(uint8_t numThreads)
+{
+#ifdef WITH_POSIX
+    if (stackState != OC_STACK_UNINITIALIZED)
+    {
+        OIC_LOG(ERROR, TAG, "Request dispatch threads must be set before OCInit");
+        return OC_STACK_ERROR;
+    }
+    g_requestDispatchThreads = numThreads;
+    return OC_STACK_OK;
+#else
+    (void)numThreads;
+    return OC_STACK_NOTIMPL;
+#endif
+}
+
+OCStackResult OCParseReceivedPayload(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize)
+{
+    if (lazyPayloadParsing)
+    {
+        return OCParsePayloadLazy(outPayload, type, payload, payloadSize);
+    }
+    return OCParsePayload(outPayload, type, payload, payloadSize);
+}
+
 OCStackResult OCSetPlatformInfo(OCPlatformInfo platformInfo)
 {
     OIC_LOG(INFO, TAG, "Entering OCSetPlatformInfo");
@@ -3081,6 +3771,7 @@ OCStackResult OCSetDeviceInfo(OCDeviceInfo deviceInfo)
         {
             return OC_STACK_INVALID_PARAM;
         }
+        deleteResourceTypeIndex(resource);
         deleteResourceType(resource->rsrcType);
         resource->rsrcType = NULL;
 
@@ -3100,6 +3791,20 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         void* callbackParam,
         uint8_t resourceProperties)
 {
+    OCStackLock();
+    OCStackResult result = CreateResourceLocked(handle, resourceTypeName,
+            resourceInterfaceName, uri, entityHandler, callbackParam, resourceProperties);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult CreateResourceLocked(OCResourceHandle *handle,
+        const char *resourceTypeName,
+        const char *resourceInterfaceName,
+        const char *uri, OCEntityHandler entityHandler,
+        void* callbackParam,
+        uint8_t resourceProperties)
+{
 
     OCResource *pointer = NULL;
     OCStackResult result = OC_STACK_ERROR;
@@ -3130,28 +3835,20 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
 
     // Make sure resourceProperties bitmask has allowed properties specified
     if (resourceProperties
-            > (OC_ACTIVE | OC_DISCOVERABLE | OC_OBSERVABLE | OC_SLOW | OC_SECURE |
-               OC_EXPLICIT_DISCOVERABLE))
+            & ~(OC_ACTIVE | OC_DISCOVERABLE | OC_OBSERVABLE | OC_SLOW | OC_SECURE |
+                OC_EXPLICIT_DISCOVERABLE | OC_SHARED_NOTIFICATION | OC_REENTRANT))
     {
         OIC_LOG(ERROR, TAG, "Invalid property");
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    ResourceLookupNode *node = NULL;
+    HASH_FIND(uriHh, resourceUriTable, uri, strlen(uri), node);
+    if (node)
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
@@ -3172,6 +3869,12 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         goto exit;
     }
 
+    result = insertResourceLookup(pointer);
+    if (result != OC_STACK_OK)
+    {
+        goto exit;
+    }
+
     // Set properties.  Set OC_ACTIVE
     pointer->resourceProperties = (OCResourceProperty) (resourceProperties
             | OC_ACTIVE);
@@ -3229,6 +3932,15 @@ exit:
 
 OCStackResult OCBindResource(
         OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
+{
+    OCStackLock();
+    OCStackResult result = BindResourceLocked(collectionHandle, resourceHandle);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult BindResourceLocked(
+        OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
 {
     OCResource *resource = NULL;
     OCChildResource *tempChildResource = NULL;
@@ -3300,6 +4012,15 @@ OCStackResult OCBindResource(
 
 OCStackResult OCUnBindResource(
         OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
+{
+    OCStackLock();
+    OCStackResult result = UnBindResourceLocked(collectionHandle, resourceHandle);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult UnBindResourceLocked(
+        OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
 {
     OCResource *resource = NULL;
     OCChildResource *tempChildResource = NULL;
@@ -3460,8 +4181,8 @@ OCStackResult BindResourceTypeToResource(OCResource* resource,
     pointer->resourcetypename = str;
     pointer->next = NULL;
 
-    insertResourceType(resource, pointer);
-    result = OC_STACK_OK;
+    // insertResourceType takes ownership of pointer, also when it fails
+    return insertResourceType(resource, pointer);
 
 exit:
     if (result != OC_STACK_OK)
@@ -3505,10 +4226,8 @@ OCStackResult BindResourceInterfaceToResource(OCResource* resource,
     }
     pointer->name = str;
 
-    // Bind the resourceinterface to the resource
-    insertResourceInterface(resource, pointer);
-
-    result = OC_STACK_OK;
+    // Bind the resourceinterface to the resource; it takes ownership of pointer
+    return insertResourceInterface(resource, pointer);
 
     exit:
     if (result != OC_STACK_OK)
@@ -3523,6 +4242,15 @@ OCStackResult BindResourceInterfaceToResource(OCResource* resource,
 OCStackResult OCBindResourceTypeToResource(OCResourceHandle handle,
         const char *resourceTypeName)
 {
+    OCStackLock();
+    OCStackResult result = BindResourceTypeToResourceLocked(handle, resourceTypeName);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult BindResourceTypeToResourceLocked(OCResourceHandle handle,
+        const char *resourceTypeName)
+{
 
     OCStackResult result = OC_STACK_ERROR;
     OCResource *resource = NULL;
@@ -3550,6 +4278,15 @@ OCStackResult OCBindResourceTypeToResource(OCResourceHandle handle,
 OCStackResult OCBindResourceInterfaceToResource(OCResourceHandle handle,
         const char *resourceInterfaceName)
 {
+    OCStackLock();
+    OCStackResult result = BindResourceInterfaceToResourceLocked(handle, resourceInterfaceName);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult BindResourceInterfaceToResourceLocked(OCResourceHandle handle,
+        const char *resourceInterfaceName)
+{
 
     OCStackResult result = OC_STACK_ERROR;
     OCResource *resource = NULL;
@@ -3600,6 +4337,14 @@ OCResourceHandle OCGetResourceHandle(uint8_t index)
 }
 
 OCStackResult OCDeleteResource(OCResourceHandle handle)
+{
+    OCStackLock();
+    OCStackResult result = DeleteResourceLocked(handle);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult DeleteResourceLocked(OCResourceHandle handle)
 {
     if (!handle)
     {
@@ -3751,6 +4496,16 @@ OCResourceHandle OCGetResourceHandleFromCollection(OCResourceHandle collectionHa
 OCStackResult OCBindResourceHandler(OCResourceHandle handle,
         OCEntityHandler entityHandler,
         void* callbackParam)
+{
+    OCStackLock();
+    OCStackResult result = BindResourceHandlerLocked(handle, entityHandler, callbackParam);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult BindResourceHandlerLocked(OCResourceHandle handle,
+        OCEntityHandler entityHandler,
+        void* callbackParam)
 {
     OCResource *resource = NULL;
 
@@ -3866,11 +4621,12 @@ OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService q
 #endif // WITH_PRESENCE
     VERIFY_NON_NULL(handle, ERROR, OC_STACK_ERROR);
 
+    OCStackLock();
     // Verify that the resource exists
     resPtr = findResource ((OCResource *) handle);
     if (NULL == resPtr)
     {
-        return OC_STACK_NO_RESOURCE;
+        result = OC_STACK_NO_RESOURCE;
     }
     else
     {
@@ -3884,8 +4640,9 @@ OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService q
 #else
         result = SendAllObserverNotification (method, resPtr, maxAge, qos);
 #endif
-        return result;
     }
+    OCStackUnlock();
+    return result;
 }
 
 OCStackResult
@@ -3905,17 +4662,17 @@ OCNotifyListOfObservers (OCResourceHandle handle,
     VERIFY_NON_NULL(obsIdList, ERROR, OC_STACK_ERROR);
     VERIFY_NON_NULL(payload, ERROR, OC_STACK_ERROR);
 
+    OCStackResult result = OC_STACK_NO_RESOURCE;
+    OCStackLock();
     resPtr = findResource ((OCResource *) handle);
-    if (NULL == resPtr || myStackMode == OC_CLIENT)
-    {
-        return OC_STACK_NO_RESOURCE;
-    }
-    else
+    if (resPtr && myStackMode != OC_CLIENT)
     {
         incrementSequenceNumber(resPtr);
+        result = SendListObserverNotification(resPtr, obsIdList, numberOfIds,
+                payload, maxAge, qos);
     }
-    return (SendListObserverNotification(resPtr, obsIdList, numberOfIds,
-            payload, maxAge, qos));
+    OCStackUnlock();
+    return result;
 }
 
 OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
@@ -3931,12 +4688,14 @@ OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
 
     // Normal response
     // Get pointer to request info
+    OCStackLock();
     serverRequest = GetServerRequestUsingHandle((OCServerRequest *)ehResponse->requestHandle);
     if(serverRequest)
     {
         // response handler in ocserverrequest.c. Usually HandleSingleResponse.
         result = serverRequest->ehResponseHandler(ehResponse);
     }
+    OCStackUnlock();
 
     return result;
 }
@@ -4102,17 +4861,159 @@ void insertResource(OCResource *resource)
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
+    ResourceLookupNode *node = NULL;
+    HASH_FIND(handleHh, resourceHandleTable, &resource, sizeof(OCResource *), node);
+    return node ? node->resource : NULL;
+}
 
-    while (pointer)
+OCResource *FindResourceByHandle(OCResourceHandle handle)
+{
+    return findResource((OCResource *) handle);
+}
+
+OCResource *FindResourceByUri(const char* resourceUri)
+{
+    if(!resourceUri)
+    {
+        return NULL;
+    }
+
+    ResourceLookupNode *node = NULL;
+    HASH_FIND(uriHh, resourceUriTable, resourceUri, strlen(resourceUri), node);
+    if (node)
+    {
+        return node->resource;
+    }
+    OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
+    return NULL;
+}
+
+OCResource **FindResourcesByType(const char *resourceTypeName, size_t *numResources)
+{
+    ResourceIndexEntry *entry = NULL;
+    if (resourceTypeName)
+    {
+        HASH_FIND(hh, resourceTypeIndex, resourceTypeName, strlen(resourceTypeName), entry);
+    }
+    *numResources = entry ? entry->numResources : 0;
+    return entry ? entry->resources : NULL;
+}
+
+OCResource **FindResourcesByInterface(const char *interfaceName, size_t *numResources)
+{
+    ResourceIndexEntry *entry = NULL;
+    if (interfaceName)
     {
-        if (pointer == resource)
+        HASH_FIND(hh, resourceInterfaceIndex, interfaceName, strlen(interfaceName), entry);
+    }
+    *numResources = entry ? entry->numResources : 0;
+    return entry ? entry->resources : NULL;
+}
+
+OCStackResult insertResourceLookup(OCResource *resource)
+{
+    ResourceLookupNode *node = (ResourceLookupNode *) OICCalloc(1, sizeof(ResourceLookupNode));
+    if (!node)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    node->resource = resource;
+    HASH_ADD(handleHh, resourceHandleTable, resource, sizeof(OCResource *), node);
+    HASH_ADD_KEYPTR(uriHh, resourceUriTable, resource->uri, strlen(resource->uri), node);
+    return OC_STACK_OK;
+}
+
+void deleteResourceLookup(OCResource *resource)
+{
+    ResourceLookupNode *node = NULL;
+    HASH_FIND(handleHh, resourceHandleTable, &resource, sizeof(OCResource *), node);
+    if (node)
+    {
+        HASH_DELETE(handleHh, resourceHandleTable, node);
+        HASH_DELETE(uriHh, resourceUriTable, node);
+        OICFree(node);
+    }
+}
+
+OCStackResult insertResourceIndex(ResourceIndexEntry **index, const char *name,
+        OCResource *resource)
+{
+    ResourceIndexEntry *entry = NULL;
+    HASH_FIND(hh, *index, name, strlen(name), entry);
+    if (!entry)
+    {
+        entry = (ResourceIndexEntry *) OICCalloc(1, sizeof(ResourceIndexEntry));
+        if (!entry)
         {
-            return resource;
+            return OC_STACK_NO_MEMORY;
         }
-        pointer = pointer->next;
+        entry->name = OICStrdup(name);
+        if (!entry->name)
+        {
+            OICFree(entry);
+            return OC_STACK_NO_MEMORY;
+        }
+        HASH_ADD_KEYPTR(hh, *index, entry->name, strlen(entry->name), entry);
+    }
+
+    if (entry->numResources == entry->capacity)
+    {
+        size_t capacity = entry->capacity ? entry->capacity * 2 : 4;
+        OCResource **resources = (OCResource **) OICRealloc(entry->resources,
+                capacity * sizeof(OCResource *));
+        if (!resources)
+        {
+            if (!entry->numResources)
+            {
+                HASH_DELETE(hh, *index, entry);
+                OICFree(entry->name);
+                OICFree(entry);
+            }
+            return OC_STACK_NO_MEMORY;
+        }
+        entry->resources = resources;
+        entry->capacity = capacity;
+    }
+    entry->resources[entry->numResources++] = resource;
+    return OC_STACK_OK;
+}
+
+void deleteResourceIndex(ResourceIndexEntry **index, const char *name, OCResource *resource)
+{
+    ResourceIndexEntry *entry = NULL;
+    HASH_FIND(hh, *index, name, strlen(name), entry);
+    if (!entry)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < entry->numResources; i++)
+    {
+        if (entry->resources[i] == resource)
+        {
+            // Keep the binding order, discovery responses list resources in it.
+            memmove(&entry->resources[i], &entry->resources[i + 1],
+                    (entry->numResources - i - 1) * sizeof(OCResource *));
+            entry->numResources--;
+            break;
+        }
+    }
+
+    if (!entry->numResources)
+    {
+        HASH_DELETE(hh, *index, entry);
+        OICFree(entry->resources);
+        OICFree(entry->name);
+        OICFree(entry);
+    }
+}
+
+void deleteResourceTypeIndex(OCResource *resource)
+{
+    for (OCResourceType *pointer = resource->rsrcType; pointer; pointer = pointer->next)
+    {
+        deleteResourceIndex(&resourceTypeIndex, pointer->resourcetypename, resource);
     }
-    return NULL;
 }
 
 void deleteAllResources()
@@ -4176,6 +5077,8 @@ OCStackResult deleteResource(OCResource *resource)
                 SendPresenceNotification(resource->rsrcType, OC_PRESENCE_TRIGGER_DELETE);
             }
 #endif
+            DeleteObserversUsingResource(resource);
+
             // Only resource in list.
             if (temp == headResource && temp == tailResource)
             {
@@ -4219,6 +5122,13 @@ void deleteResourceElements(OCResource *resource)
         return;
     }
 
+    deleteResourceLookup(resource);
+    deleteResourceTypeIndex(resource);
+    for (OCResourceInterface *pointer = resource->rsrcInterface; pointer; pointer = pointer->next)
+    {
+        deleteResourceIndex(&resourceInterfaceIndex, pointer->name, resource);
+    }
+
     OICFree(resource->uri);
     deleteResourceType(resource->rsrcType);
     deleteResourceInterface(resource->rsrcInterface);
@@ -4252,44 +5162,52 @@ void deleteResourceInterface(OCResourceInterface *resourceInterface)
     }
 }
 
-void insertResourceType(OCResource *resource, OCResourceType *resourceType)
+OCStackResult insertResourceType(OCResource *resource, OCResourceType *resourceType)
 {
     OCResourceType *pointer = NULL;
     OCResourceType *previous = NULL;
     if (!resource || !resourceType)
     {
-        return;
-    }
-    // resource type list is empty.
-    else if (!resource->rsrcType)
-    {
-        resource->rsrcType = resourceType;
+        return OC_STACK_INVALID_PARAM;
     }
-    else
-    {
-        pointer = resource->rsrcType;
 
-        while (pointer)
+    pointer = resource->rsrcType;
+    while (pointer)
+    {
+        if (!strcmp(resourceType->resourcetypename, pointer->resourcetypename))
         {
-            if (!strcmp(resourceType->resourcetypename, pointer->resourcetypename))
-            {
-                OIC_LOG_V(INFO, TAG, "Type %s already exists", resourceType->resourcetypename);
-                OICFree(resourceType->resourcetypename);
-                OICFree(resourceType);
-                return;
-            }
-            previous = pointer;
-            pointer = pointer->next;
+            OIC_LOG_V(INFO, TAG, "Type %s already exists", resourceType->resourcetypename);
+            OICFree(resourceType->resourcetypename);
+            OICFree(resourceType);
+            return OC_STACK_OK;
         }
+        previous = pointer;
+        pointer = pointer->next;
+    }
 
-        if (previous)
-        {
-            previous->next = resourceType;
-        }
+    // Index before linking, so a failure leaves the resource unchanged.
+    if (insertResourceIndex(&resourceTypeIndex, resourceType->resourcetypename, resource)
+        != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to index type %s", resourceType->resourcetypename);
+        OICFree(resourceType->resourcetypename);
+        OICFree(resourceType);
+        return OC_STACK_NO_MEMORY;
     }
+
     resourceType->next = NULL;
+    if (previous)
+    {
+        previous->next = resourceType;
+    }
+    else
+    {
+        // resource type list is empty.
+        resource->rsrcType = resourceType;
+    }
 
     OIC_LOG_V(INFO, TAG, "Added type %s to %s", resourceType->resourcetypename, resource->uri);
+    return OC_STACK_OK;
 }
 
 OCResourceType *findResourceTypeAtIndex(OCResourceHandle handle, uint8_t index)
@@ -4341,10 +5259,10 @@ OCResourceType *findResourceType(OCResourceType * resourceTypeList, const char *
 
 /*
  * Insert a new interface into interface linked list only if not already present.
- * If alredy present, 2nd arg is free'd.
+ * If alredy present, 2nd arg is free'd; it is also free'd when the insertion fails.
  * Default interface will always be first if present.
  */
-void insertResourceInterface(OCResource *resource, OCResourceInterface *newInterface)
+OCStackResult insertResourceInterface(OCResource *resource, OCResourceInterface *newInterface)
 {
     OCResourceInterface *pointer = NULL;
     OCResourceInterface *previous = NULL;
@@ -4367,7 +5285,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
             {
                 OICFree(newInterface->name);
                 OICFree(newInterface);
-                return;
+                return result;
             }
             if (*firstInterface)
             {
@@ -4382,7 +5300,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
         {
             OICFree(newInterface->name);
             OICFree(newInterface);
-            return;
+            return OC_STACK_OK;
         }
         // This code will not hit anymore, keeping
         else
@@ -4400,13 +5318,31 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
             {
                 OICFree(newInterface->name);
                 OICFree(newInterface);
-                return;
+                return OC_STACK_OK;
             }
             previous = pointer;
             pointer = pointer->next;
         }
         previous->next = newInterface;
     }
+
+    if (insertResourceIndex(&resourceInterfaceIndex, newInterface->name, resource)
+        != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to index interface %s", newInterface->name);
+
+        // Unlink it again, so a failure leaves the interface list unchanged.
+        OCResourceInterface **link = firstInterface;
+        while (*link != newInterface)
+        {
+            link = &(*link)->next;
+        }
+        *link = newInterface->next;
+        OICFree(newInterface->name);
+        OICFree(newInterface);
+        return OC_STACK_NO_MEMORY;
+    }
+    return OC_STACK_OK;
 }
 
 OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
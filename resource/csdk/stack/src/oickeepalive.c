@@ -526,6 +526,41 @@ void ProcessKeepAlive()
     }
 }
 
+uint64_t GetNextKeepAliveTime()
+{
+    if (!g_isKeepAliveInitialized)
+    {
+        return 0;
+    }
+
+    uint64_t nextTime = 0;
+    uint32_t len = u_arraylist_length(g_keepAliveConnectionTable);
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        KeepAliveEntry_t *entry = u_arraylist_get(g_keepAliveConnectionTable, i);
+        if (NULL == entry)
+        {
+            continue;
+        }
+
+        // Same deadlines as checked by ProcessKeepAlive().
+        uint64_t timeout = entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+        if (OC_CLIENT == entry->mode && entry->sentPingMsg)
+        {
+            timeout = KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+        }
+
+        uint64_t entryTime = entry->timeStamp + timeout;
+        if (!nextTime || entryTime < nextTime)
+        {
+            nextTime = entryTime;
+        }
+    }
+
+    return nextTime;
+}
+
 void IncreaseInterval(KeepAliveEntry_t *entry)
 {
     VERIFY_NON_NULL_NR(entry, FATAL);
@@ -684,6 +719,8 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
         return NULL;
     }
 
+    // A new entry may expire before the ones OCProcessWait() is sleeping for.
+    OCProcessWakeup();
     return entry;
 }
 
@@ -24,8 +24,13 @@ extern "C"
     #include "ocpayload.h"
     #include "ocstack.h"
     #include "ocstackinternal.h"
+    #include "ocresource.h"
+    #include "ocobserve.h"
+    #include "ocresourcehandler.h"
+    #include "ocserverrequest.h"
     #include "logger.h"
     #include "oic_malloc.h"
+    #include "ocpayloadcbor.h"
 }
 
 #include "gtest/gtest.h"
@@ -44,6 +49,10 @@ extern "C"
 
 #include <iostream>
 #include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "gtest_helper.h"
 
@@ -385,6 +394,217 @@ TEST(StackStop, StackStopRepeated)
     EXPECT_EQ(OC_STACK_ERROR, OCStop());
 }
 
+TEST(StackProcess, ProcessWaitWithoutInit)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_ERROR, OCProcessWait(10));
+}
+
+TEST(StackProcess, ProcessWaitTimeout)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT));
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+    EXPECT_EQ(OC_STACK_OK, OCProcessWait(10));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackProcess, ProcessWaitWakeup)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT));
+    OCProcessWakeup();
+    // Returns right away although no wait bound is given.
+    EXPECT_EQ(OC_STACK_OK, OCProcessWait(0));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackProcess, RequestDispatchThreadsSetBeforeInit)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestDispatchThreads(2));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+    EXPECT_EQ(OC_STACK_ERROR, OCSetRequestDispatchThreads(4));
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led", 0, NULL,
+                                            OC_DISCOVERABLE | OC_REENTRANT));
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestDispatchThreads(0));
+}
+
+struct DispatchedHandlerContext
+{
+    std::mutex lock;
+    std::condition_variable called;
+    bool done = false;
+    std::thread::id handlerThread;
+    OCStackResult responseResult = OC_STACK_ERROR;
+};
+
+static OCEntityHandlerResult dispatchedEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest, void *callbackParam)
+{
+    DispatchedHandlerContext *context = static_cast<DispatchedHandlerContext *>(callbackParam);
+
+    OCEntityHandlerResponse response = {};
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) OCRepPayloadCreate();
+    OCStackResult result = OCDoResponse(&response);
+    OCPayloadDestroy(response.payload);
+
+    std::lock_guard<std::mutex> lock(context->lock);
+    context->handlerThread = std::this_thread::get_id();
+    context->responseResult = result;
+    context->done = true;
+    context->called.notify_all();
+    return OC_EH_OK;
+}
+
+TEST(StackProcess, RequestDispatchedToWorker)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestDispatchThreads(2));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+
+    DispatchedHandlerContext context;
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            dispatchedEntityHandler, &context,
+                                            OC_DISCOVERABLE));
+
+    char token[] = "dispatch";
+    OCServerProtocolRequest protocolRequest = {};
+    protocolRequest.method = OC_REST_GET;
+    protocolRequest.acceptFormat = OC_FORMAT_CBOR;
+    strcpy(protocolRequest.resourceUrl, "/a/led");
+    protocolRequest.qos = OC_LOW_QOS;
+    protocolRequest.devAddr.adapter = OC_ADAPTER_IP;
+    strcpy(protocolRequest.devAddr.addr, "127.0.0.1");
+    protocolRequest.devAddr.port = 5683;
+    protocolRequest.requestToken = token;
+    protocolRequest.tokenLength = sizeof(token) - 1;
+    protocolRequest.coapID = 1;
+
+    // Resolved on this thread, handed to a dispatch worker for the entity handler
+    OCStackLock();
+    EXPECT_EQ(OC_STACK_OK, HandleStackRequests(&protocolRequest));
+    OCStackUnlock();
+
+    {
+        std::unique_lock<std::mutex> lock(context.lock);
+        EXPECT_TRUE(context.called.wait_for(lock, std::chrono::seconds(2),
+                                            [&context] { return context.done; }));
+    }
+    EXPECT_NE(std::this_thread::get_id(), context.handlerThread);
+    EXPECT_EQ(OC_STACK_OK, context.responseResult);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestDispatchThreads(0));
+}
+
+TEST(StackProcess, UnlockAllReleasesNestedStackLock)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestDispatchThreads(2));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+
+    OCStackLock();
+    OCStackLock();
+    uint32_t depth = OCStackUnlockAll();
+    EXPECT_EQ(2u, depth);
+
+    // Another thread can take the lock while the application callback would run
+    bool locked = false;
+    std::thread other([&locked]
+    {
+        OCStackLock();
+        locked = true;
+        OCStackUnlock();
+    });
+    other.join();
+    EXPECT_TRUE(locked);
+
+    OCStackRelock(depth);
+    OCStackUnlock();
+    OCStackUnlock();
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestDispatchThreads(0));
+}
+
+struct LazyHandlerContext
+{
+    bool parsedLazily = false;
+    int64_t power = 0;
+    bool state = false;
+};
+
+static OCEntityHandlerResult lazyEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest, void *callbackParam)
+{
+    LazyHandlerContext *context = static_cast<LazyHandlerContext *>(callbackParam);
+    OCRepPayload *input = (OCRepPayload *) entityHandlerRequest->payload;
+    if (input)
+    {
+        context->parsedLazily = input->lazy && !input->values;
+        OCRepPayloadGetPropInt(input, "power", &context->power);
+        OCRepPayloadGetPropBool(input, "state", &context->state);
+    }
+    return OC_EH_OK;
+}
+
+TEST(StackProcess, LazyParsedRequestPayloadReadThroughGetters)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OCSetLazyPayloadParsing(true);
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_SERVER));
+
+    LazyHandlerContext context;
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "core.rw", "/a/light",
+                                            lazyEntityHandler, &context, OC_DISCOVERABLE));
+
+    OCRepPayload *body = OCRepPayloadCreate();
+    ASSERT_TRUE(body != NULL);
+    OCRepPayloadSetPropInt(body, "power", 42);
+    OCRepPayloadSetPropBool(body, "state", true);
+    OCRepPayloadSetPropString(body, "name", "unread");
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *) body, &cbor, &cborSize));
+    OCRepPayloadDestroy(body);
+
+    char token[] = "lazyput";
+    OCServerProtocolRequest protocolRequest = {};
+    protocolRequest.method = OC_REST_PUT;
+    protocolRequest.acceptFormat = OC_FORMAT_CBOR;
+    strcpy(protocolRequest.resourceUrl, "/a/light");
+    protocolRequest.qos = OC_LOW_QOS;
+    protocolRequest.devAddr.adapter = OC_ADAPTER_IP;
+    strcpy(protocolRequest.devAddr.addr, "127.0.0.1");
+    protocolRequest.devAddr.port = 5683;
+    protocolRequest.requestToken = token;
+    protocolRequest.tokenLength = sizeof(token) - 1;
+    protocolRequest.coapID = 2;
+    protocolRequest.payload = cbor;
+    protocolRequest.reqTotalSize = cborSize;
+
+    EXPECT_EQ(OC_STACK_OK, HandleStackRequests(&protocolRequest));
+    EXPECT_TRUE(context.parsedLazily);
+    EXPECT_EQ(42, context.power);
+    EXPECT_TRUE(context.state);
+
+    OICFree(cbor);
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    OCSetLazyPayloadParsing(false);
+}
+
 TEST(StackResource, DISABLED_UpdateResourceNullURI)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -506,6 +726,274 @@ TEST(StackResource, CreateResourceSuccess)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResource, CreateResourceSharedNotification)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CreateResourceSharedNotification test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE|OC_SHARED_NOTIFICATION));
+    EXPECT_EQ(OC_DISCOVERABLE|OC_OBSERVABLE|OC_SHARED_NOTIFICATION,
+              OCGetResourceProperties(handle) & ~OC_ACTIVE);
+
+    // No observers yet.
+    EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCNotifyAllObservers(handle, OC_NA_QOS));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+struct SharedNotificationContext
+{
+    OCEntityHandlerResult ehResult;
+    size_t calls;
+    std::vector<OCObservationId> sharedIds;
+};
+
+static OCEntityHandlerResult sharedNotificationHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest, void *callbackParam)
+{
+    SharedNotificationContext *context = static_cast<SharedNotificationContext *>(callbackParam);
+    context->calls++;
+
+    OCServerRequest *request = (OCServerRequest *) entityHandlerRequest->requestHandle;
+    context->sharedIds.insert(context->sharedIds.end(), request->sharedObserverIds,
+                              request->sharedObserverIds + request->numSharedObservers);
+
+    if (context->ehResult == OC_EH_OK)
+    {
+        OCEntityHandlerResponse response = {};
+        response.requestHandle = entityHandlerRequest->requestHandle;
+        response.resourceHandle = entityHandlerRequest->resource;
+        response.ehResult = OC_EH_OK;
+        response.payload = (OCPayload *) OCRepPayloadCreate();
+        OCDoResponse(&response);
+        OCPayloadDestroy(response.payload);
+    }
+    return context->ehResult;
+}
+
+TEST(StackResource, SharedNotificationReachesGroup)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SharedNotificationReachesGroup test");
+    InitStack(OC_SERVER);
+
+    SharedNotificationContext context = {OC_EH_OK, 0, {}};
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            sharedNotificationHandler, &context,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE|OC_SHARED_NOTIFICATION));
+
+    OCDevAddr addr = {};
+    addr.adapter = OC_ADAPTER_IP;
+    strcpy(addr.addr, "127.0.0.1");
+    addr.port = 5683;
+    char tokens[4][7] = {"token1", "token2", "token3", "token4"};
+    char query[] = "if=oic.if.baseline";
+    for (OCObservationId id = 1; id <= 4; id++)
+    {
+        // The last observer uses another query and cannot share
+        EXPECT_EQ(OC_STACK_OK, AddObserver("/a/led", (id == 4) ? query : NULL, id,
+                                           tokens[id - 1], sizeof(tokens[id - 1]),
+                                           (OCResource *)handle, OC_LOW_QOS, OC_FORMAT_CBOR,
+                                           &addr));
+    }
+
+    // One handler call per group; the response fans out to the rest of the group
+    OCNotifyAllObservers(handle, OC_LOW_QOS);
+    EXPECT_EQ(2u, context.calls);
+    ASSERT_EQ(2u, context.sharedIds.size());
+    EXPECT_EQ(2, context.sharedIds[0]);
+    EXPECT_EQ(3, context.sharedIds[1]);
+
+    // The next notification is shared again
+    context.calls = 0;
+    context.sharedIds.clear();
+    OCNotifyAllObservers(handle, OC_LOW_QOS);
+    EXPECT_EQ(2u, context.calls);
+    EXPECT_EQ(2u, context.sharedIds.size());
+
+    // Members of a group whose handler failed get their own notification
+    context.ehResult = OC_EH_ERROR;
+    context.calls = 0;
+    OCNotifyAllObservers(handle, OC_LOW_QOS);
+    EXPECT_EQ(4u, context.calls);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, SharedNotificationReachesLargeGroup)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SharedNotificationReachesLargeGroup test");
+    InitStack(OC_SERVER);
+
+    SharedNotificationContext context = {OC_EH_OK, 0, {}};
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            sharedNotificationHandler, &context,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE|OC_SHARED_NOTIFICATION));
+
+    OCDevAddr addr = {};
+    addr.adapter = OC_ADAPTER_IP;
+    strcpy(addr.addr, "127.0.0.1");
+    addr.port = 5683;
+    // Observation ids are 8 bit, 255 observers is as large as a group gets
+    const size_t numObservers = UINT8_MAX;
+    for (size_t id = 1; id <= numObservers; id++)
+    {
+        char token[8];
+        snprintf(token, sizeof(token), "tok%04u", (unsigned) id);
+        EXPECT_EQ(OC_STACK_OK, AddObserver("/a/led", NULL, (OCObservationId) id, token,
+                                           sizeof(token),
+                                           (OCResource *)handle, OC_LOW_QOS, OC_FORMAT_CBOR,
+                                           &addr));
+    }
+
+    // A single handler call covers every observer
+    OCNotifyAllObservers(handle, OC_LOW_QOS);
+    EXPECT_EQ(1u, context.calls);
+    EXPECT_EQ(numObservers - 1, context.sharedIds.size());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, ObserversIndexedPerResource)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ObserversIndexedPerResource test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1, "core.led", "core.rw", "/a/led1",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+    OCResourceHandle handle2;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle2, "core.led", "core.rw", "/a/led2",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    OCDevAddr addr = {};
+    char token1[] = "token1";
+    char token2[] = "token2";
+    EXPECT_EQ(OC_STACK_OK, AddObserver("/a/led1", NULL, 1, token1, sizeof(token1),
+                                       (OCResource *)handle1, OC_LOW_QOS, OC_FORMAT_CBOR,
+                                       &addr));
+    EXPECT_EQ(OC_STACK_OK, AddObserver("/a/led2", NULL, 2, token2, sizeof(token2),
+                                       (OCResource *)handle2, OC_LOW_QOS, OC_FORMAT_CBOR,
+                                       &addr));
+
+    ResourceObserver *observer = GetObserverUsingToken(token1, sizeof(token1));
+    ASSERT_TRUE(NULL != observer);
+    EXPECT_EQ(1, observer->observeId);
+    EXPECT_EQ(observer, ((OCResource *)handle1)->observersHead);
+    EXPECT_EQ(NULL, observer->next);
+    EXPECT_EQ(observer, GetObserverUsingId(1));
+
+    // Deleting a resource drops only its own observers.
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle1));
+    EXPECT_EQ(NULL, GetObserverUsingToken(token1, sizeof(token1)));
+    EXPECT_EQ(NULL, GetObserverUsingId(1));
+    EXPECT_TRUE(NULL != GetObserverUsingId(2));
+
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken(token2, sizeof(token2)));
+    EXPECT_EQ(NULL, GetObserverUsingToken(token2, sizeof(token2)));
+    EXPECT_EQ(NULL, ((OCResource *)handle2)->observersHead);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, ResourcesIndexedByUriTypeAndInterface)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ResourcesIndexedByUriTypeAndInterface test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1, "core.led", "core.rw", "/a/led1",
+                                            0, NULL, OC_DISCOVERABLE));
+    OCResourceHandle handle2;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle2, "core.led", "core.rw", "/a/led2",
+                                            0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handle2, "core.brightled"));
+
+    EXPECT_EQ(handle1, FindResourceByUri("/a/led1"));
+    EXPECT_EQ(handle2, FindResourceByUri("/a/led2"));
+
+    size_t numResources = 0;
+    OCResource **resources = FindResourcesByType("core.led", &numResources);
+    ASSERT_EQ(2u, numResources);
+    EXPECT_EQ(handle1, resources[0]);
+    EXPECT_EQ(handle2, resources[1]);
+
+    resources = FindResourcesByType("core.brightled", &numResources);
+    ASSERT_EQ(1u, numResources);
+    EXPECT_EQ(handle2, resources[0]);
+
+    resources = FindResourcesByInterface("core.rw", &numResources);
+    EXPECT_EQ(2u, numResources);
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle2));
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led2"));
+    EXPECT_EQ(NULL, FindResourcesByType("core.brightled", &numResources));
+    EXPECT_EQ(0u, numResources);
+    resources = FindResourcesByType("core.led", &numResources);
+    ASSERT_EQ(1u, numResources);
+    EXPECT_EQ(handle1, resources[0]);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static ClientCB *AddTestClientCB(const char *tokenData, const char *uri, uint32_t ttl)
+{
+    OCCallbackData cbData = {};
+    CAToken_t token = (CAToken_t)OICMalloc(strlen(tokenData));
+    memcpy(token, tokenData, strlen(tokenData));
+    OCDoHandle handle = OICMalloc(1);
+    char *requestUri = (char *)OICMalloc(strlen(uri) + 1);
+    strcpy(requestUri, uri);
+
+    ClientCB *cbNode = NULL;
+    EXPECT_EQ(OC_STACK_OK, AddClientCB(&cbNode, &cbData, token, strlen(tokenData), &handle,
+                                       OC_REST_GET, NULL, requestUri, NULL, ttl));
+    return cbNode;
+}
+
+TEST(StackClientCB, IndexedByTokenHandleAndUri)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting IndexedByTokenHandleAndUri test");
+
+    ClientCB *cb1 = AddTestClientCB("token1", "/a/led1", UINT32_MAX - 1);
+    ClientCB *cb2 = AddTestClientCB("token2", "/a/led2", UINT32_MAX - 2);
+    ASSERT_TRUE(NULL != cb1);
+    ASSERT_TRUE(NULL != cb2);
+
+    EXPECT_EQ(cb1, GetClientCB((CAToken_t)"token1", 6, NULL, NULL));
+    EXPECT_EQ(cb2, GetClientCB(NULL, 0, cb2->handle, NULL));
+    EXPECT_EQ(cb2, GetClientCB(NULL, 0, NULL, "/a/led2"));
+    EXPECT_EQ(UINT32_MAX - 2, GetNextClientCBTimeout());
+
+    SetClientCBTimeout(cb2, 0);
+    EXPECT_EQ(UINT32_MAX - 1, GetNextClientCBTimeout());
+
+    FindAndDeleteClientCB(cb1);
+    EXPECT_EQ(NULL, GetClientCB((CAToken_t)"token1", 6, NULL, NULL));
+    EXPECT_EQ(0u, GetNextClientCBTimeout());
+
+    // Deleting an already deleted node is a no-op.
+    FindAndDeleteClientCB(cb1);
+    EXPECT_EQ(cb2, GetClientCB((CAToken_t)"token2", 6, NULL, NULL));
+
+    DeleteClientCBList();
+    EXPECT_EQ(NULL, GetClientCB(NULL, 0, NULL, "/a/led2"));
+}
+
 TEST(StackResource, CreateResourceSuccessWithResourcePolicyPropNone)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -0,0 +1,118 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+///
+/// This sample measures the attribute storage of OCRepresentation: it compares
+/// the flat AttributeMap against the std::map it replaced for setting, looking
+/// up and serializing attributes.
+///
+/// Usage: representationbenchmark [iterations]
+///
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OCApi.h"
+#include "ocpayload.h"
+
+using namespace OC;
+
+template <typename Container>
+OCRepPayload* serialize(const Container& values)
+{
+    OCRepPayload* payload = OCRepPayloadCreate();
+    for (const auto& item : values)
+    {
+        OCRepPayloadSetPropInt(payload, item.first.c_str(), boost::get<int>(item.second));
+    }
+    return payload;
+}
+
+template <typename Container>
+void runStorageBenchmark(const char* name, const std::vector<std::string>& keys,
+        size_t iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+    Container values;
+    int64_t sum = 0;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        Container cur;
+        for (const auto& key : keys)
+        {
+            cur[key] = static_cast<int>(i);
+        }
+        values.swap(cur);
+    }
+    auto setTime = Clock::now() - start;
+
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        for (const auto& key : keys)
+        {
+            sum += boost::get<int>(values.find(key)->second);
+        }
+    }
+    auto getTime = Clock::now() - start;
+
+    start = Clock::now();
+    for (size_t i = 0; i < iterations / 10; ++i)
+    {
+        OCRepPayloadDestroy(serialize(values));
+    }
+    auto serializeTime = Clock::now() - start;
+
+    auto opsPerSec = [](size_t ops, Clock::duration d)
+    {
+        return ops / std::max(std::chrono::duration<double>(d).count(), 1e-9);
+    };
+
+    std::cout << name << ": set " << opsPerSec(iterations * keys.size(), setTime)
+        << " ops/s, get " << opsPerSec(iterations * keys.size(), getTime)
+        << " ops/s, serialize " << opsPerSec(iterations / 10, serializeTime)
+        << " reps/s (" << sum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = 100000;
+    if (argc > 1)
+    {
+        iterations = std::strtoul(argv[1], NULL, 10);
+    }
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 16; ++i)
+    {
+        keys.push_back("attribute" + std::to_string(i));
+    }
+
+    runStorageBenchmark<std::map<std::string, AttributeValue>>("std::map", keys, iterations);
+    runStorageBenchmark<AttributeMap>("AttributeMap", keys, iterations);
+    return 0;
+}
@@ -23,6 +23,11 @@
 
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <vector>
 #include <sstream>
 #include <iostream>
 
@@ -33,21 +38,92 @@
 
 namespace OC
 {
+    /**
+     * Fixed size pool of threads running the client callbacks.
+     *
+     * Callbacks reach the workers through a bounded lock-free queue. When the queue is
+     * full a callback runs on the posting thread, which slows down the stack instead of
+     * growing the backlog. Callbacks waiting on a strand count against the same size; past
+     * it the posting thread runs an idle strand itself, while a strand already running on
+     * a worker keeps queueing, as blocking the posting stack thread could deadlock.
+     * Callbacks still queued when the executor is destroyed are dropped.
+     */
+    class CallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        /**
+         * Callbacks posted to the same strand run one at a time, in posting order.
+         */
+        class Strand
+        {
+            friend class CallbackExecutor;
+
+            std::mutex m_mutex;
+            std::deque<Task> m_tasks;
+            bool m_running = false;
+        };
+
+        CallbackExecutor(size_t numThreads, size_t queueSize);
+        ~CallbackExecutor();
+
+        CallbackExecutor(const CallbackExecutor&) = delete;
+        CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+        void post(Task task);
+        void post(const std::shared_ptr<Strand>& strand, Task task);
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            Task* task;
+        };
+
+        bool tryPush(Task* task);
+        Task* tryPop();
+        void runTask(Task& task);
+        void runStrand(const std::shared_ptr<Strand>& strand);
+        void workerFunc();
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask;
+        std::atomic<size_t> m_pushPos;
+        std::atomic<size_t> m_popPos;
+        std::atomic<size_t> m_strandTasks;
+        std::atomic<size_t> m_idleWorkers;
+        std::atomic<bool> m_run;
+        std::mutex m_idleMutex;
+        std::condition_variable m_idleCond;
+        std::vector<std::thread> m_workers;
+    };
+
     namespace ClientCallbackContext
     {
-        struct GetContext
+        /**
+         * Where the callbacks of a request run. Without an executor every callback
+         * runs on its own thread.
+         */
+        struct CallbackContext
+        {
+            std::weak_ptr<CallbackExecutor> executor;
+            std::shared_ptr<CallbackExecutor::Strand> strand;
+        };
+
+        struct GetContext : public CallbackContext
         {
             GetCallback callback;
             GetContext(GetCallback cb) : callback(cb){}
         };
 
-        struct SetContext
+        struct SetContext : public CallbackContext
         {
             PutCallback callback;
             SetContext(PutCallback cb) : callback(cb){}
         };
 
-        struct ListenContext
+        struct ListenContext : public CallbackContext
         {
             FindCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
@@ -56,7 +132,7 @@ namespace OC
                 : callback(cb), clientWrapper(cw){}
         };
 
-        struct ListenErrorContext
+        struct ListenErrorContext : public CallbackContext
         {
             FindCallback callback;
             FindErrorCallback errorCallback;
@@ -67,7 +143,7 @@ namespace OC
                 : callback(cb1), errorCallback(cb2), clientWrapper(cw){}
         };
 
-        struct DeviceListenContext
+        struct DeviceListenContext : public CallbackContext
         {
             FindDeviceCallback callback;
             IClientWrapper::Ptr clientWrapper;
@@ -75,25 +151,25 @@ namespace OC
                     : callback(cb), clientWrapper(cw){}
         };
 
-        struct SubscribePresenceContext
+        struct SubscribePresenceContext : public CallbackContext
         {
             SubscribeCallback callback;
             SubscribePresenceContext(SubscribeCallback cb) : callback(cb){}
         };
 
-        struct DeleteContext
+        struct DeleteContext : public CallbackContext
         {
             DeleteCallback callback;
             DeleteContext(DeleteCallback cb) : callback(cb){}
         };
 
-        struct ObserveContext
+        struct ObserveContext : public CallbackContext
         {
             ObserveCallback callback;
             ObserveContext(ObserveCallback cb) : callback(cb){}
         };
 
-        struct DirectPairingContext
+        struct DirectPairingContext : public CallbackContext
         {
             DirectPairingCallback callback;
             DirectPairingContext(DirectPairingCallback cb) : callback(cb){}
@@ -185,12 +261,14 @@ namespace OC
         OCHeaderOption* assembleHeaderOptions(OCHeaderOption options[],
            const HeaderOptions& headerOptions);
         void convert(const OCDPDev_t *list, PairedDevices& dpList);
+        void bindExecutor(ClientCallbackContext::CallbackContext* context, bool serial = false);
         std::thread m_listeningThread;
         bool m_threadRun;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
 
     private:
         PlatformConfig  m_cfg;
+        std::shared_ptr<CallbackExecutor> m_executor;
     };
 }
 
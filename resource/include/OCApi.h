@@ -152,6 +152,18 @@ namespace OC
         /** persistant storage Handler structure (open/read/write/close/unlink). */
         OCPersistentStorage        *ps;
 
+        /** number of threads running client callbacks, 0 to run each callback on its own thread. */
+        size_t                     callbackThreads;
+
+        /** number of client callbacks that can wait for a callback thread. */
+        size_t                     callbackQueueSize;
+
+        /** run the callbacks of an observation one at a time, in the order received. */
+        bool                       serializeObserveCallbacks;
+
+        /** number of threads running entity handlers, 0 to run them on the processing thread. */
+        uint8_t                    requestDispatchThreads;
+
         public:
             PlatformConfig()
                 : serviceType(ServiceType::InProc),
@@ -161,7 +173,11 @@ namespace OC
                 ipAddress("0.0.0.0"),
                 port(0),
                 QoS(QualityOfService::NaQos),
-                ps(nullptr)
+                ps(nullptr),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                serializeObserveCallbacks(true),
+                requestDispatchThreads(0)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -176,7 +192,11 @@ namespace OC
                 ipAddress(""),
                 port(0),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                serializeObserveCallbacks(true),
+                requestDispatchThreads(0)
         {}
             // for backward compatibility
             PlatformConfig(const ServiceType serviceType_,
@@ -192,7 +212,11 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackThreads(0),
+                callbackQueueSize(1024),
+                serializeObserveCallbacks(true),
+                requestDispatchThreads(0)
         {}
     };
 
@@ -250,6 +274,10 @@ namespace OC
     // Used in GET, PUT, POST methods on links to other remote resources of a group.
     const std::string GROUP_INTERFACE = "oic.mi.grp";
 
+    // Upper bound in milliseconds the InProc wrappers block in OCProcessWait between two
+    // OCProcess calls.
+    const uint32_t MAX_PROCESS_WAIT_MS = 1000;
+
     //Typedef for list direct paired devices
     typedef std::vector<std::shared_ptr<OCDirectPairing>> PairedDevices;
 
@@ -70,6 +70,15 @@ namespace OC
 
             OCRepPayload* getPayload() const;
 
+            /**
+             * Encodes the representations straight to CBOR, producing the same bytes
+             * OCConvertPayload would for the equivalent OCRepPayload.
+             *
+             * @return OCEncodedPayload that the stack sends verbatim, or nullptr
+             *         if the container is empty.  Release with OCPayloadDestroy.
+             */
+            OCPayload* getCborPayload() const;
+
             const std::vector<OCRepresentation>& representations() const;
 
             void addRepresentation(const OCRepresentation& rep);
@@ -86,6 +95,8 @@ namespace OC
         private:
             std::vector<OCRepresentation> m_reps;
     };
+    typedef FlatMap<std::string, AttributeValue> AttributeMap;
+
     class OCRepresentation
     {
         public:
@@ -160,7 +171,7 @@ namespace OC
                 m_values[str] = std::forward<T>(val);
             }
 
-            const std::map<std::string, AttributeValue>& getValues() const {
+            const AttributeMap& getValues() const {
                 return m_values;
             }
 
@@ -329,10 +340,10 @@ namespace OC
 
                 private:
                     AttributeItem(const std::string& name,
-                            std::map<std::string, AttributeValue>& vals);
+                            AttributeMap& vals);
                     AttributeItem(const AttributeItem&) = default;
                     std::string m_attrName;
-                    std::map<std::string, AttributeValue>& m_values;
+                    AttributeMap& m_values;
             };
 
             // Iterator to allow iteration via STL containers/methods
@@ -359,11 +370,11 @@ namespace OC
                     reference operator*();
                     pointer operator->();
                 private:
-                    iterator(std::map<std::string, AttributeValue>::iterator&& itr,
-                            std::map<std::string, AttributeValue>& vals)
+                    iterator(AttributeMap::iterator&& itr,
+                            AttributeMap& vals)
                         : m_iterator(std::move(itr)),
                         m_item(m_iterator != vals.end() ? m_iterator->first:"", vals){}
-                    std::map<std::string, AttributeValue>::iterator m_iterator;
+                    AttributeMap::iterator m_iterator;
                     AttributeItem m_item;
             };
 
@@ -392,11 +403,11 @@ namespace OC
                     const_reference operator*() const;
                     const_pointer operator->() const;
                 private:
-                    const_iterator(std::map<std::string, AttributeValue>::const_iterator&& itr,
-                            std::map<std::string, AttributeValue>& vals)
+                    const_iterator(AttributeMap::const_iterator&& itr,
+                            AttributeMap& vals)
                         : m_iterator(std::move(itr)),
                         m_item(m_iterator != vals.end() ? m_iterator->first: "", vals){}
-                    std::map<std::string, AttributeValue>::const_iterator m_iterator;
+                    AttributeMap::const_iterator m_iterator;
                     AttributeItem m_item;
             };
 
@@ -453,7 +464,7 @@ namespace OC
         private:
             std::string m_uri;
             std::vector<OCRepresentation> m_children;
-            mutable std::map<std::string, AttributeValue> m_values;
+            mutable AttributeMap m_values;
             std::vector<std::string> m_resourceTypes;
             std::vector<std::string> m_interfaces;
 
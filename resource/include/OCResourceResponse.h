@@ -175,6 +175,16 @@ namespace OC
         friend class InProcServerWrapper;
 
         OCRepPayload* getPayload() const
+        {
+            return getMessageContainer().getPayload();
+        }
+
+        OCPayload* getCborPayload() const
+        {
+            return getMessageContainer().getCborPayload();
+        }
+
+        MessageContainer getMessageContainer() const
         {
             MessageContainer inf;
             OCRepresentation first(m_representation);
@@ -215,7 +225,7 @@ namespace OC
 
             }
 
-            return inf.getPayload();
+            return inf;
         }
     public:
 
@@ -26,6 +26,8 @@
 #include <memory>
 #include <utility>
 #include <exception>
+#include <algorithm>
+#include <functional>
 
 #include <OCException.h>
 #include <StringConstants.h>
@@ -142,6 +144,130 @@ namespace OC
         static constexpr bool value = std::is_same<ToTest, T>::value
             || is_component<ToTest, Base<Rest...> >::value;
     };
+
+    /**
+     * Sorted associative container kept in a single contiguous vector.
+     *
+     * Provides the subset of the std::map interface used for representation
+     * attributes, iterating in the same key order.  Lookups are a binary search
+     * over adjacent elements instead of a walk over separately allocated tree
+     * nodes.  Keys inserted in ascending order, as they are when decoding a
+     * payload that was produced from this container, are appended in O(1).
+     */
+    template <typename Key, typename T, typename Compare = std::less<Key> >
+    class FlatMap
+    {
+        public:
+            typedef Key key_type;
+            typedef T mapped_type;
+            typedef std::pair<Key, T> value_type;
+            typedef std::vector<value_type> container_type;
+            typedef typename container_type::size_type size_type;
+            typedef typename container_type::iterator iterator;
+            typedef typename container_type::const_iterator const_iterator;
+
+            iterator begin() { return m_items.begin(); }
+            const_iterator begin() const { return m_items.begin(); }
+            const_iterator cbegin() const { return m_items.cbegin(); }
+            iterator end() { return m_items.end(); }
+            const_iterator end() const { return m_items.end(); }
+            const_iterator cend() const { return m_items.cend(); }
+
+            size_type size() const { return m_items.size(); }
+            bool empty() const { return m_items.empty(); }
+            void clear() { m_items.clear(); }
+            void reserve(size_type count) { m_items.reserve(count); }
+
+            void swap(FlatMap& other)
+            {
+                m_items.swap(other.m_items);
+                std::swap(m_comp, other.m_comp);
+            }
+
+            iterator find(const Key& key)
+            {
+                iterator itr = lowerBound(key);
+                return (itr != m_items.end() && !m_comp(key, itr->first)) ? itr : m_items.end();
+            }
+
+            const_iterator find(const Key& key) const
+            {
+                return const_cast<FlatMap*>(this)->find(key);
+            }
+
+            size_type count(const Key& key) const
+            {
+                return find(key) != end() ? 1 : 0;
+            }
+
+            T& operator[](const Key& key)
+            {
+                return emplaceKey(key)->second;
+            }
+
+            T& operator[](Key&& key)
+            {
+                return emplaceKey(std::move(key))->second;
+            }
+
+            size_type erase(const Key& key)
+            {
+                iterator itr = find(key);
+                if (itr == m_items.end())
+                {
+                    return 0;
+                }
+                m_items.erase(itr);
+                return 1;
+            }
+
+            friend bool operator==(const FlatMap& lhs, const FlatMap& rhs)
+            {
+                return lhs.m_items == rhs.m_items;
+            }
+
+            friend bool operator!=(const FlatMap& lhs, const FlatMap& rhs)
+            {
+                return !(lhs == rhs);
+            }
+
+            // Kept so callers that copied the values into a std::map still build.
+            operator std::map<Key, T, Compare>() const
+            {
+                return std::map<Key, T, Compare>(m_items.begin(), m_items.end());
+            }
+
+        private:
+            iterator lowerBound(const Key& key)
+            {
+                return std::lower_bound(m_items.begin(), m_items.end(), key,
+                        [this](const value_type& item, const Key& k)
+                        {
+                            return m_comp(item.first, k);
+                        });
+            }
+
+            template <typename K>
+            iterator emplaceKey(K&& key)
+            {
+                if (m_items.empty() || m_comp(m_items.back().first, key))
+                {
+                    m_items.emplace_back(std::forward<K>(key), T());
+                    return m_items.end() - 1;
+                }
+
+                iterator itr = lowerBound(key);
+                if (itr == m_items.end() || m_comp(key, itr->first))
+                {
+                    itr = m_items.insert(itr, value_type(std::forward<K>(key), T()));
+                }
+                return itr;
+            }
+
+        private:
+            container_type m_items;
+            Compare m_comp;
+    };
 } // namespace OC
 
 #endif
@@ -29,11 +29,257 @@ using namespace std;
 
 namespace OC
 {
+    CallbackExecutor::CallbackExecutor(size_t numThreads, size_t queueSize)
+        : m_mask(0), m_pushPos(0), m_popPos(0), m_strandTasks(0), m_idleWorkers(0), m_run(true)
+    {
+        // The queue indexes its cells with a mask, round its size up to a power of 2.
+        size_t size = 2;
+        while (size < queueSize)
+        {
+            size *= 2;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            m_cells[i].task = nullptr;
+        }
+
+        for (size_t i = 0; i < numThreads; ++i)
+        {
+            m_workers.emplace_back(&CallbackExecutor::workerFunc, this);
+        }
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            m_run = false;
+            m_idleCond.notify_all();
+        }
+
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+
+        while (Task* task = tryPop())
+        {
+            delete task;
+        }
+    }
+
+    void CallbackExecutor::post(Task task)
+    {
+        std::unique_ptr<Task> item(new Task(std::move(task)));
+        if (!tryPush(item.get()))
+        {
+            runTask(*item);
+            return;
+        }
+        item.release();
+
+        // Pairs with the fence of an idling worker, one of them sees the other's update.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_idleWorkers.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            m_idleCond.notify_one();
+        }
+    }
+
+    void CallbackExecutor::post(const std::shared_ptr<Strand>& strand, Task task)
+    {
+        if (!strand)
+        {
+            post(std::move(task));
+            return;
+        }
+
+        // Strand tasks count against the queue size as well. Past it the posting thread
+        // runs an idle strand itself. It never waits for a busy one: the poster is the
+        // stack thread, and holds the lock the callbacks of that strand may be waiting for.
+        // A busy strand keeps growing past the bound instead.
+        bool full = m_strandTasks.fetch_add(1, std::memory_order_relaxed) > m_mask;
+        {
+            std::lock_guard<std::mutex> lock(strand->m_mutex);
+            strand->m_tasks.push_back(std::move(task));
+            if (strand->m_running)
+            {
+                return;
+            }
+            strand->m_running = true;
+        }
+
+        if (full)
+        {
+            runStrand(strand);
+            return;
+        }
+        post([this, strand]{ runStrand(strand); });
+    }
+
+    // Bounded MPMC queue: each cell's sequence tells whether it is free for the push
+    // at its position or holds the task for the pop at its position.
+    bool CallbackExecutor::tryPush(Task* task)
+    {
+        Cell* cell;
+        size_t pos = m_pushPos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_pushPos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->task = task;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    CallbackExecutor::Task* CallbackExecutor::tryPop()
+    {
+        Cell* cell;
+        size_t pos = m_popPos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (m_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                pos = m_popPos.load(std::memory_order_relaxed);
+            }
+        }
+
+        Task* task = cell->task;
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return task;
+    }
+
+    void CallbackExecutor::runTask(Task& task)
+    {
+        try
+        {
+            task();
+        }
+        catch (std::exception& e)
+        {
+            oclog() << "Exception in client callback: " << e.what() << std::flush;
+        }
+    }
+
+    void CallbackExecutor::runStrand(const std::shared_ptr<Strand>& strand)
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(strand->m_mutex);
+                if (strand->m_tasks.empty())
+                {
+                    strand->m_running = false;
+                    return;
+                }
+                task = std::move(strand->m_tasks.front());
+                strand->m_tasks.pop_front();
+            }
+            m_strandTasks.fetch_sub(1, std::memory_order_relaxed);
+            runTask(task);
+        }
+    }
+
+    void CallbackExecutor::workerFunc()
+    {
+        while (m_run)
+        {
+            std::unique_ptr<Task> task(tryPop());
+            if (!task)
+            {
+                std::unique_lock<std::mutex> lock(m_idleMutex);
+                m_idleWorkers.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                task.reset(tryPop());
+                while (!task && m_run)
+                {
+                    m_idleCond.wait(lock);
+                    task.reset(tryPop());
+                }
+                m_idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+                if (!task)
+                {
+                    break;
+                }
+            }
+            runTask(*task);
+        }
+    }
+
+    /*
+     * Run a user callback on the executor of its request, or on its own thread
+     * if there is none.
+     */
+    template <typename FnT, typename ...ParamTs>
+    void runCallback(const std::shared_ptr<CallbackExecutor>& executor,
+                     const std::shared_ptr<CallbackExecutor::Strand>& strand,
+                     FnT&& fn, ParamTs&& ...params)
+    {
+        if (!executor)
+        {
+            std::thread exec(std::forward<FnT>(fn), std::forward<ParamTs>(params)...);
+            exec.detach();
+            return;
+        }
+        executor->post(strand, std::bind(std::forward<FnT>(fn), std::forward<ParamTs>(params)...));
+    }
+
+    template <typename FnT, typename ...ParamTs>
+    void runCallback(const ClientCallbackContext::CallbackContext* context,
+                     FnT&& fn, ParamTs&& ...params)
+    {
+        runCallback(context->executor.lock(), context->strand, std::forward<FnT>(fn),
+                    std::forward<ParamTs>(params)...);
+    }
+
     InProcClientWrapper::InProcClientWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
             : m_threadRun(false), m_csdkLock(csdkLock),
               m_cfg { cfg }
     {
+        if (m_cfg.callbackThreads > 0)
+        {
+            m_executor = std::make_shared<CallbackExecutor>(m_cfg.callbackThreads,
+                                                            m_cfg.callbackQueueSize);
+        }
+
         // if the config type is server, we ought to never get called.  If the config type
         // is both, we count on the server to run the thread and do the initialize
 
@@ -60,6 +306,7 @@ namespace OC
         if (m_threadRun && m_listeningThread.joinable())
         {
             m_threadRun = false;
+            OCProcessWakeup();
             m_listeningThread.join();
         }
 
@@ -92,8 +339,21 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Block until the stack has work to do, poll if it cannot wait for events.
+            if (m_threadRun && OC_STACK_OK != OCProcessWait(MAX_PROCESS_WAIT_MS))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+    }
+
+    void InProcClientWrapper::bindExecutor(ClientCallbackContext::CallbackContext* context,
+                                           bool serial)
+    {
+        context->executor = m_executor;
+        if (m_executor && serial)
+        {
+            context->strand = std::make_shared<CallbackExecutor::Strand>();
         }
     }
 
@@ -171,8 +431,7 @@ namespace OC
             // loop to ensure valid construction of all resources
             for(auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                runCallback(context, context->callback, resource);
             }
         }
         catch (std::exception &e){
@@ -223,15 +482,13 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                runCallback(context, context->callback, resource);
             }
             return OC_STACK_KEEP_TRANSACTION;
         }
 
         std::string resourceURI = clientResponse->resourceUri;
-        std::thread exec(context->errorCallback, resourceURI, result);
-        exec.detach();
+        runCallback(context, context->errorCallback, resourceURI, result);
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -252,6 +509,7 @@ namespace OC
 
         ClientCallbackContext::ListenContext* context =
             new ClientCallbackContext::ListenContext(callback, shared_from_this());
+        bindExecutor(context);
         OCCallbackData cbdata(
                 static_cast<void*>(context),
                 listenCallback,
@@ -299,6 +557,7 @@ namespace OC
         {
             return OC_STACK_ERROR;
         }
+        bindExecutor(context);
 
         OCCallbackData cbdata(
                 static_cast<void*>(context),
@@ -336,8 +595,7 @@ namespace OC
         try
         {
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            runCallback(context, context->callback, rep);
         }
         catch(OC::OCException& e)
         {
@@ -365,6 +623,7 @@ namespace OC
 
         ClientCallbackContext::DeviceListenContext* context =
             new ClientCallbackContext::DeviceListenContext(callback, shared_from_this());
+        bindExecutor(context);
         OCCallbackData cbdata(
                 static_cast<void*>(context),
                 listenDeviceCallback,
@@ -439,8 +698,7 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        runCallback(context, context->callback, serverHeaderOptions, rep, result);
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -457,6 +715,7 @@ namespace OC
         OCStackResult result;
         ClientCallbackContext::GetContext* ctx =
             new ClientCallbackContext::GetContext(callback);
+        bindExecutor(ctx);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 getResourceCallback,
@@ -516,8 +775,7 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        runCallback(context, context->callback, serverHeaderOptions, attrs, result);
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -559,7 +817,7 @@ namespace OC
             ocInfo.addRepresentation(r);
         }
 
-        return reinterpret_cast<OCPayload*>(ocInfo.getPayload());
+        return ocInfo.getCborPayload();
     }
 
     OCStackResult InProcClientWrapper::PostResourceRepresentation(
@@ -575,6 +833,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        bindExecutor(ctx);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 setResourceCallback,
@@ -621,6 +880,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        bindExecutor(ctx);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 setResourceCallback,
@@ -667,8 +927,7 @@ namespace OC
         {
             parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         }
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        runCallback(context, context->callback, serverHeaderOptions, clientResponse->result);
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -686,6 +945,7 @@ namespace OC
         OCStackResult result;
         ClientCallbackContext::DeleteContext* ctx =
             new ClientCallbackContext::DeleteContext(callback);
+        bindExecutor(ctx);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 deleteResourceCallback,
@@ -740,9 +1000,8 @@ namespace OC
                 result = e.code();
             }
         }
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
+        runCallback(context, context->callback, serverHeaderOptions, attrs,
                     result, sequenceNumber);
-        exec.detach();
         if (sequenceNumber == OC_OBSERVE_DEREGISTER)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -764,6 +1023,7 @@ namespace OC
 
         ClientCallbackContext::ObserveContext* ctx =
             new ClientCallbackContext::ObserveContext(callback);
+        bindExecutor(ctx, m_cfg.serializeObserveCallbacks);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 observeResourceCallback,
@@ -851,11 +1111,9 @@ namespace OC
          */
         std::string url = clientResponse->devAddr.addr;
 
-        std::thread exec(context->callback, clientResponse->result,
+        runCallback(context, context->callback, clientResponse->result,
                     clientResponse->sequenceNumber, url);
 
-        exec.detach();
-
         return OC_STACK_KEEP_TRANSACTION;
     }
 
@@ -870,6 +1128,7 @@ namespace OC
 
         ClientCallbackContext::SubscribePresenceContext* ctx =
             new ClientCallbackContext::SubscribePresenceContext(presenceHandler);
+        bindExecutor(ctx);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 subscribePresenceCallback,
@@ -994,8 +1253,7 @@ namespace OC
             }
             else {
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                runCallback(m_executor, nullptr, callback, dpDeviceList);
                 result = OC_STACK_OK;
             }
         }
@@ -1033,8 +1291,7 @@ namespace OC
             }
             else {
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                runCallback(m_executor, nullptr, callback, dpDeviceList);
                 result = OC_STACK_OK;
             }
         }
@@ -1053,8 +1310,7 @@ namespace OC
         ClientCallbackContext::DirectPairingContext* context =
             static_cast<ClientCallbackContext::DirectPairingContext*>(ctx);
 
-        std::thread exec(context->callback, cloneDevice(peer), result);
-        exec.detach();
+        runCallback(context, context->callback, cloneDevice(peer), result);
     }
 
     OCStackResult InProcClientWrapper::DoDirectPairing(std::shared_ptr<OCDirectPairing> peer,
@@ -1069,6 +1325,7 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         ClientCallbackContext::DirectPairingContext* context =
             new ClientCallbackContext::DirectPairingContext(callback);
+        bindExecutor(context);
 
         auto cLock = m_csdkLock.lock();
         if (cLock)
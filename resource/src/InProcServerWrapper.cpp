@@ -34,6 +34,7 @@
 #include <ocstack.h>
 #include <OCApi.h>
 #include <oic_malloc.h>
+#include <ocpayload.h>
 #include <OCPlatform.h>
 #include <OCUtilities.h>
 
@@ -278,6 +279,15 @@ namespace OC
                             static_cast<OCTransportFlags>(cfg.serverConnectivity & CT_MASK_FLAGS);
         OCTransportFlags clientFlags =
                             static_cast<OCTransportFlags>(cfg.clientConnectivity & CT_MASK_FLAGS);
+        if (cfg.requestDispatchThreads > 0)
+        {
+            OCStackResult result = OCSetRequestDispatchThreads(cfg.requestDispatchThreads);
+            if (OC_STACK_OK != result)
+            {
+                throw InitializeException(OC::InitException::STACK_INIT_ERROR, result);
+            }
+        }
+
         OCStackResult result = OCInit1(initType, serverFlags, clientFlags);
 
         if(OC_STACK_OK != result)
@@ -307,7 +317,10 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if(m_threadRun && OC_STACK_OK != OCProcessWait(MAX_PROCESS_WAIT_MS))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -548,7 +561,7 @@ namespace OC
             response.resourceHandle = pResponse->getResourceHandle();
             response.ehResult = pResponse->getResponseResult();
 
-            response.payload = reinterpret_cast<OCPayload*>(pResponse->getPayload());
+            response.payload = pResponse->getCborPayload();
 
             response.persistentBufferFlag = 0;
 
@@ -584,7 +597,7 @@ namespace OC
             }
             else
             {
-                OICFree(response.payload);
+                OCPayloadDestroy(response.payload);
                 result = OC_STACK_ERROR;
             }
 
@@ -601,6 +614,7 @@ namespace OC
         if(m_processThread.joinable())
         {
             m_threadRun = false;
+            OCProcessWakeup();
             m_processThread.join();
         }
 
@@ -30,6 +30,7 @@
 
 #include <boost/lexical_cast.hpp>
 #include <algorithm>
+#include "cbor.h"
 #include "ocpayload.h"
 #include "ocrandom.h"
 #include "oic_malloc.h"
@@ -522,7 +523,7 @@ namespace OC
             {
                 val[i] = payload_array_helper_copy<T>(i, pl);
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else if (depth == 2)
         {
@@ -536,7 +537,7 @@ namespace OC
                             i * pl->arr.dimensions[1] + j, pl);
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else if (depth == 3)
         {
@@ -557,7 +558,7 @@ namespace OC
                     }
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else
         {
@@ -609,8 +610,21 @@ namespace OC
             ll = ll->next;
         }
 
+        // Payloads parsed lazily only hold the values looked up so far
+        if (!OCRepPayloadDecodeLazyValues(const_cast<OCRepPayload*>(pl)))
+        {
+            throw OCException("Failed to decode payload values", OC_STACK_MALFORMED_RESPONSE);
+        }
+
         OCRepPayloadValue* val = pl->values;
 
+        size_t numValues = m_values.size();
+        for (OCRepPayloadValue* cur = val; cur; cur = cur->next)
+        {
+            ++numValues;
+        }
+        m_values.reserve(numValues);
+
         while(val)
         {
             switch(val->type)
@@ -634,7 +648,7 @@ namespace OC
                     {
                         OCRepresentation cur;
                         cur.setPayload(val->obj);
-                        setValue<OCRepresentation>(val->name, cur);
+                        setValue(val->name, std::move(cur));
                     }
                     break;
                 case OCREP_PROP_ARRAY:
@@ -863,7 +877,7 @@ namespace OC
 namespace OC
 {
     OCRepresentation::AttributeItem::AttributeItem(const std::string& name,
-            std::map<std::string, AttributeValue>& vals):
+            AttributeMap& vals):
             m_attrName(name), m_values(vals){}
 
     OCRepresentation::AttributeItem OCRepresentation::operator[](const std::string& key)
@@ -1171,3 +1185,410 @@ namespace OC
         return os;
     }
 }
+
+// Direct CBOR encoding of OCRepresentation. The wire format mirrors ocpayloadconvert.c,
+// so peers cannot tell which path was used.
+namespace OC
+{
+    namespace
+    {
+        // tinycbor keeps counting bytes after running out of buffer, so out-of-memory
+        // is not fatal while encoding; it is how the exact size gets measured.
+        bool cborFailed(int64_t err)
+        {
+            return err != CborNoError && err != CborErrorOutOfMemory;
+        }
+
+        int64_t encodeValues(CborEncoder* map, const OCRepresentation& rep);
+
+        int64_t encodeRepMap(CborEncoder* parent, const OCRepresentation& rep)
+        {
+            CborEncoder map;
+            int64_t err = cbor_encoder_create_map(parent, &map, CborIndefiniteLength);
+            if (cborFailed(err))
+            {
+                return err;
+            }
+            err |= encodeValues(&map, rep);
+            if (cborFailed(err))
+            {
+                return err;
+            }
+            return err | cbor_encoder_close_container(parent, &map);
+        }
+
+        int64_t encodeItem(CborEncoder* array, int item)
+        {
+            return cbor_encode_int(array, item);
+        }
+
+        int64_t encodeItem(CborEncoder* array, double item)
+        {
+            return cbor_encode_double(array, item);
+        }
+
+        int64_t encodeItem(CborEncoder* array, bool item)
+        {
+            return cbor_encode_boolean(array, item);
+        }
+
+        int64_t encodeItem(CborEncoder* array, const std::string& item)
+        {
+            return cbor_encode_text_string(array, item.c_str(), item.size());
+        }
+
+        int64_t encodeItem(CborEncoder* array, const OCRepresentation& item)
+        {
+            return encodeRepMap(array, item);
+        }
+
+        // Jagged arrays are padded to their largest dimension the same way
+        // OCRepresentation::getPayloadArray fills its calloc'ed buffers.
+        template<typename T>
+        int64_t encodeMissingItem(CborEncoder* array);
+
+        template<>
+        int64_t encodeMissingItem<int>(CborEncoder* array)
+        {
+            return cbor_encode_int(array, 0);
+        }
+
+        template<>
+        int64_t encodeMissingItem<double>(CborEncoder* array)
+        {
+            return cbor_encode_double(array, 0.0);
+        }
+
+        template<>
+        int64_t encodeMissingItem<bool>(CborEncoder* array)
+        {
+            return cbor_encode_boolean(array, false);
+        }
+
+        template<>
+        int64_t encodeMissingItem<std::string>(CborEncoder* array)
+        {
+            return cbor_encode_null(array);
+        }
+
+        template<>
+        int64_t encodeMissingItem<OCRepresentation>(CborEncoder* array)
+        {
+            return cbor_encode_null(array);
+        }
+
+        template<typename T>
+        int64_t encodeArrayItem(CborEncoder* array, const std::vector<T>& arr, size_t index)
+        {
+            return index < arr.size() ? encodeItem(array, arr[index])
+                                      : encodeMissingItem<T>(array);
+        }
+
+        struct encode_cbor_value: boost::static_visitor<int64_t>
+        {
+            explicit encode_cbor_value(CborEncoder* enc) : encoder(enc) {}
+
+            int64_t operator()(const NullType&) const
+            {
+                return cbor_encode_null(encoder);
+            }
+
+            int64_t operator()(int val) const
+            {
+                return encodeItem(encoder, val);
+            }
+
+            int64_t operator()(double val) const
+            {
+                return encodeItem(encoder, val);
+            }
+
+            int64_t operator()(bool val) const
+            {
+                return encodeItem(encoder, val);
+            }
+
+            int64_t operator()(const std::string& val) const
+            {
+                return encodeItem(encoder, val);
+            }
+
+            int64_t operator()(const OCRepresentation& val) const
+            {
+                return encodeItem(encoder, val);
+            }
+
+            int64_t operator()(const std::vector<uint8_t>& val) const
+            {
+                return cbor_encode_byte_string(encoder, val.data(), val.size());
+            }
+
+            template<typename T>
+            int64_t operator()(const std::vector<T>& arr) const
+            {
+                CborEncoder array;
+                int64_t err = cbor_encoder_create_array(encoder, &array, arr.size());
+                for (size_t i = 0; i < arr.size() && !cborFailed(err); ++i)
+                {
+                    err |= encodeArrayItem(&array, arr, i);
+                }
+                if (cborFailed(err))
+                {
+                    return err;
+                }
+                return err | cbor_encoder_close_container(encoder, &array);
+            }
+
+            template<typename T>
+            int64_t operator()(const std::vector<std::vector<T>>& arr) const
+            {
+                size_t dim1 = 0;
+                for (const auto& inner : arr)
+                {
+                    dim1 = std::max(dim1, inner.size());
+                }
+
+                CborEncoder array;
+                int64_t err = cbor_encoder_create_array(encoder, &array, arr.size());
+                for (size_t i = 0; i < arr.size() && !cborFailed(err); ++i)
+                {
+                    if (dim1 == 0)
+                    {
+                        err |= encodeMissingItem<T>(&array);
+                        continue;
+                    }
+
+                    CborEncoder array2;
+                    err |= cbor_encoder_create_array(&array, &array2, dim1);
+                    for (size_t j = 0; j < dim1 && !cborFailed(err); ++j)
+                    {
+                        err |= encodeArrayItem(&array2, arr[i], j);
+                    }
+                    if (!cborFailed(err))
+                    {
+                        err |= cbor_encoder_close_container(&array, &array2);
+                    }
+                }
+                if (cborFailed(err))
+                {
+                    return err;
+                }
+                return err | cbor_encoder_close_container(encoder, &array);
+            }
+
+            template<typename T>
+            int64_t operator()(const std::vector<std::vector<std::vector<T>>>& arr) const
+            {
+                size_t dim1 = 0;
+                size_t dim2 = 0;
+                for (const auto& inner : arr)
+                {
+                    dim1 = std::max(dim1, inner.size());
+                    for (const auto& innermost : inner)
+                    {
+                        dim2 = std::max(dim2, innermost.size());
+                    }
+                }
+
+                static const std::vector<T> empty;
+                CborEncoder array;
+                int64_t err = cbor_encoder_create_array(encoder, &array, arr.size());
+                for (size_t i = 0; i < arr.size() && !cborFailed(err); ++i)
+                {
+                    if (dim1 == 0)
+                    {
+                        err |= encodeMissingItem<T>(&array);
+                        continue;
+                    }
+
+                    CborEncoder array2;
+                    err |= cbor_encoder_create_array(&array, &array2, dim1);
+                    for (size_t j = 0; j < dim1 && !cborFailed(err); ++j)
+                    {
+                        if (dim2 == 0)
+                        {
+                            err |= encodeMissingItem<T>(&array2);
+                            continue;
+                        }
+
+                        const std::vector<T>& innermost = j < arr[i].size() ? arr[i][j] : empty;
+                        CborEncoder array3;
+                        err |= cbor_encoder_create_array(&array2, &array3, dim2);
+                        for (size_t k = 0; k < dim2 && !cborFailed(err); ++k)
+                        {
+                            err |= encodeArrayItem(&array3, innermost, k);
+                        }
+                        if (!cborFailed(err))
+                        {
+                            err |= cbor_encoder_close_container(&array2, &array3);
+                        }
+                    }
+                    if (!cborFailed(err))
+                    {
+                        err |= cbor_encoder_close_container(&array, &array2);
+                    }
+                }
+                if (cborFailed(err))
+                {
+                    return err;
+                }
+                return err | cbor_encoder_close_container(encoder, &array);
+            }
+
+            CborEncoder* encoder;
+        };
+
+        int64_t encodeValues(CborEncoder* map, const OCRepresentation& rep)
+        {
+            int64_t err = CborNoError;
+            for (const auto& value : rep.getValues())
+            {
+                err |= cbor_encode_text_string(map, value.first.c_str(), value.first.size());
+                if (cborFailed(err))
+                {
+                    return err;
+                }
+                err |= boost::apply_visitor(encode_cbor_value(map), value.second);
+                if (cborFailed(err))
+                {
+                    return err;
+                }
+            }
+            return err;
+        }
+
+        int64_t encodeStringArray(CborEncoder* map, const char* key,
+                const std::vector<std::string>& values)
+        {
+            if (values.empty())
+            {
+                return CborNoError;
+            }
+
+            CborEncoder array;
+            int64_t err = cbor_encode_text_string(map, key, strlen(key));
+            err |= cbor_encoder_create_array(map, &array, values.size());
+            for (const std::string& value : values)
+            {
+                err |= cbor_encode_text_string(&array, value.c_str(), value.size());
+            }
+            return err | cbor_encoder_close_container(map, &array);
+        }
+
+        int64_t encodeRepresentations(const std::vector<OCRepresentation>& reps,
+                uint8_t* out, size_t* size)
+        {
+            CborEncoder encoder;
+            CborEncoder rootArray;
+            cbor_encoder_init(&encoder, out, *size, 0);
+
+            const bool isArray = reps.size() > 1;
+            int64_t err = CborNoError;
+            if (isArray)
+            {
+                err |= cbor_encoder_create_array(&encoder, &rootArray, reps.size());
+            }
+
+            CborEncoder* parent = isArray ? &rootArray : &encoder;
+            for (auto it = reps.begin(); it != reps.end() && !cborFailed(err); ++it)
+            {
+                CborEncoder rootMap;
+                err |= cbor_encoder_create_map(parent, &rootMap, CborIndefiniteLength);
+                if (cborFailed(err))
+                {
+                    break;
+                }
+
+                // Only in case of collection href is included.
+                const std::string uri = it->getUri();
+                if (isArray && !uri.empty())
+                {
+                    err |= cbor_encode_text_string(&rootMap, OC_RSRVD_HREF,
+                            sizeof(OC_RSRVD_HREF) - 1);
+                    err |= cbor_encode_text_string(&rootMap, uri.c_str(), uri.size());
+                }
+                err |= encodeStringArray(&rootMap, OC_RSRVD_RESOURCE_TYPE, it->getResourceTypes());
+                err |= encodeStringArray(&rootMap, OC_RSRVD_INTERFACE,
+                        it->getResourceInterfaces());
+                if (cborFailed(err))
+                {
+                    break;
+                }
+
+                err |= encodeValues(&rootMap, *it);
+                if (cborFailed(err))
+                {
+                    break;
+                }
+                err |= cbor_encoder_close_container(parent, &rootMap);
+            }
+
+            if (isArray && !cborFailed(err))
+            {
+                err |= cbor_encoder_close_container(&encoder, &rootArray);
+            }
+
+            if (err == CborErrorOutOfMemory)
+            {
+                *size += encoder.ptr - encoder.end;
+            }
+            else if (err == CborNoError)
+            {
+                *size = encoder.ptr - out;
+            }
+            return err;
+        }
+    }
+
+    OCPayload* MessageContainer::getCborPayload() const
+    {
+        if (m_reps.empty())
+        {
+            return nullptr;
+        }
+
+        // Measure first so the buffer is allocated once at its final size
+        size_t size = 0;
+        int64_t err = encodeRepresentations(m_reps, nullptr, &size);
+        if (cborFailed(err))
+        {
+            throw OCException(std::string("Failed to encode CBOR payload: ") +
+                    cbor_error_string(static_cast<CborError>(err)));
+        }
+
+        uint8_t* out = static_cast<uint8_t*>(OICMalloc(size));
+        if (!out)
+        {
+            throw std::bad_alloc();
+        }
+
+        err = encodeRepresentations(m_reps, out, &size);
+        while (err == CborErrorOutOfMemory)
+        {
+            uint8_t* out2 = static_cast<uint8_t*>(OICRealloc(out, size));
+            if (!out2)
+            {
+                OICFree(out);
+                throw std::bad_alloc();
+            }
+            out = out2;
+            err = encodeRepresentations(m_reps, out, &size);
+        }
+
+        if (err != CborNoError)
+        {
+            OICFree(out);
+            throw OCException(std::string("Failed to encode CBOR payload: ") +
+                    cbor_error_string(static_cast<CborError>(err)));
+        }
+
+        OCEncodedPayload* payload = OCEncodedPayloadCreateAsOwner(out, size);
+        if (!payload)
+        {
+            OICFree(out);
+            throw std::bad_alloc();
+        }
+
+        return reinterpret_cast<OCPayload*>(payload);
+    }
+}
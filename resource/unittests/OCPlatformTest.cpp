@@ -20,6 +20,7 @@
 
 #include <OCPlatform.h>
 #include <OCApi.h>
+#include <InProcClientWrapper.h>
 #include <oic_malloc.h>
 #include <gtest/gtest.h>
 
@@ -868,4 +869,128 @@ namespace OCPlatformTest
         std::shared_ptr<OCDirectPairing> s_dp(new OCDirectPairing(&peer));
         EXPECT_ANY_THROW(OCPlatform::doDirectPairing(nullptr, pmSel, pin, nullptr));
     }
+
+    //CallbackExecutor
+    TEST(CallbackExecutorTest, RunsPostedCallbacks)
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        int count = 0;
+        {
+            CallbackExecutor executor(2, 16);
+            for (int i = 0; i < 100; ++i)
+            {
+                executor.post([&]
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ++count;
+                    cond.notify_all();
+                });
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            EXPECT_TRUE(cond.wait_for(lock, std::chrono::seconds(5), [&]{ return count == 100; }));
+        }
+        EXPECT_EQ(100, count);
+    }
+
+    TEST(CallbackExecutorTest, StrandKeepsOrder)
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::vector<int> order;
+        CallbackExecutor executor(4, 16);
+        auto strand = std::make_shared<CallbackExecutor::Strand>();
+        for (int i = 0; i < 100; ++i)
+        {
+            executor.post(strand, [&, i]
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(i);
+                cond.notify_all();
+            });
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(cond.wait_for(lock, std::chrono::seconds(5),
+                                  [&]{ return order.size() == 100; }));
+        for (int i = 0; i < 100; ++i)
+        {
+            EXPECT_EQ(i, order[i]);
+        }
+    }
+
+    TEST(CallbackExecutorTest, FullQueueRunsOnPostingThread)
+    {
+        std::mutex blocker;
+        std::unique_lock<std::mutex> blocked(blocker);
+        CallbackExecutor executor(1, 2);
+
+        // Keep the only worker busy, then fill the queue.
+        executor.post([&]{ std::lock_guard<std::mutex> lock(blocker); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        executor.post([]{});
+        executor.post([]{});
+
+        std::thread::id postingThread = std::this_thread::get_id();
+        std::thread::id runningThread;
+        executor.post([&]{ runningThread = std::this_thread::get_id(); });
+        EXPECT_EQ(postingThread, runningThread);
+
+        blocked.unlock();
+    }
+
+    TEST(CallbackExecutorTest, FullStrandsRunOnPostingThread)
+    {
+        std::mutex blocker;
+        std::unique_lock<std::mutex> blocked(blocker);
+        CallbackExecutor executor(1, 2);
+
+        // Keep the only worker busy, then leave as many tasks waiting on a strand
+        // as the queue holds.
+        executor.post([&]{ std::lock_guard<std::mutex> lock(blocker); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto waiting = std::make_shared<CallbackExecutor::Strand>();
+        executor.post(waiting, []{});
+        executor.post(waiting, []{});
+
+        std::thread::id postingThread = std::this_thread::get_id();
+        std::thread::id runningThread;
+        executor.post(std::make_shared<CallbackExecutor::Strand>(),
+                      [&]{ runningThread = std::this_thread::get_id(); });
+        EXPECT_EQ(postingThread, runningThread);
+
+        blocked.unlock();
+    }
+
+    TEST(CallbackExecutorTest, FullBusyStrandDoesNotBlockPostingThread)
+    {
+        // Stands for the stack lock, held by the posting thread like OCProcess holds it.
+        std::recursive_mutex stackLock;
+        std::unique_lock<std::recursive_mutex> stack(stackLock);
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::vector<int> order;
+        CallbackExecutor executor(1, 2);
+
+        // The strand's first callback calls back into the stack and waits for its lock.
+        auto strand = std::make_shared<CallbackExecutor::Strand>();
+        for (int i = 0; i < 8; ++i)
+        {
+            executor.post(strand, [&, i]
+            {
+                std::lock_guard<std::recursive_mutex> lock(stackLock);
+                std::lock_guard<std::mutex> guard(mutex);
+                order.push_back(i);
+                cond.notify_all();
+            });
+        }
+
+        stack.unlock();
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(cond.wait_for(lock, std::chrono::seconds(5),
+                                  [&]{ return order.size() == 8; }));
+        for (int i = 0; i < 8; ++i)
+        {
+            EXPECT_EQ(i, order[i]);
+        }
+    }
 }
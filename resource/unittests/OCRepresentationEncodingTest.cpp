@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include <gtest/gtest.h>
+#include <thread>
 #include <OCApi.h>
 #include <OCRepresentation.h>
 #include <octypes.h>
@@ -1265,4 +1266,270 @@ namespace OCRepresentationEncodingTest
         OCRepPayloadDestroy(repPayload);
         OCPayloadDestroy(cparsed);
     }
+
+    TEST(DirectCborEncoding, MatchesPayloadConversion)
+    {
+        OC::OCRepresentation child;
+        child.setValue("x", 1);
+        child.setValue("s", std::string("child"));
+
+        OC::OCRepresentation rep;
+        rep.setUri("/this/uri");
+        rep.addResourceType("rt.firstitem");
+        rep.addResourceInterface("if.firstitem");
+        rep.setValue("BoolAttr", true);
+        rep.setValue("DoubleAttr", 3.3330000000000002);
+        rep.setValue("IntAttr", 77);
+        rep.setNULL("NullAttr");
+        rep.setValue("StringAttr", std::string("String attr"));
+        rep.setValue("ObjAttr", child);
+        rep.setValue("Binary", std::vector<uint8_t>{0x1, 0x0, 0xFF});
+        rep.setValue("StringArr", std::vector<std::string>{"a", "bb", "ccc"});
+        rep.setValue("JaggedArr", std::vector<std::vector<int>>{{1}, {2, 3, 4}});
+        rep.setValue("ObjArr", std::vector<OC::OCRepresentation>{child, child});
+
+        OC::OCRepresentation sibling(child);
+        sibling.setUri("/sibling");
+
+        OC::MessageContainer mc;
+        mc.addRepresentation(rep);
+        mc.addRepresentation(sibling);
+
+        OCRepPayload* repPayload = mc.getPayload();
+        uint8_t* cborData;
+        size_t cborSize;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+
+        OCPayload* direct = mc.getCborPayload();
+        ASSERT_NE(nullptr, direct);
+        EXPECT_EQ(PAYLOAD_TYPE_ENCODED, direct->type);
+        OCEncodedPayload* encoded = (OCEncodedPayload*)direct;
+        ASSERT_EQ(cborSize, encoded->size);
+        EXPECT_EQ(0, memcmp(cborData, encoded->data, cborSize));
+
+        // The stack sends the encoded bytes as they are
+        uint8_t* sentData;
+        size_t sentSize;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload(direct, &sentData, &sentSize));
+        ASSERT_EQ(cborSize, sentSize);
+        EXPECT_EQ(0, memcmp(cborData, sentData, sentSize));
+        OICFree(sentData);
+
+        OCPayload* cparsed;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    encoded->data, encoded->size));
+        OC::MessageContainer viaPayload;
+        viaPayload.setPayload(cparsed);
+
+        ASSERT_EQ(2u, viaPayload.representations().size());
+        EXPECT_EQ("/this/uri", viaPayload.representations()[0].getUri());
+        EXPECT_EQ(77, viaPayload.representations()[0].getValue<int>("IntAttr"));
+        EXPECT_EQ("/sibling", viaPayload.representations()[1].getUri());
+
+        OICFree(cborData);
+        OCRepPayloadDestroy(repPayload);
+        OCPayloadDestroy(cparsed);
+        OCPayloadDestroy(direct);
+    }
+
+    TEST(DirectCborEncoding, SecurityPayloadIsNotARepresentation)
+    {
+        uint8_t securityData[] = { 0xA0 };
+        OCSecurityPayload* security = OCSecurityPayloadCreate(securityData,
+                sizeof(securityData));
+        ASSERT_NE(nullptr, security);
+
+        OC::MessageContainer mc;
+        EXPECT_THROW(mc.setPayload((OCPayload*)security), OC::OCException);
+
+        OCPayloadDestroy((OCPayload*)security);
+    }
+
+    TEST(RepresentationEncoding, LargePayloadEncodesToExactSize)
+    {
+        OC::OCRepresentation rep;
+        std::vector<std::string> strings;
+        for (int i = 0; i < 200; ++i)
+        {
+            strings.push_back("string number " + std::to_string(i));
+        }
+        rep.setValue("strings", strings);
+
+        OC::MessageContainer mc;
+        mc.addRepresentation(rep);
+        OCRepPayload* repPayload = mc.getPayload();
+
+        uint8_t* cborData;
+        size_t cborSize;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+        EXPECT_LT(255u, cborSize);
+
+        OCPayload* cparsed;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        OC::MessageContainer mc2;
+        mc2.setPayload(cparsed);
+        EXPECT_EQ(strings, mc2.representations()[0].getValue<std::vector<std::string>>("strings"));
+
+        OICFree(cborData);
+        OCRepPayloadDestroy(repPayload);
+        OCPayloadDestroy(cparsed);
+    }
+
+    TEST(RepresentationEncoding, LargeMultiRepPayloadEncodesToExactSize)
+    {
+        OC::MessageContainer mc;
+        std::vector<std::string> strings;
+        for (int i = 0; i < 60; ++i)
+        {
+            strings.push_back("string number " + std::to_string(i));
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            OC::OCRepresentation rep;
+            rep.setUri("/a/rep" + std::to_string(i));
+            rep.setValue("index", i);
+            rep.setValue("strings", strings);
+            mc.addRepresentation(rep);
+        }
+        OCRepPayload* repPayload = mc.getPayload();
+
+        uint8_t* cborData;
+        size_t cborSize;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+        EXPECT_LT(255u, cborSize);
+
+        OCPayload* cparsed;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        OC::MessageContainer mc2;
+        mc2.setPayload(cparsed);
+        ASSERT_EQ(3u, mc2.representations().size());
+        for (int i = 0; i < 3; ++i)
+        {
+            const OC::OCRepresentation& r = mc2.representations()[i];
+            EXPECT_EQ("/a/rep" + std::to_string(i), r.getUri());
+            EXPECT_EQ(i, r.getValue<int>("index"));
+            EXPECT_EQ(strings, r.getValue<std::vector<std::string>>("strings"));
+        }
+
+        OICFree(cborData);
+        OCRepPayloadDestroy(repPayload);
+        OCPayloadDestroy(cparsed);
+    }
+
+    TEST(RepresentationEncoding, LazyParseDecodesOnDemand)
+    {
+        OC::OCRepresentation child;
+        child.setValue("x", 1);
+
+        OC::OCRepresentation rep;
+        rep.addResourceType("rt.firstitem");
+        rep.setValue("IntAttr", 77);
+        rep.setValue("StringAttr", std::string("String attr"));
+        rep.setValue("Binary", std::vector<uint8_t>{0x1, 0x0, 0xFF});
+        rep.setValue("ObjAttr", child);
+        rep.setValue("IntArr", std::vector<int>{1, 2, 3});
+
+        OC::MessageContainer mc;
+        mc.addRepresentation(rep);
+        OCRepPayload* repPayload = mc.getPayload();
+        uint8_t* cborData;
+        size_t cborSize;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+
+        OCPayload* cparsed;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayloadLazy(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        // The lazy payload keeps its own copy of the buffer
+        memset(cborData, 0, cborSize);
+        OICFree(cborData);
+
+        OCRepPayload* lazy = (OCRepPayload*)cparsed;
+        EXPECT_STREQ("rt.firstitem", lazy->types->value);
+        EXPECT_EQ(NULL, lazy->values);
+
+        int64_t intVal = 0;
+        EXPECT_TRUE(OCRepPayloadGetPropInt(lazy, "IntAttr", &intVal));
+        EXPECT_EQ(77, intVal);
+        ASSERT_NE(nullptr, lazy->values);
+        EXPECT_EQ(NULL, lazy->values->next);
+        EXPECT_FALSE(OCRepPayloadGetPropInt(lazy, OC_RSRVD_RESOURCE_TYPE, &intVal));
+
+        const char* str = NULL;
+        size_t len = 0;
+        EXPECT_TRUE(OCRepPayloadGetPropStringView(lazy, "StringAttr", &str, &len));
+        EXPECT_EQ("String attr", std::string(str, len));
+        OCByteString bytes;
+        EXPECT_TRUE(OCRepPayloadGetPropByteStringView(lazy, "Binary", &bytes));
+        EXPECT_EQ(3u, bytes.len);
+        EXPECT_EQ(0xFF, bytes.bytes[2]);
+        EXPECT_EQ(NULL, lazy->values->next);
+
+        OCRepPayload* obj = NULL;
+        EXPECT_TRUE(OCRepPayloadGetPropObject(lazy, "ObjAttr", &obj));
+        EXPECT_TRUE(OCRepPayloadGetPropInt(obj, "x", &intVal));
+        EXPECT_EQ(1, intVal);
+        OCRepPayloadDestroy(obj);
+
+        OCRepPayload* clone = OCRepPayloadClone(lazy);
+        OCPayloadDestroy(cparsed);
+        EXPECT_TRUE(OCRepPayloadDecodeLazyValues(clone));
+        EXPECT_EQ(NULL, clone->lazy);
+
+        OC::MessageContainer mc2;
+        mc2.setPayload((OCPayload*)clone);
+        EXPECT_TRUE(rep.getValues() == mc2.representations()[0].getValues());
+
+        OCRepPayloadDestroy(repPayload);
+        OCRepPayloadDestroy(clone);
+    }
+
+    TEST(RepresentationEncoding, LazyClonesReadOnOtherThreads)
+    {
+        OC::OCRepresentation rep;
+        rep.setValue("IntAttr", 77);
+
+        OC::MessageContainer mc;
+        mc.addRepresentation(rep);
+        OCRepPayload* repPayload = mc.getPayload();
+        uint8_t* cborData;
+        size_t cborSize;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+
+        OCPayload* cparsed;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayloadLazy(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        OICFree(cborData);
+
+        // Each thread owns a clone; the clones share and release the CBOR buffer
+        std::vector<std::thread> threads;
+        std::vector<int64_t> values(8, 0);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            OCRepPayload* clone = OCRepPayloadClone((OCRepPayload*)cparsed);
+            EXPECT_NE(nullptr, clone);
+            if (!clone)
+            {
+                // Returning here would leave the started threads unjoined
+                continue;
+            }
+            threads.emplace_back([clone, &values, i]
+            {
+                OCRepPayloadGetPropInt(clone, "IntAttr", &values[i]);
+                OCRepPayloadDestroy(clone);
+            });
+        }
+        OCPayloadDestroy(cparsed);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        for (int64_t value : values)
+        {
+            EXPECT_EQ(77, value);
+        }
+
+        OCRepPayloadDestroy(repPayload);
+    }
 }
@@ -20,6 +20,7 @@
 
 #include <gtest/gtest.h>
 #include <OCApi.h>
+#include <ocpayload.h>
 #include <string>
 #include <limits>
 #include <boost/lexical_cast.hpp>
@@ -1310,4 +1311,52 @@ namespace OCRepresentationTest
             }
         }
     }
+
+    TEST(OCRepresentationAttributeMap, KeepsKeysSortedRegardlessOfInsertOrder)
+    {
+        AttributeMap values;
+        values["c"] = 3;
+        values["a"] = 1;
+        values["b"] = 2;
+        values["a"] = 4;
+
+        EXPECT_EQ(3u, values.size());
+        vector<string> keys;
+        for (const auto& item : values)
+        {
+            keys.push_back(item.first);
+        }
+        EXPECT_EQ((vector<string>{"a", "b", "c"}), keys);
+        EXPECT_EQ(4, boost::get<int>(values.find("a")->second));
+
+        EXPECT_EQ(1u, values.erase("b"));
+        EXPECT_EQ(0u, values.erase("b"));
+        EXPECT_EQ(values.end(), values.find("b"));
+        EXPECT_EQ(2u, values.size());
+    }
+
+    TEST(OCRepresentationAttributeMap, SetPayloadMovesNestedRepresentations)
+    {
+        OCRepresentation inner;
+        inner.setUri("/inner");
+        inner.setValue("int", 1);
+
+        OCRepresentation outer;
+        outer.setValue("rep", inner);
+        outer.setValue("reps", vector<OCRepresentation>{inner, inner});
+        outer.setValue("str", string("value"));
+
+        OCRepPayload* payload = outer.getPayload();
+        MessageContainer container;
+        container.setPayload(payload);
+        OCRepPayloadDestroy(payload);
+
+        ASSERT_EQ(1u, container.representations().size());
+        const OCRepresentation& parsed = container.representations()[0];
+
+        EXPECT_EQ(3, parsed.numberOfAttributes());
+        EXPECT_EQ(1, parsed.getValue<OCRepresentation>("rep").getValue<int>("int"));
+        EXPECT_EQ(2u, parsed.getValue<vector<OCRepresentation>>("reps").size());
+        EXPECT_EQ("value", parsed.getValue<string>("str"));
+    }
 }
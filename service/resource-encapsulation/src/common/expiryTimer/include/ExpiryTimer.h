@@ -49,6 +49,14 @@ namespace OIC
             ExpiryTimer(const ExpiryTimer&) = delete;
             ExpiryTimer& operator=(const ExpiryTimer&) = delete;
 
+            /**
+             * Sets the number of threads running expired callbacks, 4 by default.
+             * It must be called before the first timer is posted.
+             *
+             * @return false if the count is 0 or timers are already running.
+             */
+            static bool setNumOfWorkers(size_t);
+
             Id post(DelayInMilliSec, Callback);
             bool cancel(Id);
             void cancelAll();
@@ -41,6 +41,11 @@ namespace OIC
             cancelAll();
         }
 
+        bool ExpiryTimer::setNumOfWorkers(size_t numOfWorkers)
+        {
+            return ExpiryTimerImpl::setNumOfWorkers(numOfWorkers);
+        }
+
         ExpiryTimer::Id ExpiryTimer::post(DelayInMilliSec milliSec, Callback cb)
         {
             auto task = ExpiryTimerImpl::getInstance()->post(milliSec, std::move(cb));
@@ -30,17 +30,37 @@ namespace OIC
         namespace
         {
             constexpr ExpiryTimerImpl::Id INVALID_ID{ 0U };
+
+            constexpr size_t INVALID_INDEX{ static_cast< size_t >(-1) };
+
+            constexpr size_t DEFAULT_NUM_OF_WORKERS{ 4 };
+
+            std::atomic< size_t > g_numOfWorkers{ DEFAULT_NUM_OF_WORKERS };
+            std::atomic< bool > g_started{ false };
         }
 
         ExpiryTimerImpl::ExpiryTimerImpl() :
                 m_tasks{ },
+                m_taskIds{ },
                 m_thread{ },
                 m_mutex{ },
                 m_cond{ },
                 m_stop{ false },
+                m_workers{ },
+                m_expiredTasks{ },
+                m_workerMutex{ },
+                m_workerCond{ },
+                m_workerStop{ false },
                 m_mt{ std::random_device{ }() },
                 m_dist{ }
         {
+            g_started = true;
+
+            const size_t numOfWorkers{ g_numOfWorkers };
+            for (size_t i = 0; i < numOfWorkers; ++i)
+            {
+                m_workers.emplace_back(&ExpiryTimerImpl::runWorker, this);
+            }
             m_thread = std::thread(&ExpiryTimerImpl::run, this);
         }
 
@@ -49,10 +69,21 @@ namespace OIC
             {
                 std::lock_guard< std::mutex > lock{ m_mutex };
                 m_tasks.clear();
+                m_taskIds.clear();
                 m_stop = true;
             }
             m_cond.notify_all();
             m_thread.join();
+
+            {
+                std::lock_guard< std::mutex > lock{ m_workerMutex };
+                m_workerStop = true;
+            }
+            m_workerCond.notify_all();
+            for (auto& worker : m_workers)
+            {
+                worker.join();
+            }
         }
 
         ExpiryTimerImpl* ExpiryTimerImpl::getInstance()
@@ -61,6 +92,14 @@ namespace OIC
             return &instance;
         }
 
+        bool ExpiryTimerImpl::setNumOfWorkers(size_t numOfWorkers)
+        {
+            if (numOfWorkers == 0 || g_started) return false;
+
+            g_numOfWorkers = numOfWorkers;
+            return true;
+        }
+
         std::shared_ptr< TimerTask > ExpiryTimerImpl::post(DelayInMillis delay, Callback cb)
         {
             if (delay < 0LL)
@@ -82,15 +121,11 @@ namespace OIC
 
             std::lock_guard< std::mutex > lock{ m_mutex };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
-            {
-                if(it->second->getId() == id)
-                {
-                    m_tasks.erase(it);
-                    return true;
-                }
-            }
-            return false;
+            auto it = m_taskIds.find(id);
+            if (it == m_taskIds.end()) return false;
+
+            removeTask(it->second->m_heapIndex);
+            return true;
         }
 
         size_t ExpiryTimerImpl::cancelAll(
@@ -99,17 +134,15 @@ namespace OIC
             std::lock_guard< std::mutex > lock{ m_mutex };
             size_t erased { 0 };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end();)
+            for (const auto& task : tasks)
             {
-                if(tasks.count(it->second))
+                const size_t index = task->m_heapIndex;
+
+                if (index < m_tasks.size() && m_tasks[index] == task)
                 {
-                    it = m_tasks.erase(it);
+                    removeTask(index);
                     ++erased;
                 }
-                else
-                {
-                    ++it;
-                }
             }
             return erased;
         }
@@ -126,7 +159,8 @@ namespace OIC
             std::lock_guard< std::mutex > lock{ m_mutex };
 
             auto newTask = std::make_shared< TimerTask >(id, std::move(cb));
-            m_tasks.insert({ delay, newTask });
+            newTask->m_expiredTime = delay;
+            pushTask(newTask);
             m_cond.notify_all();
 
             return newTask;
@@ -134,11 +168,7 @@ namespace OIC
 
         bool ExpiryTimerImpl::containsId(Id id) const
         {
-            for (const auto& info : m_tasks)
-            {
-                if (info.second->getId() == id) return true;
-            }
-            return false;
+            return m_taskIds.count(id) != 0;
         }
 
         ExpiryTimerImpl::Id ExpiryTimerImpl::generateId()
@@ -160,18 +190,101 @@ namespace OIC
 
             auto now = std::chrono::system_clock::now().time_since_epoch();
 
-            auto it = m_tasks.begin();
-            for (; it != m_tasks.end() && it->first <= now; ++it)
+            std::lock_guard< std::mutex > lock{ m_workerMutex };
+            bool expired{ false };
+
+            while (!m_tasks.empty() && m_tasks.front()->m_expiredTime <= now)
             {
-                it->second->execute();
+                auto task = m_tasks.front();
+                removeTask(0);
+
+                const Id id{ task->getId() };
+                m_expiredTasks.emplace_back(id, task->expire());
+                expired = true;
             }
 
-            m_tasks.erase(m_tasks.begin(), it);
+            if (expired) m_workerCond.notify_all();
+        }
+
+        void ExpiryTimerImpl::pushTask(const std::shared_ptr< TimerTask >& task)
+        {
+            task->m_heapIndex = m_tasks.size();
+            m_tasks.push_back(task);
+            m_taskIds[task->getId()] = task.get();
+
+            siftUp(task->m_heapIndex);
+        }
+
+        void ExpiryTimerImpl::removeTask(size_t index)
+        {
+            const size_t last = m_tasks.size() - 1;
+            std::shared_ptr< TimerTask > task = m_tasks[index];
+
+            if (index != last)
+            {
+                swapTasks(index, last);
+            }
+            m_tasks.pop_back();
+
+            m_taskIds.erase(task->getId());
+            task->m_heapIndex = INVALID_INDEX;
+
+            if (index < m_tasks.size())
+            {
+                siftDown(index);
+                siftUp(index);
+            }
+        }
+
+        void ExpiryTimerImpl::swapTasks(size_t lhs, size_t rhs)
+        {
+            std::swap(m_tasks[lhs], m_tasks[rhs]);
+            m_tasks[lhs]->m_heapIndex = lhs;
+            m_tasks[rhs]->m_heapIndex = rhs;
+        }
+
+        void ExpiryTimerImpl::siftUp(size_t index)
+        {
+            while (index > 0)
+            {
+                const size_t parent = (index - 1) / 2;
+
+                if (m_tasks[parent]->m_expiredTime <= m_tasks[index]->m_expiredTime) break;
+
+                swapTasks(parent, index);
+                index = parent;
+            }
+        }
+
+        void ExpiryTimerImpl::siftDown(size_t index)
+        {
+            const size_t size = m_tasks.size();
+
+            while (true)
+            {
+                size_t smallest = index;
+                const size_t left = index * 2 + 1;
+                const size_t right = left + 1;
+
+                if (left < size && m_tasks[left]->m_expiredTime < m_tasks[smallest]->m_expiredTime)
+                {
+                    smallest = left;
+                }
+                if (right < size && m_tasks[right]->m_expiredTime < m_tasks[smallest]->m_expiredTime)
+                {
+                    smallest = right;
+                }
+
+                if (smallest == index) break;
+
+                swapTasks(index, smallest);
+                index = smallest;
+            }
         }
 
         ExpiryTimerImpl::Milliseconds ExpiryTimerImpl::remainingTimeForNext() const
         {
-            const Milliseconds& expiredTime = m_tasks.begin()->first;
+            const Milliseconds& expiredTime = m_tasks.front()->m_expiredTime;
 
             return std::chrono::duration_cast< Milliseconds >(expiredTime -
                     std::chrono::system_clock::now().time_since_epoch()) + Milliseconds{ 1 };
@@ -195,23 +308,45 @@ namespace OIC
             }
         }
 
+        void ExpiryTimerImpl::runWorker()
+        {
+            auto hasTaskOrStop = [this](){ return !m_expiredTasks.empty() || m_workerStop; };
+
+            std::unique_lock< std::mutex > lock{ m_workerMutex };
+
+            while (true)
+            {
+                m_workerCond.wait(lock, hasTaskOrStop);
+
+                // Callbacks that already expired are still run when the timer stops.
+                if (m_expiredTasks.empty()) break;
+
+                auto task = std::move(m_expiredTasks.front());
+                m_expiredTasks.pop_front();
+
+                lock.unlock();
+                task.second(task.first);
+                lock.lock();
+            }
+        }
+
 
         TimerTask::TimerTask(ExpiryTimerImpl::Id id, ExpiryTimerImpl::Callback cb) :
             m_id{ id },
-            m_callback{ std::move(cb) }
+            m_callback{ std::move(cb) },
+            m_expiredTime{ },
+            m_heapIndex{ INVALID_INDEX }
         {
         }
 
-        void TimerTask::execute()
+        ExpiryTimerImpl::Callback TimerTask::expire()
         {
-            if (isExecuted()) return;
+            ExpiryTimerImpl::Callback cb{ std::move(m_callback) };
 
-            ExpiryTimerImpl::Id id { m_id };
             m_id = INVALID_ID;
-
-            std::thread(std::move(m_callback), id).detach();
-
             m_callback = ExpiryTimerImpl::Callback{ };
+
+            return cb;
         }
 
         bool TimerTask::isExecuted() const
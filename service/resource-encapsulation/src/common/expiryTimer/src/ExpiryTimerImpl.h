@@ -22,12 +22,14 @@
 #define _EXPIRY_TIMER_IMPL_H_
 
 #include <functional>
-#include <map>
+#include <vector>
+#include <deque>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
 #include <random>
+#include <unordered_map>
 #include <unordered_set>
 #include <atomic>
 
@@ -58,6 +60,18 @@ namespace OIC
         public:
             static ExpiryTimerImpl* getInstance();
 
+            /**
+             * Sets the number of worker threads running expired callbacks.
+             * Callbacks run concurrently on up to this many threads, so one slow callback
+             * does not hold up the others.
+             *
+             * @return false if the count is 0 or the timer has already been started,
+             *         in which case the current count is kept.
+             *
+             * @note It only takes effect before the first call to getInstance.
+             */
+            static bool setNumOfWorkers(size_t);
+
             std::shared_ptr< TimerTask > post(DelayInMillis, Callback);
 
             bool cancel(Id);
@@ -75,25 +89,72 @@ namespace OIC
             Id generateId();
 
             /**
+             * Moves expired tasks from the heap to the worker queue.
+             *
              * @pre The lock must be acquired with m_mutex.
              */
             void executeExpired();
 
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
+            void pushTask(const std::shared_ptr< TimerTask >&);
+
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
+            void removeTask(size_t index);
+
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
+            void swapTasks(size_t, size_t);
+
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
+            void siftUp(size_t);
+
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
+            void siftDown(size_t);
+
             /**
              * @pre The lock must be acquired with m_mutex.
              */
             Milliseconds remainingTimeForNext() const;
 
             void run();
+            void runWorker();
 
         private:
-            std::multimap< Milliseconds, std::shared_ptr< TimerTask > > m_tasks;
+            /**
+             * Min-heap of pending tasks ordered by expiry time.
+             * Each task keeps its own index so it can be cancelled without a scan.
+             */
+            std::vector< std::shared_ptr< TimerTask > > m_tasks;
+            std::unordered_map< Id, TimerTask* > m_taskIds;
 
             std::thread m_thread;
             std::mutex m_mutex;
             std::condition_variable m_cond;
             bool m_stop;
 
+            std::vector< std::thread > m_workers;
+
+            /**
+             * Expired tasks waiting for a worker.
+             * It is not bounded by itself: every posted task passes through it once, so it
+             * holds at most the tasks that expired while all workers were busy. Holding the
+             * timer thread back instead would delay every later expiry.
+             * Tasks queued when the timer is destroyed are still run by the workers.
+             */
+            std::deque< std::pair< Id, Callback > > m_expiredTasks;
+            std::mutex m_workerMutex;
+            std::condition_variable m_workerCond;
+            bool m_workerStop;
+
             std::mt19937 m_mt;
             std::uniform_int_distribution< Id > m_dist;
 
@@ -114,12 +175,15 @@ namespace OIC
             ExpiryTimerImpl::Id getId() const;
 
         private:
-            void execute();
+            ExpiryTimerImpl::Callback expire();
 
         private:
             std::atomic< ExpiryTimerImpl::Id > m_id;
             ExpiryTimerImpl::Callback m_callback;
 
+            std::chrono::milliseconds m_expiredTime;
+            size_t m_heapIndex;
+
             friend class ExpiryTimerImpl;
         };
 
@@ -22,6 +22,7 @@
 
 #include <mutex>
 #include <atomic>
+#include <vector>
 
 #include "RCSException.h"
 #include "ExpiryTimer.h"
@@ -169,6 +170,81 @@ TEST_F(ExpiryTimerImplTest, CallbackBeInvokedWithinToleranceWithMultiplePost)
     ASSERT_EQ(NUM_OF_POST, called);
 }
 
+TEST_F(ExpiryTimerImplTest, OnlyNotCanceledTasksBeInvokedWhenCanceledOutOfOrder)
+{
+    constexpr int NUM_OF_POST{ 100 };
+    std::atomic_int called{ 0 };
+    std::vector< ExpiryTimerImpl::Id > ids;
+
+    for (int i=0; i<NUM_OF_POST; ++i)
+    {
+        FunctionObject* functor = mocks.Mock< FunctionObject >();
+
+        if (i % 2)
+        {
+            mocks.NeverCall(functor, FunctionObject::execute);
+        }
+        else
+        {
+            mocks.OnCall(functor, FunctionObject::execute).Do(
+                    [&called](ExpiryTimerImpl::Id)
+                    {
+                        ++called;
+                    }
+            );
+        }
+
+        ids.push_back(ExpiryTimerImpl::getInstance()->post(rand() % 20 + 50,
+                std::bind(&FunctionObject::execute, functor, std::placeholders::_1))->getId());
+    }
+
+    for (int i=NUM_OF_POST-1; i>0; i-=2)
+    {
+        ASSERT_TRUE(ExpiryTimerImpl::getInstance()->cancel(ids[i]));
+    }
+
+    Wait(TOLERANCE_IN_MILLIS + 75);
+
+    ASSERT_EQ(NUM_OF_POST / 2, called);
+}
+
+TEST_F(ExpiryTimerImplTest, NumOfWorkersCanNotBeChangedOnceStarted)
+{
+    ExpiryTimerImpl::getInstance();
+
+    ASSERT_FALSE(ExpiryTimerImpl::setNumOfWorkers(0));
+    ASSERT_FALSE(ExpiryTimerImpl::setNumOfWorkers(2));
+}
+
+TEST_F(ExpiryTimerImplTest, SlowCallbackDoesNotDelayOtherExpiredTasks)
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool released{ false };
+    std::atomic_bool fastCalled{ false };
+
+    ExpiryTimerImpl::getInstance()->post(1, [&](ExpiryTimerImpl::Id)
+    {
+        std::unique_lock< std::mutex > lock{ mutex };
+        cond.wait_for(lock, std::chrono::milliseconds{ TOLERANCE_IN_MILLIS * 4 },
+                [&released]{ return released; });
+    });
+    ExpiryTimerImpl::getInstance()->post(1, [&fastCalled](ExpiryTimerImpl::Id)
+    {
+        fastCalled = true;
+    });
+
+    Wait(TOLERANCE_IN_MILLIS);
+    EXPECT_TRUE(fastCalled);
+
+    {
+        std::lock_guard< std::mutex > lock{ mutex };
+        released = true;
+    }
+    cond.notify_all();
+    Wait(TOLERANCE_IN_MILLIS);
+}
+
 class ExpiryTimerTest: public TestWithMock
 {
 public:
@@ -132,6 +132,9 @@ std::string getPayloadTypeString(OCPayloadType type)
         case PAYLOAD_TYPE_RD:
             typeStr = "PAYLOAD_TYPE_RD";
             break;
+        case PAYLOAD_TYPE_ENCODED:
+            typeStr = "PAYLOAD_TYPE_ENCODED";
+            break;
     }
     return typeStr;
 }